@@ -4,15 +4,21 @@
  *        según distintas estrategias de asignación de memoria.
  *
  * Este módulo define las estrategias de asignación de memoria utilizadas
- * por el simulador (First-Fit, Best-Fit y Worst-Fit), así como las funciones
- * encargadas de establecer el algoritmo activo y buscar un bloque adecuado
- * para una solicitud de memoria.
+ * por el simulador (First-Fit, Next-Fit, Best-Fit, Worst-Fit y los motores
+ * buddy y TLSF),
+ * así como las funciones encargadas de establecer el algoritmo activo, buscar
+ * un bloque adecuado y reservar, liberar o redimensionar bloques con él.
+ *
+ * Cada algoritmo es un motor (`AllocEngine`) registrado por nombre; el
+ * simulador enlaza uno al iniciar y todas las operaciones llaman a sus
+ * ganchos sin volver a decidir qué algoritmo usar.
  */
 
 #ifndef ALLOCATOR_H
 #define ALLOCATOR_H
 
 #include <stddef.h>
+#include <stdbool.h>
 #include "blocks.h"
 
 /**
@@ -26,23 +32,310 @@
  * - **ALLOC_FIRST_FIT:** Selecciona el primer bloque libre lo suficientemente grande.
  * - **ALLOC_BEST_FIT:** Selecciona el bloque libre más pequeño que pueda contener la solicitud.
  * - **ALLOC_WORST_FIT:** Selecciona el bloque libre más grande disponible.
+ * - **ALLOC_NEXT_FIT:** Como First-Fit, pero la búsqueda continúa desde el
+ *   bloque de la última asignación exitosa y da la vuelta al llegar al final.
+ * - **ALLOC_BUDDY:** Sistema buddy binario: tamaños redondeados a potencias de
+ *   dos, listas de libres por orden y fusión con el "buddy" calculado por XOR.
+ * - **ALLOC_TLSF:** Two-Level Segregated Fit: listas segregadas en dos niveles
+ *   con mapas de bits; búsqueda, reserva y liberación en tiempo constante.
+ * - **ALLOC_BITMAP:** Mapa de bits de gránulos de 16 bytes, sin nodos para
+ *   el espacio libre.
+ * - **ALLOC_TAGS:** Etiquetas de frontera (cabecera y pie) escritas dentro
+ *   de la arena; los vecinos se ubican por tamaño, sin punteros. Busca con
+ *   First-Fit en la lista de libres de la arena.
+ * - **ALLOC_TAGS_BEST, ALLOC_TAGS_WORST, ALLOC_TAGS_NEXT:** La misma
+ *   disposición con Best-Fit, Worst-Fit y Next-Fit.
  */
 typedef enum {
     ALLOC_FIRST_FIT,  /**< Primer bloque que encaje. */
     ALLOC_BEST_FIT,   /**< Bloque más pequeño que cumpla el tamaño. */
-    ALLOC_WORST_FIT   /**< Bloque libre más grande encontrado. */
+    ALLOC_WORST_FIT,  /**< Bloque libre más grande encontrado. */
+    ALLOC_NEXT_FIT,   /**< Primer bloque que encaje a partir del puntero móvil. */
+    ALLOC_BUDDY,      /**< Motor buddy binario (potencias de dos). */
+    ALLOC_TLSF,       /**< Motor TLSF de latencia acotada. */
+    ALLOC_BITMAP,     /**< Motor por mapa de bits de gránulos. */
+    ALLOC_TAGS,       /**< Motor con etiquetas de frontera en la arena. */
+    ALLOC_TAGS_BEST,  /**< Etiquetas de frontera con Best-Fit. */
+    ALLOC_TAGS_WORST, /**< Etiquetas de frontera con Worst-Fit. */
+    ALLOC_TAGS_NEXT   /**< Etiquetas de frontera con Next-Fit. */
 } AllocAlgorithm;
 
+/** @brief Cantidad máxima de motores registrados. */
+#define ALLOC_MAX_ENGINES 16
+
+/**
+ * @brief Función invocada por cada segmento al recorrer la arena.
+ *
+ * @param block Segmento (reserva o hueco libre); puede ser un descriptor
+ *              temporal válido solo durante la llamada.
+ * @param ctx   Contexto del recorrido.
+ */
+typedef void (*BlockVisitor)(const Block *block, void *ctx);
+
+/**
+ * @struct AllocOverhead
+ * @brief Bytes de metadatos que el motor activo necesita en este momento.
+ */
+typedef struct {
+    size_t in_arena;   /**< Metadatos escritos dentro de la arena (cabeceras, pies). */
+    size_t outside;    /**< Estructuras fuera de la arena (nodos, mapas, tablas). */
+} AllocOverhead;
+
+/**
+ * @struct AllocEngine
+ * @brief Tabla de ganchos de un motor de asignación.
+ *
+ * `init` y `destroy` son opcionales: los motores con `init` solo pueden
+ * activarse con la arena vacía. `stats` es opcional e imprime información
+ * propia del motor en el comando STATS. `find` y `alloc` reciben una
+ * alineación (potencia de dos; 1 = sin restricción) y deben devolver un
+ * bloque cuyo offset sea múltiplo de ella. `walk` solo lo definen los motores
+ * que no mantienen la lista general de bloques; mientras uno de ellos está
+ * activo, cambiar de motor también exige la arena vacía. `overhead` es
+ * opcional; sin él, los metadatos son los nodos `Block` de la lista.
+ * `compact` es opcional: desliza los bloques ocupados hacia el inicio de la
+ * arena, llamando a `move` por cada uno que cambia de offset, y devuelve los
+ * bytes movidos; sin él, el motor no admite compactación. `grow` es
+ * opcional: incorpora al final de la arena los bytes entre `old_size` y
+ * `new_size` como espacio libre; sin él, la arena no crece con ese motor.
+ * `expand` es opcional: cuando `resize` no alcanza, redimensiona el bloque
+ * desplazándolo hacia el bloque libre anterior (y el siguiente, si hace
+ * falta) a un offset múltiplo de `align`, sin mover sus datos; sin él,
+ * REALLOC mueve el bloque a uno nuevo. `alloc_run` es opcional: con una sola
+ * búsqueda reserva hasta `count` bloques contiguos de `size` bytes (múltiplo
+ * de `align`), los deja en `out` y devuelve cuántos reservó, o 0 si ningún
+ * bloque libre alcanza para la corrida completa. `free_run` es opcional:
+ * libera un grupo de bloques fusionándolos en una sola pasada. Sin ellos,
+ * las operaciones en lote reservan y liberan de a un bloque.
+ */
+typedef struct AllocEngine {
+    const char *name;                            /**< Nombre único del motor. */
+    bool   (*init)(size_t arena_size);           /**< Prepara el estado del motor. */
+    void   (*destroy)(void);                     /**< Libera el estado del motor. */
+    Block *(*find)(size_t size, size_t align);   /**< Bloque libre que usaría `alloc`. */
+    Block *(*alloc)(size_t size, size_t align);  /**< Reserva un bloque alineado. */
+    void   (*free)(Block *block);                /**< Libera un bloque ocupado. */
+    bool   (*resize)(Block *block, size_t size); /**< Redimensiona sin mover. */
+    void   (*stats)(void);                       /**< Imprime estadísticas propias. */
+    void   (*walk)(BlockVisitor visit, void *ctx); /**< Recorre la arena en orden. */
+    void   (*overhead)(AllocOverhead *out);      /**< Metadatos actuales del motor. */
+    size_t (*compact)(BlockMover move, void *ctx); /**< Compacta la arena. */
+    bool   (*grow)(size_t old_size, size_t new_size); /**< Incorpora arena nueva. */
+    bool   (*expand)(Block *block, size_t size, size_t align); /**< Redimensiona hacia atrás. */
+    size_t (*alloc_run)(size_t size, size_t align, size_t count, Block **out); /**< Reserva una corrida. */
+    void   (*free_run)(Block **blocks, size_t count); /**< Libera un grupo. */
+} AllocEngine;
+
+/**
+ * @enum AllocRealloc
+ * @brief Cómo se resolvió un REALLOC.
+ */
+typedef enum {
+    ALLOC_REALLOC_IN_PLACE,  /**< El bloque no cambió de offset. */
+    ALLOC_REALLOC_SLID,      /**< El bloque se desplazó hacia el libre anterior. */
+    ALLOC_REALLOC_MOVED      /**< El contenido se copió a un bloque nuevo. */
+} AllocRealloc;
+
+/** @brief Cantidad de cubetas del histograma de latencias. */
+#define ALLOC_LAT_BUCKETS 64
+
+/**
+ * @brief Liberaciones que se acumulan sin fusionar antes de un barrido, si
+ *        no se indica otro umbral al activar la fusión diferida.
+ */
+#define ALLOC_COALESCE_THRESHOLD 32
+
+/**
+ * @struct AllocStats
+ * @brief Contadores y latencias de las operaciones del algoritmo activo.
+ *
+ * La cubeta `k` del histograma cuenta las reservas que tardaron entre
+ * 2^k y 2^(k+1) - 1 nanosegundos (la cubeta 0 incluye 0 ns).
+ *
+ * El relleno de alineación se divide en el que vuelve a la arena como
+ * bloque libre (`align_split`) y el que queda dentro del bloque reservado
+ * sin poder usarse (`align_kept`).
+ *
+ * Las compactaciones (comando COMPACT o al fallar una reserva) acumulan los
+ * bytes movidos y el tiempo empleado. Con fusión diferida se cuentan los
+ * barridos que unieron los bloques libres pendientes.
+ *
+ * Cada REALLOC se cuenta según cómo se resolvió (en su lugar, deslizado
+ * hacia el bloque libre anterior o movido a un bloque nuevo), junto con los
+ * bytes de contenido que los dos últimos casos copian.
+ *
+ * Las operaciones en lote (ALLOC_N y FREE_PREFIX) cuentan, además de sus
+ * reservas y liberaciones, las corridas reservadas con una sola búsqueda y
+ * los grupos liberados con una sola pasada de fusión. Cada corrida aporta
+ * una única medición al histograma de latencias.
+ *
+ * De cada CALLOC se acumulan los bytes pedidos y los que hubo que poner en
+ * cero; la diferencia son bytes que ya estaban en cero (páginas sin
+ * escribir) y no se tocaron.
+ *
+ * `in_use` y `peak_in_use` cuentan los bytes solicitados al asignador (un
+ * slab cuenta completo); comparados con el tamaño de la arena muestran
+ * cuánto creció por fragmentación. Se conservan al cambiar de motor.
+ */
+typedef struct {
+    size_t allocs;                              /**< Reservas exitosas. */
+    size_t frees;                               /**< Liberaciones. */
+    size_t failures;                            /**< Reservas sin espacio. */
+    unsigned long long lat_max_ns;              /**< Peor latencia de reserva. */
+    size_t lat_hist[ALLOC_LAT_BUCKETS];         /**< Histograma log2 de latencias. */
+    size_t aligned;                             /**< Reservas con alineación > 1. */
+    size_t align_split;                         /**< Bytes de relleno devueltos como libres. */
+    size_t align_kept;                          /**< Bytes de relleno desperdiciados. */
+    size_t compactions;                         /**< Compactaciones realizadas. */
+    size_t compact_moved;                       /**< Bytes movidos al compactar. */
+    unsigned long long compact_ns;              /**< Tiempo total compactando. */
+    size_t coalesce_sweeps;                     /**< Barridos de fusión diferida. */
+    size_t realloc_in_place;                    /**< REALLOC sin cambiar de offset. */
+    size_t realloc_slid;                        /**< REALLOC desplazados hacia atrás. */
+    size_t realloc_moved;                       /**< REALLOC movidos a otro bloque. */
+    size_t realloc_copied;                      /**< Bytes copiados por REALLOC. */
+    size_t callocs;                             /**< CALLOC exitosos. */
+    size_t calloc_bytes;                        /**< Bytes pedidos por CALLOC. */
+    size_t calloc_zeroed;                       /**< Bytes que CALLOC puso en cero. */
+    size_t alloc_runs;                          /**< Corridas reservadas en lote. */
+    size_t run_blocks;                          /**< Bloques de esas corridas. */
+    size_t free_groups;                         /**< Grupos liberados en lote. */
+    size_t group_blocks;                        /**< Bloques de esos grupos. */
+    size_t cache_hits;                          /**< Reservas atendidas por cachés de hilo. */
+    size_t cache_stores;                        /**< Liberaciones guardadas en cachés de hilo. */
+    size_t in_use;                              /**< Bytes solicitados vivos. */
+    size_t peak_in_use;                         /**< Máximo de `in_use`. */
+} AllocStats;
+
 /**
  * @brief Establece el algoritmo de asignación de memoria que el simulador utilizará.
  *
  * Esta función configura la estrategia que se aplicará durante las
  * futuras operaciones de ALLOC y REALLOC. No afecta bloques ya asignados.
+ * Equivale a `allocator_select()` con el nombre del motor incluido.
+ *
+ * Activar el motor buddy o TLSF reorganiza sus estructuras a partir de la
+ * arena, por lo que solo se permite mientras no haya bloques ocupados.
+ * Las estadísticas de `allocator_stats()` se reinician con cada cambio.
  *
- * @param algo Estrategia de asignación a utilizar (First-Fit, Best-Fit o Worst-Fit).
+ * @param algo Estrategia de asignación a utilizar.
  */
 void allocator_set_algorithm(AllocAlgorithm algo);
 
+/**
+ * @brief Compacta la arena con el motor activo.
+ *
+ * Los bloques ocupados se deslizan hacia el offset 0 (sus datos se mueven
+ * con `memmove`) y el espacio libre queda en un bloque al final. Los
+ * descriptores `Block` no cambian, así que las variables siguen apuntando a
+ * sus bloques. Los slabs movidos actualizan los offsets de sus ranuras.
+ *
+ * @param moved Bytes movidos (puede ser NULL).
+ * @param ns    Duración en nanosegundos (puede ser NULL).
+ * @return false si el motor activo no admite compactación.
+ */
+bool allocator_compact(size_t *moved, unsigned long long *ns);
+
+/**
+ * @brief Elige dónde buscan las políticas de lista.
+ *
+ * Con la tabla, First/Best/Worst/Next-Fit recorren los arreglos paralelos
+ * de `block_table.c` en lugar de los árboles de `free_index.c`. El cambio
+ * se permite en cualquier momento: la estructura elegida se reconstruye a
+ * partir de la lista de bloques. Los demás motores no se ven afectados.
+ *
+ * @param table true para la tabla de bloques, false para el índice.
+ * @return true si quedó en uso el almacén pedido.
+ */
+bool allocator_use_table(bool table);
+
+/**
+ * @brief Hace crecer la arena para que quepa una reserva que falló.
+ *
+ * Calcula lo que falta descontando el bloque libre final, pide a
+ * `memory_grow()` que crezca según su política y llama al gancho `grow` del
+ * motor activo para extender (o crear) el bloque libre final.
+ *
+ * @param size  Tamaño de la reserva que no cupo.
+ * @param align Su alineación en bytes.
+ * @return true si la arena creció; false si el motor no lo admite, la
+ *         política es `MEMORY_GROW_OFF` o se alcanzó el límite.
+ */
+bool allocator_grow(size_t size, size_t align);
+
+/**
+ * @brief Elige cuándo fusionan las políticas de lista los bloques liberados.
+ *
+ * Con umbral 0 cada liberación se fusiona de inmediato con sus vecinos. Con
+ * umbral `n`, los bloques liberados (y los sobrantes de un REALLOC que
+ * reduce) quedan sin fusionar hasta acumular `n` liberaciones o hasta que
+ * una reserva o expansión no encuentre espacio; entonces `blocks_coalesce()`
+ * une todo en una sola pasada y la búsqueda se reintenta. Al volver a 0 se
+ * fusiona lo pendiente. Los demás motores no se ven afectados.
+ *
+ * @param threshold Liberaciones por barrido, o 0 para fusión inmediata.
+ */
+void allocator_defer_coalescing(size_t threshold);
+
+/**
+ * @brief Registra un motor para poder seleccionarlo por nombre.
+ *
+ * Los motores incluidos (first-fit, best-fit, worst-fit, next-fit, buddy,
+ * tlsf, bitmap y tags) ya están registrados.
+ *
+ * @param engine Motor con nombre único y ganchos find/alloc/free/resize;
+ *               debe permanecer válido mientras el simulador lo use.
+ * @return true si se registró.
+ */
+bool allocator_register(const AllocEngine *engine);
+
+/**
+ * @brief Activa el motor registrado con el nombre indicado.
+ *
+ * Reinicia las estadísticas de `allocator_stats()` y los contadores de
+ * `blocks_churn()`. Las fusiones diferidas pendientes se realizan antes.
+ *
+ * @param name Nombre del motor.
+ * @return true si el motor quedó activo.
+ */
+bool allocator_select(const char *name);
+
+/**
+ * @brief Busca un motor registrado por nombre.
+ *
+ * @param name Nombre del motor.
+ * @return Motor encontrado, o NULL.
+ */
+const AllocEngine *allocator_find_engine(const char *name);
+
+/**
+ * @brief Cantidad de motores registrados.
+ */
+size_t allocator_engine_count(void);
+
+/**
+ * @brief Motor registrado en la posición `idx`.
+ *
+ * @param idx Índice (0..allocator_engine_count()-1).
+ * @return Motor, o NULL si el índice no existe.
+ */
+const AllocEngine *allocator_engine_at(size_t idx);
+
+/**
+ * @brief Motor activo.
+ */
+const AllocEngine *allocator_engine(void);
+
+/**
+ * @brief Recorre la arena en orden de offset con el motor activo.
+ *
+ * Sin gancho `walk`, recorre la lista general de bloques.
+ *
+ * @param visit Función invocada por cada segmento.
+ * @param ctx   Contexto para `visit`.
+ */
+void allocator_walk(BlockVisitor visit, void *ctx);
+
 /**
  * @brief Busca un bloque libre adecuado según la estrategia de asignación activa.
  *
@@ -55,4 +348,168 @@ void allocator_set_algorithm(AllocAlgorithm algo);
  */
 Block *allocator_find_block(size_t size);
 
+/**
+ * @brief Reserva un bloque ocupado de al menos `size` bytes.
+ *
+ * Busca un bloque con el algoritmo activo, lo divide si es necesario y lo
+ * marca como ocupado. `requested` queda en `size`; `size` puede ser mayor si
+ * el algoritmo redondea (buddy).
+ *
+ * @param size Tamaño solicitado en bytes.
+ * @return Bloque reservado, o `NULL` si no hay espacio suficiente.
+ */
+Block *allocator_alloc(size_t size);
+
+/**
+ * @brief Reserva un bloque ocupado cuyo offset es múltiplo de `align`.
+ *
+ * El relleno inicial necesario para alinear se devuelve a la arena como
+ * bloque libre cuando el motor lo permite; lo que no puede separarse se
+ * contabiliza como desperdicio en `allocator_stats()`.
+ *
+ * @param size  Tamaño solicitado en bytes.
+ * @param align Alineación en bytes (potencia de dos; 1 = sin restricción).
+ * @return Bloque reservado, o `NULL` si no hay espacio suficiente.
+ */
+Block *allocator_alloc_aligned(size_t size, size_t align);
+
+/**
+ * @brief Reserva con una sola búsqueda una corrida de bloques contiguos.
+ *
+ * Con el gancho `alloc_run` del motor activo, busca un bloque libre para
+ * `count` bloques de `size` bytes (redondeado a múltiplo de `align`, para
+ * que todos queden alineados) y lo divide de una vez. Si el motor no tiene
+ * el gancho o ningún bloque libre alcanza, no reserva nada ni cuenta un
+ * fallo: el llamador debe reservar de a un bloque.
+ *
+ * @param size  Tamaño solicitado de cada bloque.
+ * @param align Alineación en bytes (potencia de dos; 1 = sin restricción).
+ * @param count Cantidad de bloques.
+ * @param out   Recibe los bloques, en orden de offset.
+ * @return Bloques reservados (0 si no hubo corrida).
+ */
+size_t allocator_alloc_run(size_t size, size_t align, size_t count, Block **out);
+
+/**
+ * @brief Registra el relleno de alineación de la reserva en curso.
+ *
+ * La invocan los motores desde su gancho `alloc`.
+ *
+ * @param split Bytes de relleno devueltos a la arena como bloque libre.
+ * @param kept  Bytes de relleno que quedan inutilizables dentro del bloque.
+ */
+void allocator_note_alignment(size_t split, size_t kept);
+
+/**
+ * @brief Devuelve un bloque ocupado al algoritmo activo.
+ *
+ * El bloque se marca como libre y se fusiona con los vecinos que el
+ * algoritmo permita. El puntero puede quedar inválido tras la llamada.
+ *
+ * @param block Bloque ocupado a liberar.
+ */
+void allocator_free(Block *block);
+
+/**
+ * @brief Devuelve un grupo de bloques ocupados al algoritmo activo.
+ *
+ * Con el gancho `free_run`, los bloques contiguos del grupo se unen antes
+ * de entrar al índice de libres y cada corrida se fusiona una vez con sus
+ * vecinos; sin él, equivale a `allocator_free()` por cada bloque. Los
+ * punteros quedan inválidos y el arreglo puede reordenarse.
+ *
+ * @param blocks Bloques ocupados a liberar.
+ * @param count  Cantidad de bloques.
+ */
+void allocator_free_run(Block **blocks, size_t count);
+
+/**
+ * @brief Intenta cambiar el tamaño de un bloque ocupado sin moverlo.
+ *
+ * Una reducción siempre se realiza (el sobrante se libera). Una expansión
+ * solo se realiza si hay espacio libre contiguo suficiente.
+ *
+ * @param block    Bloque ocupado.
+ * @param new_size Nuevo tamaño solicitado en bytes.
+ * @return true si el bloque quedó con el nuevo tamaño en su lugar, false si
+ *         la expansión requiere mover el bloque.
+ */
+bool allocator_resize(Block *block, size_t new_size);
+
+/**
+ * @brief Redimensiona un bloque ocupado desplazándolo hacia atrás.
+ *
+ * Para cuando `allocator_resize()` no alcanza: con el gancho `expand` del
+ * motor activo, el bloque absorbe el bloque libre anterior (y el siguiente,
+ * si hace falta) y pasa a un offset menor, múltiplo de `align`. El nodo es
+ * el mismo, así que las variables siguen apuntando a él; el contenido debe
+ * moverse después con `memmove`, porque los rangos pueden solaparse.
+ *
+ * @param block    Bloque ocupado.
+ * @param new_size Nuevo tamaño solicitado en bytes.
+ * @param align    Alineación del nuevo offset (potencia de dos).
+ * @return true si el bloque cambió de offset y cubre `new_size` bytes;
+ *         false si el motor no lo admite o no hay espacio contiguo.
+ */
+bool allocator_expand(Block *block, size_t new_size, size_t align);
+
+/**
+ * @brief Registra en las estadísticas cómo se resolvió un REALLOC.
+ *
+ * @param kind   En su lugar, deslizado o movido.
+ * @param copied Bytes de contenido copiados.
+ */
+void allocator_note_realloc(AllocRealloc kind, size_t copied);
+
+/**
+ * @brief Registra en las estadísticas un CALLOC.
+ *
+ * @param size   Bytes pedidos.
+ * @param zeroed Bytes que hubo que poner en cero.
+ */
+void allocator_note_calloc(size_t size, size_t zeroed);
+
+/**
+ * @brief Registra lo que atendió la caché de un hilo sin pasar por el motor.
+ *
+ * Los bloques de las cachés siguen ocupados para el motor, pero sus bytes
+ * solicitados cambian al reutilizarse; `grown` es la suma de esos cambios
+ * (módulo `SIZE_MAX + 1`, así que puede representar una reducción).
+ *
+ * @param hits   Reservas atendidas por la caché.
+ * @param stores Liberaciones que quedaron en la caché.
+ * @param grown  Cambio de los bytes en uso.
+ */
+void allocator_note_cache(size_t hits, size_t stores, size_t grown);
+
+/**
+ * @brief Libera el estado interno del algoritmo activo.
+ *
+ * Se invoca al destruir la arena.
+ */
+void allocator_shutdown(void);
+
+/**
+ * @brief Metadatos que el motor activo usa en este momento.
+ *
+ * @param out Bytes dentro y fuera de la arena.
+ */
+void allocator_overhead(AllocOverhead *out);
+
+/**
+ * @brief Estadísticas acumuladas desde la última selección de motor.
+ *
+ * @return Puntero de solo lectura a los contadores internos.
+ */
+const AllocStats *allocator_stats(void);
+
+/**
+ * @brief Reinicia las estadísticas de `allocator_stats()` y los contadores
+ *        de divisiones y fusiones.
+ *
+ * @param in_use Bytes solicitados que ya están en uso en la arena (por
+ *               ejemplo, al restaurar una instantánea).
+ */
+void allocator_reset_stats(size_t in_use);
+
 #endif /* ALLOCATOR_H */
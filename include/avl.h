@@ -0,0 +1,128 @@
+/**
+ * @file avl.h
+ * @brief Árbol AVL intrusivo y genérico.
+ *
+ * Los nodos (`AvlNode`) se incrustan dentro de las estructuras que se desean
+ * ordenar, por lo que el árbol no reserva memoria propia. El orden lo define
+ * una función de comparación y, opcionalmente, una función de actualización
+ * permite mantener datos aumentados en cada nodo (por ejemplo, el máximo de
+ * un campo dentro del subárbol).
+ *
+ * Las claves deben ser únicas: la comparación sólo retorna 0 para el mismo
+ * nodo. Inserción y eliminación cuestan O(log n); armar el árbol de una vez
+ * a partir de nodos ordenados cuesta O(n).
+ */
+
+#ifndef AVL_H
+#define AVL_H
+
+#include <stddef.h>
+
+/**
+ * @brief Obtiene la estructura que contiene un `AvlNode`.
+ *
+ * @param ptr    Puntero al nodo incrustado.
+ * @param type   Tipo de la estructura contenedora.
+ * @param member Nombre del campo `AvlNode` dentro de `type`.
+ */
+#define AVL_ENTRY(ptr, type, member) \
+    ((type *)((char *)(ptr) - offsetof(type, member)))
+
+/**
+ * @struct AvlNode
+ * @brief Nodo intrusivo del árbol AVL.
+ */
+typedef struct AvlNode {
+    struct AvlNode *left;   /**< Subárbol izquierdo (claves menores). */
+    struct AvlNode *right;  /**< Subárbol derecho (claves mayores). */
+    int             height; /**< Altura del subárbol con raíz en este nodo. */
+} AvlNode;
+
+/**
+ * @brief Compara dos nodos; retorna <0, 0 o >0 como `strcmp`.
+ */
+typedef int (*AvlCompareFn)(const AvlNode *a, const AvlNode *b);
+
+/**
+ * @brief Recalcula los datos aumentados de un nodo a partir de sus hijos.
+ */
+typedef void (*AvlUpdateFn)(AvlNode *node);
+
+/**
+ * @struct AvlTree
+ * @brief Raíz del árbol junto con sus funciones de orden y actualización.
+ */
+typedef struct AvlTree {
+    AvlNode     *root;   /**< Raíz del árbol, NULL si está vacío. */
+    AvlCompareFn cmp;    /**< Orden total entre nodos. */
+    AvlUpdateFn  update; /**< Mantenimiento de datos aumentados (opcional). */
+} AvlTree;
+
+/**
+ * @brief Inicializa un árbol vacío.
+ *
+ * @param tree   Árbol a inicializar.
+ * @param cmp    Función de comparación.
+ * @param update Función de actualización, o NULL si no hay datos aumentados.
+ */
+void avl_init(AvlTree *tree, AvlCompareFn cmp, AvlUpdateFn update);
+
+/**
+ * @brief Inserta un nodo en el árbol.
+ *
+ * @param tree Árbol destino.
+ * @param node Nodo que aún no pertenece a ningún árbol.
+ */
+void avl_insert(AvlTree *tree, AvlNode *node);
+
+/**
+ * @brief Arma el árbol de una vez a partir de nodos ya ordenados.
+ *
+ * Cada nodo queda en la mediana de su rango, así que el árbol resultante
+ * está balanceado sin rotaciones. Los nodos que tuviera el árbol se olvidan.
+ *
+ * @param tree  Árbol destino.
+ * @param nodes Nodos en orden estrictamente creciente según `tree->cmp`.
+ * @param count Cantidad de nodos.
+ */
+void avl_build(AvlTree *tree, AvlNode **nodes, size_t count);
+
+/**
+ * @brief Elimina un nodo del árbol.
+ *
+ * El nodo se localiza usando la función de comparación, por lo que su clave
+ * no debe haber cambiado desde la inserción.
+ *
+ * @param tree Árbol que contiene al nodo.
+ * @param node Nodo a eliminar.
+ */
+void avl_remove(AvlTree *tree, AvlNode *node);
+
+/**
+ * @brief Recalcula los datos aumentados en el camino desde la raíz al nodo.
+ *
+ * Debe llamarse cuando cambia un campo que afecta los datos aumentados pero
+ * no la posición del nodo dentro del orden.
+ *
+ * @param tree Árbol que contiene al nodo.
+ * @param node Nodo modificado.
+ */
+void avl_refresh(AvlTree *tree, AvlNode *node);
+
+/**
+ * @brief Nodo con la menor clave.
+ *
+ * @param tree Árbol a consultar.
+ * @return Nodo mínimo, o NULL si el árbol está vacío.
+ */
+AvlNode *avl_min(const AvlTree *tree);
+
+/**
+ * @brief Nodo con la mayor clave.
+ *
+ * @param tree Árbol a consultar.
+ * @return Nodo máximo, o NULL si el árbol está vacío.
+ */
+AvlNode *avl_max(const AvlTree *tree);
+
+#endif /* AVL_H */
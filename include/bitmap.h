@@ -0,0 +1,109 @@
+/**
+ * @file bitmap.h
+ * @brief Motor de asignación por mapa de bits de gránulos.
+ *
+ * La arena se divide en gránulos de BITMAP_GRANULE bytes y cada gránulo
+ * ocupa un bit (1 = ocupado). Reservar es buscar la primera secuencia de
+ * bits en cero de la longitud necesaria, recorriendo palabras de 64 bits con
+ * `ctz`/`popcount` y saltando con SIMD las palabras completamente ocupadas
+ * o libres.
+ *
+ * El espacio libre no tiene nodos: la lista general de bloques no se usa
+ * mientras el motor está activo. Cada reserva viva necesita un `Block` como
+ * manejador para la tabla de variables; esos manejadores salen de un pool
+ * por lotes y se reciclan al liberar, sin un `malloc` por bloque.
+ */
+
+#ifndef BITMAP_H
+#define BITMAP_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "blocks.h"
+#include "allocator.h"
+
+/** @brief Tamaño de un gránulo en bytes. */
+#define BITMAP_GRANULE 16
+
+/** @brief Manejadores reservados por cada lote del pool. */
+#define BITMAP_HANDLE_CHUNK 256
+
+/**
+ * @brief Crea el mapa de bits de la arena.
+ *
+ * @param arena_size Tamaño total de la arena.
+ * @return true si el motor quedó listo.
+ */
+bool bitmap_init(size_t arena_size);
+
+/**
+ * @brief Libera el mapa de bits y el pool de manejadores.
+ */
+void bitmap_destroy(void);
+
+/**
+ * @brief Secuencia libre que `bitmap_alloc()` usaría para `size` bytes.
+ *
+ * Como no hay nodos libres, el resultado es un descriptor temporal (válido
+ * hasta la siguiente llamada) con el offset y la extensión de la secuencia.
+ *
+ * @param size  Tamaño solicitado en bytes.
+ * @param align Alineación en bytes (potencia de dos).
+ * @return Descriptor de la secuencia libre, o NULL.
+ */
+Block *bitmap_find_block(size_t size, size_t align);
+
+/**
+ * @brief Reserva la primera secuencia de gránulos libres suficiente.
+ *
+ * Los gránulos ya están alineados a BITMAP_GRANULE bytes; una alineación
+ * mayor restringe el gránulo inicial a sus múltiplos.
+ *
+ * @param size  Tamaño solicitado en bytes (se redondea a gránulos).
+ * @param align Alineación en bytes (potencia de dos).
+ * @return Manejador ocupado, o NULL si no hay espacio.
+ */
+Block *bitmap_alloc(size_t size, size_t align);
+
+/**
+ * @brief Libera los gránulos de un manejador y lo devuelve al pool.
+ *
+ * @param block Manejador ocupado.
+ */
+void bitmap_free(Block *block);
+
+/**
+ * @brief Redimensiona una reserva sin moverla.
+ *
+ * @param block    Manejador ocupado.
+ * @param new_size Nuevo tamaño solicitado.
+ * @return true si los gránulos siguientes alcanzan (o si es una reducción).
+ */
+bool bitmap_resize(Block *block, size_t new_size);
+
+/**
+ * @brief Recorre la arena en orden de offset: reservas y huecos libres.
+ *
+ * Lee los tramos del mapa de bits y ubica el manejador de cada reserva por
+ * su offset; cuesta O(palabras + reservas).
+ *
+ * @param visit Función invocada por cada segmento.
+ * @param ctx   Contexto para `visit`.
+ */
+void bitmap_walk(BlockVisitor visit, void *ctx);
+
+/**
+ * @brief Imprime gránulos libres, manejadores vivos, lotes del pool y la
+ *        tabla de manejadores por offset.
+ */
+void bitmap_print_stats(void);
+
+/**
+ * @brief Metadatos: mapa de bits, manejadores de las reservas vivas y su
+ *        tabla por offset.
+ *
+ * @param out Resultado.
+ */
+void bitmap_overhead(AllocOverhead *out);
+
+#endif /* BITMAP_H */
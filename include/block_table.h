@@ -0,0 +1,90 @@
+/**
+ * @file block_table.h
+ * @brief Tabla de bloques en arreglos paralelos (estructura de arreglos).
+ *
+ * Almacén alternativo al índice de `free_index.c` para las políticas de
+ * lista. Cada bloque de la lista ocupa una fila de la tabla: su offset, su
+ * tamaño y su indicador de libre viven en tres arreglos contiguos, y un
+ * cuarto arreglo apunta de vuelta al nodo `Block`. El orden por dirección lo
+ * sigue dando la lista enlazada; `Block::slot` es la fila de cada nodo.
+ *
+ * Las filas no guardan orden: al quitar un bloque, la última fila ocupa su
+ * lugar. Las búsquedas First/Best/Worst-Fit son pasadas lineales sin saltos
+ * de puntero sobre los arreglos, que el compilador puede vectorizar.
+ *
+ * La tabla es mantenida por `blocks.c` (ver `blocks_set_table()`).
+ */
+
+#ifndef BLOCK_TABLE_H
+#define BLOCK_TABLE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "blocks.h"
+
+/**
+ * @brief Libera los arreglos y deja la tabla vacía.
+ */
+void block_table_clear(void);
+
+/**
+ * @brief Agrega una fila para un bloque de la lista.
+ *
+ * @param block Bloque sin fila; su campo `slot` pasa a indicar la fila.
+ * @return false si los arreglos no pudieron crecer.
+ */
+bool block_table_add(Block *block);
+
+/**
+ * @brief Quita la fila de un bloque; la última fila ocupa su lugar.
+ *
+ * @param block Bloque con fila.
+ */
+void block_table_remove(Block *block);
+
+/**
+ * @brief Copia en su fila el offset, el tamaño y el estado de un bloque.
+ *
+ * @param block Bloque con fila.
+ */
+void block_table_sync(const Block *block);
+
+/**
+ * @brief Cantidad de filas (bloques de la lista).
+ */
+size_t block_table_rows(void);
+
+/**
+ * @brief First-Fit: bloque libre de menor offset >= from que aloja la
+ *        solicitud alineada.
+ *
+ * @param from  Offset mínimo de los candidatos.
+ * @param size  Tamaño solicitado en bytes.
+ * @param align Alineación (potencia de dos; 1 = sin alineación).
+ * @return Bloque encontrado, o NULL.
+ */
+Block *block_table_first_fit(size_t from, size_t size, size_t align);
+
+/**
+ * @brief Best-Fit: el bloque más pequeño que aloja la solicitud.
+ *
+ * Los empates se resuelven a favor del bloque de menor offset.
+ *
+ * @param size  Tamaño solicitado en bytes.
+ * @param align Alineación (potencia de dos; 1 = sin alineación).
+ * @return Bloque encontrado, o NULL.
+ */
+Block *block_table_best_fit(size_t size, size_t align);
+
+/**
+ * @brief Worst-Fit: el bloque más grande que aloja la solicitud.
+ *
+ * Los empates se resuelven a favor del bloque de menor offset.
+ *
+ * @param size  Tamaño solicitado en bytes.
+ * @param align Alineación (potencia de dos; 1 = sin alineación).
+ * @return Bloque encontrado, o NULL.
+ */
+Block *block_table_worst_fit(size_t size, size_t align);
+
+#endif /* BLOCK_TABLE_H */
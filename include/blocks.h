@@ -16,6 +16,12 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include "avl.h"
+
+struct Slab;
+
+/** @brief Nodos `Block` reservados por cada lote del pool de descriptores. */
+#define BLOCK_POOL_CHUNK 256
 
 /**
  * @struct Block
@@ -24,15 +30,52 @@
  * Cada bloque mantiene su posición relativa dentro de la arena (offset),
  * su tamaño, un indicador de si está libre y punteros al bloque anterior
  * y siguiente en la lista doblemente enlazada.
+ *
+ * Los bloques libres además pertenecen a los dos árboles del índice de
+ * `free_index.c` (por dirección y por tamaño). Los motores que redondean
+ * tamaños (buddy) los enlazan también en sus propias listas de libres.
+ *
+ * Las ranuras de la capa slab (`slab.c`) también son `Block`, pero no
+ * pertenecen a la lista: su campo `slab` apunta al slab que las contiene.
+ *
+ * Los nodos de la lista salen de un pool por lotes de BLOCK_POOL_CHUNK
+ * descriptores; un nodo absorbido por una fusión vuelve al pool (enlazado
+ * por `free_next`) en lugar de liberarse con `free()`.
+ *
+ * Con la tabla de bloques activa (`blocks_set_table()`), cada nodo de la
+ * lista tiene además una fila en `block_table.c` con su offset, tamaño y
+ * estado.
  */
 typedef struct Block {
     size_t offset;      /**< Desplazamiento inicial dentro de la arena. */
     size_t size;        /**< Tamaño del bloque en bytes. */
+    size_t requested;   /**< Bytes solicitados por el usuario (<= size); 0 si está libre.
+                             Las cachés de hilo lo cambian sin el cerrojo del heap,
+                             con escrituras atómicas. */
+    size_t zeroed;      /**< Bytes iniciales que quedaron en cero por CALLOC (<= requested);
+                             0 para los demás bloques. */
     bool   is_free;     /**< Indica si el bloque está libre (true) u ocupado (false). */
+    unsigned char align_shift; /**< log2 de la alineación que debe conservar al compactar. */
     struct Block *next; /**< Puntero al siguiente bloque en la lista. */
     struct Block *prev; /**< Puntero al bloque anterior en la lista. */
+    AvlNode addr_node;  /**< Nodo en el árbol de libres ordenado por offset. */
+    size_t  subtree_max; /**< Mayor tamaño libre en el subárbol de `addr_node`. */
+    AvlNode size_node;  /**< Nodo en el árbol de libres ordenado por (size, offset). */
+    struct Block *free_next; /**< Siguiente bloque en la lista de libres del motor. */
+    struct Block *free_prev; /**< Bloque anterior en la lista de libres del motor. */
+    struct Slab  *slab;      /**< Slab de la ranura, o del bloque que respalda un slab; NULL si no aplica. */
+    size_t slot;             /**< Fila en la tabla de `block_table.c`, si está activa. */
 } Block;
 
+/**
+ * @brief Función que mueve los datos de un bloque compactado.
+ *
+ * @param block      Bloque con su offset nuevo.
+ * @param old_offset Offset que tenía antes de moverse.
+ * @param ctx        Contexto del llamador.
+ */
+typedef void (*BlockMover)(Block *block, size_t old_offset, void *ctx);
+
 /**
  * @brief Crea un nuevo bloque de memoria.
  *
@@ -56,6 +99,21 @@ Block *block_create(size_t offset, size_t size, bool is_free);
  */
 void block_split(Block *block, size_t size);
 
+/**
+ * @brief Divide un bloque libre en `count` bloques ocupados contiguos.
+ *
+ * Equivale a `count` divisiones seguidas, pero el índice de libres se toca
+ * solo para retirar el bloque y para indexar el sobrante final. Cada bloque
+ * queda con `requested == size`.
+ *
+ * @param block Bloque libre de al menos `size * count` bytes.
+ * @param size  Tamaño de cada bloque.
+ * @param count Cantidad de bloques (al menos 1).
+ * @return Bloques reservados, a partir de `block` y siguiendo `next`; menos
+ *         de `count` si el pool de nodos no pudo crecer.
+ */
+size_t block_carve(Block *block, size_t size, size_t count);
+
 /**
  * @brief Intenta fusionar un bloque con sus vecinos libres.
  *
@@ -67,6 +125,112 @@ void block_split(Block *block, size_t size);
  */
 Block *block_merge(Block *block);
 
+/**
+ * @brief Une un bloque libre con el bloque libre que le sigue.
+ *
+ * A diferencia de `block_merge()`, solo considera al vecino siguiente y no
+ * verifica nada más que ambos estén libres; lo usan los motores que deciden
+ * por sí mismos qué bloques pueden unirse (por ejemplo, buddy).
+ *
+ * @param left Bloque libre cuyo siguiente también está libre.
+ * @return El bloque resultante (`left`), o NULL si no se pudo unir.
+ */
+Block *block_join(Block *left);
+
+/**
+ * @brief Une todas las corridas de bloques libres contiguos de la lista.
+ *
+ * Recorre la lista una sola vez; lo usan las políticas de lista en modo de
+ * fusión diferida, donde las liberaciones no llaman a `block_merge()`.
+ *
+ * @return Cantidad de uniones realizadas.
+ */
+size_t blocks_coalesce(void);
+
+/**
+ * @brief Libera un grupo de bloques ocupados y los fusiona en una pasada.
+ *
+ * Las corridas de bloques contiguos del grupo se unen antes de entrar al
+ * índice de libres, y cada corrida se fusiona luego con sus vecinos libres.
+ * El arreglo se reordena por offset y sus punteros quedan inválidos.
+ *
+ * @param blocks Bloques ocupados de la lista.
+ * @param count  Cantidad de bloques.
+ */
+void blocks_release(Block **blocks, size_t count);
+
+/**
+ * @brief Marca un bloque como libre y lo registra en el índice de libres.
+ *
+ * No realiza fusiones; para ello debe llamarse a `block_merge()`.
+ *
+ * @param block Bloque ocupado que pasa a estar libre.
+ */
+void block_mark_free(Block *block);
+
+/**
+ * @brief Marca un bloque como ocupado y lo retira del índice de libres.
+ *
+ * @param block Bloque libre que pasa a estar ocupado.
+ */
+void block_mark_used(Block *block);
+
+/**
+ * @brief Expande un bloque tomando bytes del bloque libre siguiente.
+ *
+ * Si el bloque siguiente tiene exactamente `extra` bytes se absorbe por
+ * completo; si tiene más, se desplaza su inicio y se reduce su tamaño.
+ *
+ * @param block Bloque a expandir.
+ * @param extra Cantidad de bytes a tomar del bloque siguiente.
+ * @return true si la expansión se realizó, false si el bloque siguiente no
+ *         existe, no está libre o no tiene espacio suficiente.
+ */
+bool block_grow(Block *block, size_t extra);
+
+/**
+ * @brief Expande un bloque ocupado hacia el bloque libre anterior y, si hace
+ *        falta, también hacia el siguiente.
+ *
+ * El bloque pasa a empezar en el offset más alto, múltiplo de `align`, desde
+ * el que caben `size` bytes en el rango formado por el anterior libre, el
+ * propio bloque y el siguiente libre. Lo que sobra del anterior queda libre
+ * delante; el sobrante final (menor que `align`) queda en el siguiente libre
+ * o, si no lo hay, dentro del bloque. El nodo conserva su identidad; los
+ * datos no se mueven y quedan a cargo de quien llama.
+ *
+ * @param block Bloque ocupado.
+ * @param size  Tamaño requerido en bytes.
+ * @param align Alineación del nuevo offset (potencia de dos).
+ * @return true si el bloque se desplazó hacia atrás y cubre `size` bytes;
+ *         false si el anterior no está libre o el rango no alcanza.
+ */
+bool block_expand_back(Block *block, size_t size, size_t align);
+
+/**
+ * @brief Registra la alineación que un bloque ocupado debe conservar
+ *        cuando se compacta la arena.
+ *
+ * @param block Bloque ocupado.
+ * @param align Alineación en bytes (potencia de dos; 1 = ninguna).
+ */
+void block_set_alignment(Block *block, size_t align);
+
+/**
+ * @brief Compacta la lista: desliza los bloques ocupados hacia el offset 0
+ *        y deja el espacio libre en un bloque al final.
+ *
+ * Los descriptores ocupados no cambian (solo su offset), por lo que los
+ * `Block *` guardados por otros módulos siguen siendo válidos. Cada bloque
+ * alineado conserva su alineación; el hueco que eso deje antes de él queda
+ * como bloque libre.
+ *
+ * @param move Invocada por cada bloque que cambia de offset.
+ * @param ctx  Contexto para `move`.
+ * @return Bytes de bloques ocupados que cambiaron de lugar.
+ */
+size_t blocks_compact(BlockMover move, void *ctx);
+
 /**
  * @brief Obtiene el primer bloque de la lista.
  *
@@ -74,6 +238,26 @@ Block *block_merge(Block *block);
  */
 Block *blocks_first(void);
 
+/**
+ * @brief Obtiene el último bloque de la lista.
+ *
+ * Recorre la lista completa (O(n)); solo se usa al hacer crecer la arena.
+ *
+ * @return Puntero al último bloque, o NULL si la lista está vacía.
+ */
+Block *blocks_last(void);
+
+/**
+ * @brief Extiende la lista para cubrir bytes agregados al final de la arena.
+ *
+ * El último bloque crece si está libre; si está ocupado, se agrega detrás
+ * un bloque libre nuevo. El índice o la tabla de libres se actualizan.
+ *
+ * @param extra Bytes agregados.
+ * @return Bloque libre final, o NULL si no se pudo crear.
+ */
+Block *blocks_extend(size_t extra);
+
 /**
  * @brief Obtiene el siguiente bloque en la lista.
  *
@@ -82,11 +266,123 @@ Block *blocks_first(void);
  */
 Block *blocks_next(Block *block);
 
+/**
+ * @brief Activa o desactiva el mantenimiento del índice de libres.
+ *
+ * Los motores con listas de libres propias lo desactivan mientras están
+ * activos; al reactivarlo, el índice se reconstruye con los bloques libres.
+ * Si se eligió la tabla de bloques, es ella la que se activa o desactiva.
+ *
+ * @param enabled true para mantener el índice de `free_index.c`.
+ */
+void blocks_set_indexed(bool enabled);
+
+/**
+ * @brief Elige la tabla de `block_table.c` en lugar del índice de
+ *        `free_index.c` para las políticas de lista.
+ *
+ * Mientras un motor mantenga desactivado el índice, tampoco se mantiene la
+ * tabla; se construye al volver a una política de lista.
+ *
+ * @param enabled true para la tabla, false para el índice.
+ * @return true si quedó en uso el almacén pedido (la tabla puede fallar
+ *         por falta de memoria).
+ */
+bool blocks_set_table(bool enabled);
+
+/**
+ * @brief Indica si las búsquedas deben hacerse sobre la tabla de bloques.
+ *
+ * @return true si la tabla está elegida y se está manteniendo.
+ */
+bool blocks_table_active(void);
+
+/**
+ * @brief Obtiene el puntero móvil usado por Next-Fit.
+ *
+ * Si una fusión libera el nodo al que apunta, el puntero pasa al bloque que
+ * lo absorbió, por lo que nunca queda colgando.
+ *
+ * @return Bloque de la última asignación Next-Fit, o NULL si no hay ninguno.
+ */
+Block *blocks_rover(void);
+
+/**
+ * @brief Establece el puntero móvil usado por Next-Fit.
+ *
+ * @param block Bloque desde el cual continuará la próxima búsqueda.
+ */
+void blocks_set_rover(Block *block);
+
 /**
  * @brief Libera todos los bloques y destruye la lista completa.
  *
- * Utilizada al finalizar la ejecución del programa o al reiniciar la arena.
+ * Devuelve los lotes del pool sin recorrer la lista, por lo que el costo no
+ * depende de la cantidad de bloques. Utilizada al finalizar la ejecución del
+ * programa o al reiniciar la arena.
  */
 void blocks_destroy(void);
 
+/**
+ * @brief Arma la lista completa de una sola vez a partir de arreglos
+ *        paralelos, como los de una instantánea (`snapshot.c`).
+ *
+ * La lista debe estar vacía. El primer bloque inicia en el offset 0 y cada
+ * uno sigue al anterior sin huecos.
+ *
+ * @param count        Cantidad de bloques.
+ * @param sizes        Tamaño de cada bloque, en orden de offset.
+ * @param requested    Bytes solicitados de cada bloque (0 si está libre).
+ * @param zeroed       Bytes iniciales en cero de CALLOC de cada bloque.
+ * @param free_flags   Distinto de 0 si el bloque está libre.
+ * @param align_shifts log2 de la alineación que conserva cada bloque.
+ * @param nodes        Recibe el nodo creado para cada bloque (puede ser NULL).
+ * @return true si la lista quedó armada; false (y lista vacía) si falta memoria.
+ */
+bool blocks_restore(size_t count, const size_t *sizes, const size_t *requested,
+                    const size_t *zeroed, const unsigned char *free_flags,
+                    const unsigned char *align_shifts, Block **nodes);
+
+/**
+ * @brief Cantidad de nodos de la lista y de descriptores reservados en el pool.
+ *
+ * @param live     Nodos en uso por la lista (puede ser NULL).
+ * @param reserved Descriptores reservados en todos los lotes (puede ser NULL).
+ */
+void blocks_pool_usage(size_t *live, size_t *reserved);
+
+/**
+ * @brief Divisiones (`block_split()`) y uniones (`block_join()`) realizadas.
+ *
+ * Permite cuantificar cuánto trabajo de dividir y volver a fusionar hacen
+ * los motores que usan la lista general.
+ *
+ * @param splits Bloques divididos (puede ser NULL).
+ * @param joins  Pares de bloques libres unidos (puede ser NULL).
+ */
+void blocks_churn(size_t *splits, size_t *joins);
+
+/**
+ * @brief Reinicia los contadores de `blocks_churn()`.
+ */
+void blocks_churn_reset(void);
+
+/**
+ * @brief Toma un descriptor del pool sin enlazarlo a la lista.
+ *
+ * Lo usan los motores que no mantienen la lista general y necesitan un
+ * `Block` manejador por reserva. El descriptor se libera junto con el pool
+ * en `blocks_destroy()`.
+ *
+ * @return Descriptor sin inicializar, o NULL si el pool no puede crecer.
+ */
+Block *block_node_get(void);
+
+/**
+ * @brief Devuelve al pool un descriptor obtenido con `block_node_get()`.
+ *
+ * @param block Descriptor que deja de usarse.
+ */
+void block_node_put(Block *block);
+
 #endif /* BLOCKS_H */
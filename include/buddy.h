@@ -0,0 +1,104 @@
+/**
+ * @file buddy.h
+ * @brief Motor de asignación buddy binario.
+ *
+ * Alternativa a la división/fusión libre de `blocks.c`: todos los bloques
+ * tienen un tamaño potencia de dos y están alineados a su tamaño. Cada orden
+ * tiene su propia lista de bloques libres y, al liberar, el "buddy" de un
+ * bloque de orden k se obtiene como `offset ^ 2^k`, sin recorrer la lista
+ * de bloques.
+ *
+ * Los bloques siguen siendo nodos `Block` de la lista por dirección, por lo
+ * que la impresión del heap y la tabla de variables funcionan sin cambios.
+ * La diferencia entre `size` y `requested` de los bloques ocupados es la
+ * fragmentación interna causada por el redondeo.
+ */
+
+#ifndef BUDDY_H
+#define BUDDY_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "blocks.h"
+#include "allocator.h"
+
+/**
+ * @brief Orden del bloque más pequeño que maneja el motor (2^4 = 16 bytes).
+ */
+#define BUDDY_MIN_ORDER 4
+
+/**
+ * @brief Reorganiza la arena en bloques buddy.
+ *
+ * La arena se descompone en los bloques potencia de dos más grandes posibles
+ * (por ejemplo, 2000 = 1024 + 512 + 256 + 128 + 64 + 16). Un sobrante menor
+ * a 2^BUDDY_MIN_ORDER queda libre pero fuera del motor.
+ *
+ * @param arena_size Tamaño total de la arena.
+ * @return true si se inicializó, false si hay bloques ocupados o falta memoria.
+ */
+bool buddy_init(size_t arena_size);
+
+/**
+ * @brief Libera las estructuras internas del motor.
+ *
+ * Los bloques de la lista se conservan tal como están.
+ */
+void buddy_destroy(void);
+
+/**
+ * @brief Bloque libre del menor orden disponible que puede contener `size`.
+ *
+ * @param size  Tamaño solicitado en bytes.
+ * @param align Alineación en bytes (potencia de dos).
+ * @return Bloque libre que `buddy_alloc()` dividiría, o NULL.
+ */
+Block *buddy_find_block(size_t size, size_t align);
+
+/**
+ * @brief Reserva un bloque de 2^k bytes, con 2^k >= size.
+ *
+ * Divide a la mitad el bloque del menor orden disponible hasta alcanzar el
+ * orden requerido; cada mitad superior queda en la lista de su orden.
+ * Como los bloques de orden k están alineados a 2^k, una alineación mayor
+ * al tamaño se resuelve subiendo el orden.
+ *
+ * @param size  Tamaño solicitado en bytes.
+ * @param align Alineación en bytes (potencia de dos).
+ * @return Bloque ocupado, o NULL si no hay un bloque suficiente.
+ */
+Block *buddy_alloc(size_t size, size_t align);
+
+/**
+ * @brief Libera un bloque y lo fusiona con su buddy mientras esté libre.
+ *
+ * @param block Bloque ocupado reservado por el motor.
+ */
+void buddy_free(Block *block);
+
+/**
+ * @brief Cambia el orden de un bloque ocupado sin moverlo.
+ *
+ * Reducir siempre es posible (las mitades superiores se liberan). Crecer
+ * requiere que el bloque sea la mitad inferior y que cada buddy superior
+ * esté libre y completo hasta el orden requerido.
+ *
+ * @param block    Bloque ocupado.
+ * @param new_size Nuevo tamaño solicitado.
+ * @return true si el bloque cubre `new_size` sin moverse.
+ */
+bool buddy_resize(Block *block, size_t new_size);
+
+/**
+ * @brief Imprime la cantidad de bloques libres de cada orden no vacío.
+ */
+void buddy_print_stats(void);
+
+/**
+ * @brief Metadatos: nodos de la lista y mapa de inicios de bloques libres.
+ *
+ * @param out Resultado.
+ */
+void buddy_overhead(AllocOverhead *out);
+
+#endif /* BUDDY_H */
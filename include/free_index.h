@@ -0,0 +1,155 @@
+/**
+ * @file free_index.h
+ * @brief Índice de bloques libres para las políticas de asignación.
+ *
+ * Este módulo mantiene, en paralelo a la lista de bloques ordenada por
+ * dirección, dos árboles balanceados que contienen únicamente los bloques
+ * libres:
+ *
+ * - uno ordenado por offset y aumentado con el tamaño libre máximo de cada
+ *   subárbol, que resuelve First-Fit en O(log n);
+ * - otro ordenado por (tamaño, offset), que resuelve Best-Fit como una
+ *   búsqueda de cota inferior y Worst-Fit como una búsqueda del máximo.
+ *
+ * El índice es mantenido por `blocks.c`: todo bloque libre está indexado y
+ * ningún bloque ocupado lo está.
+ */
+
+#ifndef FREE_INDEX_H
+#define FREE_INDEX_H
+
+#include <stddef.h>
+#include "blocks.h"
+
+/**
+ * @brief Vacía el índice de bloques libres.
+ *
+ * No libera los bloques; únicamente olvida los árboles existentes.
+ */
+void free_index_reset(void);
+
+/**
+ * @brief Inserta un bloque libre en el índice.
+ *
+ * @param block Bloque libre a indexar. Su offset y tamaño solo deben
+ *              modificarse mediante `free_index_resize()` mientras
+ *              permanezca en el índice.
+ */
+void free_index_insert(Block *block);
+
+/**
+ * @brief Reemplaza el índice por uno armado de una vez con bloques libres.
+ *
+ * Cuesta O(n) para el árbol por dirección más un ordenamiento por tamaño,
+ * en lugar de n inserciones con sus rebalanceos.
+ *
+ * @param blocks Bloques libres en orden de offset; el arreglo se reordena.
+ * @param count  Cantidad de bloques.
+ * @return false si no hubo memoria; el índice queda vacío.
+ */
+bool free_index_build(Block **blocks, size_t count);
+
+/**
+ * @brief Retira un bloque del índice.
+ *
+ * @param block Bloque previamente insertado con `free_index_insert()`.
+ */
+void free_index_remove(Block *block);
+
+/**
+ * @brief Actualiza el offset y el tamaño de un bloque indexado.
+ *
+ * El nuevo rango no debe solaparse con ningún otro bloque libre, de modo
+ * que el bloque conserve su posición en el orden por dirección.
+ *
+ * @param block  Bloque libre indexado.
+ * @param offset Nuevo offset del bloque.
+ * @param size   Nuevo tamaño del bloque.
+ */
+void free_index_resize(Block *block, size_t offset, size_t size);
+
+/**
+ * @brief Bloque libre de menor offset con tamaño >= size (First-Fit).
+ *
+ * @param size Tamaño solicitado en bytes.
+ * @return Bloque encontrado, o NULL si ninguno es suficientemente grande.
+ */
+Block *free_index_first_fit(size_t size);
+
+/**
+ * @brief Bloque libre de menor offset, a partir de `from`, con tamaño >= size.
+ *
+ * Base de Next-Fit: solo se consideran bloques con offset >= from.
+ *
+ * @param from Offset mínimo de los bloques candidatos.
+ * @param size Tamaño solicitado en bytes.
+ * @return Bloque encontrado, o NULL si ninguno a partir de `from` es
+ *         suficientemente grande.
+ */
+Block *free_index_first_fit_from(size_t from, size_t size);
+
+/**
+ * @brief Bloque libre más pequeño con tamaño >= size (Best-Fit).
+ *
+ * Los empates se resuelven a favor del bloque de menor offset.
+ *
+ * @param size Tamaño solicitado en bytes.
+ * @return Bloque encontrado, o NULL si ninguno es suficientemente grande.
+ */
+Block *free_index_best_fit(size_t size);
+
+/**
+ * @brief Bloque libre más grande, si su tamaño es >= size (Worst-Fit).
+ *
+ * Los empates se resuelven a favor del bloque de menor offset.
+ *
+ * @param size Tamaño solicitado en bytes.
+ * @return Bloque encontrado, o NULL si ninguno es suficientemente grande.
+ */
+Block *free_index_worst_fit(size_t size);
+
+/**
+ * @brief Relleno necesario para alinear `offset` a `align` (potencia de dos).
+ */
+size_t free_index_align_pad(size_t offset, size_t align);
+
+/**
+ * @brief Indica si un bloque libre puede alojar `size` bytes alineados.
+ *
+ * @param block Bloque libre.
+ * @param size  Tamaño solicitado.
+ * @param align Alineación (potencia de dos; 1 = sin alineación).
+ * @return true si `relleno + size <= block->size`.
+ */
+bool free_index_fits(const Block *block, size_t size, size_t align);
+
+/**
+ * @brief First-Fit alineado a partir de `from`.
+ *
+ * @param from  Offset mínimo de los candidatos.
+ * @param size  Tamaño solicitado en bytes.
+ * @param align Alineación (potencia de dos).
+ * @return Bloque libre de menor offset >= from que aloja la solicitud
+ *         alineada, o NULL.
+ */
+Block *free_index_first_fit_aligned(size_t from, size_t size, size_t align);
+
+/**
+ * @brief Best-Fit alineado: el bloque más pequeño que aloja la solicitud.
+ *
+ * @param size  Tamaño solicitado en bytes.
+ * @param align Alineación (potencia de dos).
+ * @return Bloque encontrado, o NULL.
+ */
+Block *free_index_best_fit_aligned(size_t size, size_t align);
+
+/**
+ * @brief Worst-Fit alineado: el bloque más grande que aloja la solicitud.
+ *
+ * @param size  Tamaño solicitado en bytes.
+ * @param align Alineación (potencia de dos).
+ * @return Bloque encontrado, o NULL.
+ */
+Block *free_index_worst_fit_aligned(size_t size, size_t align);
+
+#endif /* FREE_INDEX_H */
@@ -10,6 +10,7 @@
 #ifndef LOG_H
 #define LOG_H
 
+#include <stdbool.h>
 #include <stdio.h>
 
 /**
@@ -39,4 +40,20 @@ void log_info(const char *fmt, ...);
  */
 void log_error(const char *fmt, ...);
 
+/**
+ * @brief Silencia los mensajes informativos del hilo actual.
+ *
+ * Con el modo silencioso activo, `log_info` no imprime nada y el parser no
+ * repite las líneas que ejecuta; los errores se siguen mostrando. Lo usan
+ * los hilos de la reproducción concurrente para no medir la salida.
+ *
+ * @param quiet true para silenciar el hilo actual.
+ */
+void log_set_quiet(bool quiet);
+
+/**
+ * @brief Indica si el hilo actual está en modo silencioso.
+ */
+bool log_quiet(void);
+
 #endif /* LOG_H */
@@ -5,20 +5,60 @@
  * Este módulo administra un bloque continuo de memoria (arena)
  * sobre el cual se implementan los algoritmos de asignación 
  * (first-fit, best-fit, worst-fit). Provee funciones para inicializar,
- * limpiar y obtener punteros relevantes dentro de la arena.
+ * limpiar y obtener punteros relevantes dentro de la arena, y para hacerla
+ * crecer cuando una reserva no cabe.
  */
 
 #ifndef MEMORY_H
 #define MEMORY_H
 
 #include <stddef.h>
+#include <stdbool.h>
+
+/** @brief No reservar swap para la arena (`MAP_NORESERVE`). */
+#define MEMORY_NORESERVE (1u << 0)
+
+/** @brief Respaldar la arena con páginas enormes explícitas (`MAP_HUGETLB`). */
+#define MEMORY_HUGETLB   (1u << 1)
+
+/** @brief Pedir páginas enormes transparentes (`madvise(MADV_HUGEPAGE)`). */
+#define MEMORY_THP       (1u << 2)
+
+/**
+ * @brief Límite de crecimiento por defecto: rango virtual reservado (sin
+ *        memoria física) al iniciar la arena.
+ */
+#define MEMORY_DEFAULT_LIMIT ((size_t)1 << 40)
+
+/**
+ * @enum MemoryGrowth
+ * @brief Cuánto crece la arena cuando una reserva no cabe.
+ */
+typedef enum {
+    MEMORY_GROW_OFF,    /**< La arena no crece (por defecto). */
+    MEMORY_GROW_EXACT,  /**< Solo lo que falta para la reserva. */
+    MEMORY_GROW_STEP,   /**< Lo que falta, redondeado a múltiplos de un paso. */
+    MEMORY_GROW_DOUBLE  /**< Duplica la arena (o lo que falta, si es más). */
+} MemoryGrowth;
+
+/**
+ * @struct MemoryGrowthStats
+ * @brief Política de crecimiento vigente y crecimientos realizados.
+ *
+ * La arena nunca se reduce, así que su huella máxima es `memory_size()`.
+ */
+typedef struct {
+    MemoryGrowth policy;  /**< Política vigente. */
+    size_t step;          /**< Paso de `MEMORY_GROW_STEP`. */
+    size_t initial;       /**< Tamaño con el que se inició la arena. */
+    size_t limit;         /**< Tamaño máximo que puede alcanzar. */
+    size_t grows;         /**< Crecimientos realizados. */
+} MemoryGrowthStats;
 
 /**
  * @brief Inicializa la arena de memoria simulada.
  *
- * Solicita un bloque contiguo de memoria al sistema operativo mediante
- * `malloc`, el cual será utilizado para simular todas las operaciones
- * dinámicas del sistema (ALLOC, REALLOC, FREE).
+ * Equivale a `memory_init_flags(size, 0)`.
  *
  * @param size Tamaño total en bytes del bloque a solicitar.
  *
@@ -28,6 +68,40 @@
  */
 void memory_init(size_t size);
 
+/**
+ * @brief Inicializa la arena de memoria simulada con opciones de mapeo.
+ *
+ * Solicita un bloque contiguo de memoria al sistema operativo mediante un
+ * `mmap` anónimo, el cual será utilizado para simular todas las operaciones
+ * dinámicas del sistema (ALLOC, REALLOC, FREE). La arena empieza en cero sin
+ * recorrerla: el kernel entrega cada página al tocarla por primera vez, así
+ * que el tiempo de inicio y la memoria residente no dependen de `size`. Si
+ * se piden páginas enormes explícitas y no hay, se usan páginas normales.
+ *
+ * @param size  Tamaño total en bytes del bloque a solicitar.
+ * @param flags Combinación de `MEMORY_NORESERVE`, `MEMORY_HUGETLB` y
+ *              `MEMORY_THP` (0 = ninguna).
+ */
+void memory_init_flags(size_t size, unsigned flags);
+
+/**
+ * @brief Inicializa la arena con el contenido de un archivo, sin crear
+ *        bloques.
+ *
+ * Si `offset` está alineado a página y el archivo cubre las páginas de la
+ * arena, estas se mapean del archivo de forma privada (`MAP_PRIVATE`): se
+ * leen recién al tocarlas y las escrituras no modifican el archivo. Si no,
+ * se copian con `pread`. La arena puede crecer igual que con
+ * `memory_init_flags()`. Quien llama debe armar la lista de bloques (ver
+ * `blocks_restore()`).
+ *
+ * @param size   Tamaño de la arena en bytes.
+ * @param fd     Descriptor del archivo, abierto para lectura.
+ * @param offset Posición del contenido de la arena en el archivo.
+ * @return true si la arena quedó inicializada; false (sin arena) si falla.
+ */
+bool memory_init_image(size_t size, int fd, size_t offset);
+
 /**
  * @brief Libera completamente la arena de memoria simulada.
  *
@@ -45,6 +119,89 @@ void memory_destroy(void);
  */
 void *memory_arena(void);
 
+/**
+ * @brief Obtiene el tamaño total de la arena simulada.
+ *
+ * @return Tamaño en bytes indicado en `memory_init()`, o 0 si la arena no
+ *         ha sido inicializada.
+ */
+size_t memory_size(void);
+
+/**
+ * @brief Bytes de la arena que ya tienen memoria física asignada.
+ *
+ * @return Bytes residentes (páginas tocadas), o 0 si no se pudo consultar.
+ */
+size_t memory_resident(void);
+
+/**
+ * @brief Fija el límite de crecimiento de la arena.
+ *
+ * Debe llamarse antes de `memory_init_flags()`; el rango se reserva al
+ * iniciar la arena. Por defecto es `MEMORY_DEFAULT_LIMIT`.
+ *
+ * @param limit Tamaño máximo en bytes.
+ */
+void memory_set_limit(size_t limit);
+
+/**
+ * @brief Elige la política de crecimiento de la arena.
+ *
+ * @param policy Política (`MEMORY_GROW_OFF` desactiva el crecimiento).
+ * @param step   Bytes por paso con `MEMORY_GROW_STEP`; ignorado en las demás.
+ */
+void memory_set_growth(MemoryGrowth policy, size_t step);
+
+/**
+ * @brief Hace crecer la arena al final según la política vigente.
+ *
+ * El crecimiento es de al menos `need` bytes y no supera el límite. La
+ * arena no se mueve. Quien llama debe extender sus estructuras de bloques
+ * (ver `allocator_grow()`).
+ *
+ * @param need Bytes adicionales mínimos.
+ * @return true si la arena creció; false si la política es
+ *         `MEMORY_GROW_OFF` o se alcanzó el límite.
+ */
+bool memory_grow(size_t need);
+
+/**
+ * @brief Política de crecimiento y crecimientos realizados.
+ *
+ * @return Puntero de solo lectura al estado interno.
+ */
+const MemoryGrowthStats *memory_growth(void);
+
+/**
+ * @brief Registra que un rango de la arena pudo dejar de estar en cero.
+ *
+ * La arena lleva un mapa con un bit por página: una página está limpia
+ * mientras nada se escribió en ella desde que se mapeó (las páginas de un
+ * mapeo anónimo nuevo, incluidas las que agrega `memory_grow()`, están en
+ * cero). Quien escribe en la arena debe marcar el rango, aunque no escriba
+ * los bytes de verdad (modo de contenido `none`), para que el mapa refleje
+ * el contenido que la traza habría dejado.
+ *
+ * @param offset Inicio del rango.
+ * @param size   Bytes del rango.
+ */
+void memory_mark_dirty(size_t offset, size_t size);
+
+/**
+ * @brief Pone en cero un rango de la arena, salteando las páginas limpias.
+ *
+ * Solo se limpian las partes del rango que caen en páginas marcadas; las
+ * páginas que el rango cubre completas vuelven a quedar limpias. Con
+ * `write` en false no se escribe nada y el mapa no cambia: solo se calcula
+ * cuánto habría que limpiar.
+ *
+ * @param offset Inicio del rango.
+ * @param size   Bytes del rango.
+ * @param write  true para escribir los ceros.
+ * @return Bytes que hubo que limpiar (el resto ya estaba en cero).
+ */
+size_t memory_zero(size_t offset, size_t size, bool write);
+
 /**
  * @brief Retorna un puntero al inicio del primer bloque de control.
  *
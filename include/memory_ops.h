@@ -14,6 +14,38 @@
 #define MEMORY_OPS_H
 
 #include <stddef.h>
+#include <stdbool.h>
+#include "memory.h"
+
+/** @brief Largest request, in bytes, served by the per-thread caches. */
+#define MEM_CACHE_MAX_SIZE 256
+
+/** @brief Size-class granularity of the per-thread caches, in bytes. */
+#define MEM_CACHE_GRANULE 16
+
+/** @brief Most blocks a per-thread cache keeps in one size class. */
+#define MEM_CACHE_MAX_DEPTH 64
+
+/**
+ * @enum MemPayload
+ * @brief What ALLOC and REALLOC write into the bytes of a block.
+ */
+typedef enum {
+    MEM_PAYLOAD_NONE,     /**< Nothing: only block metadata is simulated. */
+    MEM_PAYLOAD_FILL,     /**< The first letter of the variable name (default). */
+    MEM_PAYLOAD_PATTERN   /**< A pattern derived from the name and byte position. */
+} MemPayload;
+
+/**
+ * @struct MemCacheStats
+ * @brief Counters of one thread's block cache.
+ */
+typedef struct {
+    size_t hits;      /**< Allocations served from the cache, without the heap lock. */
+    size_t misses;    /**< Cacheable allocations that found their class empty. */
+    size_t stores;    /**< Frees kept in the cache instead of reaching the heap. */
+    size_t flushes;   /**< Cached blocks later returned to the heap. */
+} MemCacheStats;
 
 /**
  * @brief Allocates a memory block in the simulated memory and associates it with a variable name.
@@ -24,9 +56,28 @@
  *
  * @param name Name of the variable to associate with the allocated block.
  * @param size Size in bytes to allocate.
+ * @param align Required offset alignment in bytes (power of two; 1 for none).
  * @return int Returns 0 on success, or a negative error code on failure.
  */
-int mem_alloc(const char *name, size_t size);
+int mem_alloc(const char *name, size_t size, size_t align);
+
+/**
+ * @brief Allocates a zero-filled array of `count` elements of `size` bytes.
+ *
+ * The product `count * size` is checked for overflow. Only the parts of the
+ * block lying on pages written since they were mapped are cleared (see
+ * `memory_zero()`); fresh pages are already zero and are skipped. The bytes
+ * requested and the bytes actually cleared are added to the allocator
+ * statistics. With `MEM_PAYLOAD_NONE` nothing is written, but the bytes
+ * that would need clearing are still counted.
+ *
+ * @param name Name of the variable to associate with the allocated block.
+ * @param count Number of elements.
+ * @param size Size in bytes of each element.
+ * @param align Required offset alignment in bytes (power of two; 1 for none).
+ * @return int Returns 0 on success, or a negative error code on failure.
+ */
+int mem_calloc(const char *name, size_t count, size_t size, size_t align);
 
 /**
  * @brief Frees a previously allocated block associated with the given variable name.
@@ -40,18 +91,178 @@ int mem_alloc(const char *name, size_t size);
  */
 int mem_free(const char *name);
 
+/**
+ * @brief Allocates `count` blocks of `size` bytes named `prefix0` .. `prefix<count-1>`.
+ *
+ * All names are checked against the variable table in a single pass. The
+ * whole run is then carved from one free block found with a single search
+ * of the active policy, so the blocks end up contiguous; when no free block
+ * holds the run, the engine has no run hook, or the slab layer is enabled,
+ * the blocks are allocated one at a time (with the usual compaction and
+ * growth retries). If any block does not fit, the ones already allocated
+ * are freed and no variable is registered. One log line covers the batch.
+ *
+ * @param prefix Name prefix of the variables.
+ * @param count Number of blocks.
+ * @param size Size in bytes of each block.
+ * @param align Required offset alignment in bytes (power of two; 1 for none).
+ * @return int Returns 0 on success, or a negative error code on failure.
+ */
+int mem_alloc_n(const char *prefix, size_t count, size_t size, size_t align);
+
+/**
+ * @brief Frees every variable whose name starts with `prefix`.
+ *
+ * The variables are collected and removed from the table in one pass and
+ * their blocks are returned together: adjacent blocks of the group are
+ * merged before entering the free index, and each resulting run is
+ * coalesced with its free neighbours once.
+ *
+ * @param prefix Name prefix; an empty prefix frees every variable.
+ * @return int Returns 0 on success, or a negative error code if no variable matches.
+ */
+int mem_free_prefix(const char *prefix);
+
 /**
  * @brief Changes the size of a previously allocated block in the simulated memory.
  *
  * The memory block bound to the given variable name is reallocated
- * to the new size. Depending on available space and algorithm selection,
- * the block may move to a new location. In such cases, the old block is
- * freed and the new block is filled with the variable name.
+ * to the new size. The block first tries to grow in place into the next
+ * free block. Otherwise, with the list policies, it may slide down into a
+ * free previous block (together with the next one if needed); its contents
+ * are moved with an overlapping `memmove` and the variable keeps the same
+ * block. As a last resort the block moves to a new location: the old block
+ * is freed and the new block is filled with the variable name. A block
+ * whose offset does not satisfy `align` always changes offset. Each case
+ * is counted in the allocator statistics along with the bytes copied.
  *
  * @param name Name of the variable to reallocate.
  * @param new_size New size in bytes for the block.
+ * @param align Required offset alignment in bytes (power of two; 1 for none).
  * @return int Returns 0 on success, or a negative error code on failure.
  */
-int mem_realloc(const char *name, size_t new_size); 
+int mem_realloc(const char *name, size_t new_size, size_t align); 
+
+/**
+ * @brief Compacts the simulated memory by sliding used blocks towards offset 0.
+ *
+ * Block contents are moved with `memmove` and all free space ends up in a
+ * single block at the end of the arena (aligned blocks may leave small gaps
+ * in front of them). Variables keep their blocks, since the block
+ * descriptors themselves are not replaced. Bytes moved and time spent are
+ * logged and accumulated in the allocator statistics. A heap shared between
+ * threads is never compacted, explicitly or on allocation failure, since
+ * other threads use their blocks without holding the heap lock.
+ *
+ * @return int Returns 0 on success, or -1 if the active engine cannot compact
+ *         or the heap is shared.
+ */
+int mem_compact(void);
+
+/**
+ * @brief Enables or disables compaction when an allocation does not fit.
+ *
+ * When enabled, an ALLOC or the move path of a REALLOC that finds no free
+ * block compacts the arena and retries once.
+ *
+ * @param enabled true to compact on allocation failure.
+ */
+void mem_set_compact_on_failure(bool enabled);
+
+/**
+ * @brief Selects what allocations write into their blocks.
+ *
+ * `MEM_PAYLOAD_FILL` fills each block with the first letter of its variable
+ * name using `memset`. `MEM_PAYLOAD_PATTERN` writes a pseudo-random pattern,
+ * one 64-bit word at a time, that depends only on the name and the byte
+ * position inside the block, so it survives moves and compaction and can be
+ * checked with `mem_verify_payload()`. `MEM_PAYLOAD_NONE` writes nothing and
+ * skips the copy on the move path of REALLOC, so replaying a trace costs the
+ * same regardless of block sizes (explicit compaction still moves bytes).
+ *
+ * The mode applies to later writes; bytes written under a previous mode are
+ * left as they are.
+ *
+ * @param mode Payload mode.
+ */
+void mem_set_payload(MemPayload mode);
+
+/**
+ * @brief Looks up a payload mode by name ("none", "fill" or "pattern").
+ *
+ * The comparison ignores case.
+ *
+ * @param name Mode name.
+ * @param out Receives the mode when the name is valid.
+ * @return bool true if the name matches a mode.
+ */
+bool mem_payload_from_name(const char *name, MemPayload *out);
+
+/**
+ * @brief Checks that every variable holds the payload of the active mode.
+ *
+ * Each mismatching variable is logged with the first wrong byte, followed by
+ * a summary line. The zero prefix left by CALLOC (kept across REALLOC) must
+ * still be zero and every other byte must match the payload exactly. Only
+ * meaningful when all live blocks were written under the current mode.
+ *
+ * @return int Returns 0 if all variables match, or -1 if any does not or the
+ *         active mode is `MEM_PAYLOAD_NONE`.
+ */
+int mem_verify_payload(void);
+
+/**
+ * @brief Sets how the simulated memory grows when an allocation does not fit.
+ *
+ * With a policy other than `MEMORY_GROW_OFF`, an ALLOC or the move path of a
+ * REALLOC that finds no free block (even after automatic compaction) grows
+ * the arena at its end and retries, until the block fits or the arena
+ * reaches its limit. Each growth is logged.
+ *
+ * @param policy Growth policy: off, exact, fixed step or doubling.
+ * @param step Step in bytes for `MEMORY_GROW_STEP`; ignored otherwise.
+ */
+void mem_set_growth(MemoryGrowth policy, size_t step);
+
+/**
+ * @brief Sets how many freed blocks per size class each thread may cache.
+ *
+ * Only contexts that share their heap with other threads (see
+ * `sim_context_create_shared()`) use the caches. There, a FREE of a block
+ * of at most `MEM_CACHE_MAX_SIZE` bytes keeps it in the thread's cache,
+ * still allocated as far as the heap is concerned, and a later unaligned
+ * ALLOC or CALLOC of the same `MEM_CACHE_GRANULE`-byte class reuses it
+ * without taking the heap lock. Cacheable requests that miss are rounded up
+ * to their class in the heap so their blocks come back to the same class.
+ * When a class is full, its older half goes back to the heap in one locked
+ * group free.
+ *
+ * @param depth Blocks per class, capped at `MEM_CACHE_MAX_DEPTH`; 0 disables
+ *              the caches.
+ */
+void mem_set_thread_cache(size_t depth);
+
+/**
+ * @brief Returns the per-thread cache depth set with `mem_set_thread_cache()`.
+ *
+ * @return size_t Blocks per class, or 0 when the caches are disabled.
+ */
+size_t mem_thread_cache(void);
+
+/**
+ * @brief Returns every block in the calling thread's cache to the heap.
+ *
+ * Also folds the cache counters and the pending changes to the bytes in use
+ * into the allocator statistics. Threads call it before they stop using a
+ * shared heap.
+ */
+void mem_cache_flush(void);
+
+/**
+ * @brief Returns the counters of the calling thread's cache.
+ *
+ * @return MemCacheStats Copy of the counters.
+ */
+MemCacheStats mem_cache_stats(void);
 
 #endif /* MEMORY_OPS_H */
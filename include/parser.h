@@ -12,6 +12,9 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include <stddef.h>
+#include <stdio.h>
+
 /**
  * @brief Ejecuta un archivo de comandos de memoria.
  *
@@ -30,4 +33,17 @@
  */
 int parser_execute_file(const char *path);
 
+/**
+ * @brief Ejecuta los comandos de un flujo ya abierto.
+ *
+ * Igual que `parser_execute_file()`, pero lee de `f` (que no se cierra) e
+ * informa cuántos comandos ejecutó, sin contar comentarios ni líneas
+ * vacías. Con el modo silencioso de `log.h` no repite las líneas.
+ *
+ * @param f        Flujo de entrada.
+ * @param commands Recibe la cantidad de comandos ejecutados (puede ser NULL).
+ * @return 0 si el flujo se leyó completo, -1 si hubo un error de lectura.
+ */
+int parser_execute_stream(FILE *f, size_t *commands);
+
 #endif /* PARSER_H */
@@ -29,4 +29,15 @@
  */
 void mem_print(void);
 
+/**
+ * @brief Imprime las estadísticas de latencia del algoritmo activo.
+ *
+ * Muestra la cantidad de reservas, liberaciones y fallos, junto con los
+ * percentiles 50 y 99 (cota superior de su cubeta del histograma) y la
+ * peor latencia de reserva observada. Incluye las estadísticas propias del
+ * motor activo y, con la capa slab activa, la utilización de ranuras por
+ * clase.
+ */
+void mem_print_stats(void);
+
 #endif /* PRINT_H */
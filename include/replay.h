@@ -0,0 +1,66 @@
+/**
+ * @file replay.h
+ * @brief Reproducción concurrente de archivos de comandos sobre un heap
+ *        compartido.
+ *
+ * Varios hilos ejecutan cada uno sus propios archivos de comandos contra la
+ * misma arena. Cada hilo opera en un contexto compartido
+ * (`sim_context_create_shared()`) con su propia tabla de variables y su
+ * propia caché de bloques; el heap (lista de bloques, índices, motor y
+ * slabs) se protege con un único cerrojo. Al terminar se informa el
+ * rendimiento en comandos por segundo y cuánto se disputó el cerrojo.
+ *
+ * Los archivos se leen completos antes de arrancar los hilos, así que el
+ * tiempo medido no incluye la lectura del disco, y los hilos no repiten las
+ * líneas ni muestran mensajes informativos (los errores sí).
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sim_context.h"
+#include "memory_ops.h"
+
+/**
+ * @struct ReplayReport
+ * @brief Resultado de una reproducción concurrente.
+ */
+typedef struct {
+    size_t threads;         /**< Hilos que reprodujeron comandos. */
+    size_t commands;        /**< Comandos ejecutados entre todos los hilos. */
+    uint64_t elapsed_ns;    /**< Tiempo desde el arranque hasta el fin del último hilo. */
+    SimLockStats lock;      /**< Uso del cerrojo del heap. */
+    MemCacheStats cache;    /**< Suma de las cachés de los hilos. */
+    size_t leaked;          /**< Variables que quedaron vivas al terminar cada hilo. */
+} ReplayReport;
+
+/**
+ * @brief Reproduce archivos de comandos en varios hilos sobre el heap del
+ *        contexto actual.
+ *
+ * Se reparten `max(threads, count)` trabajos en orden circular: el trabajo
+ * `j` ejecuta `paths[j % count]` y lo hace el hilo `j % threads`. Así, con
+ * un solo archivo todos los hilos reproducen la misma traza, cada uno con
+ * sus variables. El heap debe estar inicializado y el contexto actual no
+ * debe ser compartido. Las variables que un hilo deja vivas se cuentan en
+ * el reporte y sus bloques siguen reservados.
+ *
+ * @param paths   Archivos de comandos.
+ * @param count   Cantidad de archivos (al menos uno).
+ * @param threads Cantidad de hilos (al menos uno).
+ * @param report  Recibe el resultado.
+ * @return true si todos los archivos se leyeron y todos los hilos corrieron.
+ */
+bool replay_run(const char *const *paths, size_t count, size_t threads, ReplayReport *report);
+
+/**
+ * @brief Imprime el resultado de una reproducción concurrente.
+ *
+ * @param report Resultado de `replay_run()`.
+ */
+void replay_print_report(const ReplayReport *report);
+
+#endif /* REPLAY_H */
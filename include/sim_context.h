@@ -0,0 +1,159 @@
+/**
+ * @file sim_context.h
+ * @brief Contexto de simulación: el estado completo de una simulación.
+ *
+ * Cada módulo del simulador (arena, lista de bloques, índices, motores,
+ * slabs, variables) guarda su estado en el contexto al que está enlazado el
+ * hilo que lo llama, en lugar de variables globales del proceso. Así pueden
+ * existir varias simulaciones independientes en un mismo proceso, cada una
+ * avanzando en su propio hilo.
+ *
+ * Las funciones de `memory_ops.h`, `allocator.h`, `blocks.h`, `variables.h`
+ * y demás operan sobre el contexto enlazado con `sim_context_bind()`. Un
+ * hilo sin contexto enlazado usa el contexto por defecto del proceso, que
+ * es el que usa `main.c`.
+ *
+ * Un contexto compartido (`sim_context_create_shared()`) usa el heap de
+ * otro contexto (arena, bloques, índices, motores, slabs y políticas) y
+ * tiene solo sus variables y su caché de bloques. Varios hilos enlazados a
+ * contextos compartidos del mismo heap lo usan a la vez: las operaciones
+ * sobre el heap se serializan con un único cerrojo (`sim_context_lock()`).
+ */
+
+#ifndef SIM_CONTEXT_H
+#define SIM_CONTEXT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Estado completo de una simulación (opaco).
+ */
+typedef struct SimContext SimContext;
+
+/**
+ * @enum SimStateSlot
+ * @brief Ranura del contexto que guarda el estado de cada módulo.
+ */
+typedef enum {
+    SIM_STATE_MEMORY,       /**< Arena (`memory.c`). */
+    SIM_STATE_BLOCKS,       /**< Lista de bloques y pool de nodos (`blocks.c`). */
+    SIM_STATE_FREE_INDEX,   /**< Árboles de libres (`free_index.c`). */
+    SIM_STATE_BLOCK_TABLE,  /**< Tabla de bloques (`block_table.c`). */
+    SIM_STATE_ALLOCATOR,    /**< Motor activo y estadísticas (`allocator.c`). */
+    SIM_STATE_BUDDY,        /**< Motor buddy (`buddy.c`). */
+    SIM_STATE_TLSF,         /**< Motor TLSF (`tlsf.c`). */
+    SIM_STATE_BITMAP,       /**< Motor bitmap (`bitmap.c`). */
+    SIM_STATE_TAGS,         /**< Motor tags (`tags.c`). */
+    SIM_STATE_SLAB,         /**< Capa slab (`slab.c`). */
+    SIM_STATE_VARIABLES,    /**< Tabla de variables (`variables.c`). */
+    SIM_STATE_MEMORY_OPS,   /**< Políticas de `memory_ops.c`. */
+    SIM_STATE_CACHE,        /**< Caché de bloques del hilo (`memory_ops.c`). */
+    SIM_STATE_COUNT
+} SimStateSlot;
+
+/**
+ * @struct SimLockStats
+ * @brief Uso del cerrojo de un heap compartido.
+ */
+typedef struct {
+    size_t acquisitions;    /**< Veces que un hilo tomó el cerrojo. */
+    size_t contended;       /**< Tomas en las que otro hilo lo tenía. */
+    uint64_t wait_ns;       /**< Tiempo total esperando el cerrojo. */
+} SimLockStats;
+
+/**
+ * @brief Crea un contexto vacío.
+ *
+ * Para usarlo, un hilo debe enlazarlo con `sim_context_bind()` y luego
+ * inicializar la arena y las variables como lo hace `main.c`.
+ *
+ * @return Contexto nuevo, o NULL si no hay memoria.
+ */
+SimContext *sim_context_create(void);
+
+/**
+ * @brief Crea un contexto que opera sobre el heap de otro.
+ *
+ * El contexto nuevo tiene su propia tabla de variables y su propia caché de
+ * bloques; todo lo demás es el estado de `heap`, que debe tener la arena
+ * inicializada y no operar por su cuenta mientras existan contextos que lo
+ * comparten. Los contextos compartidos se crean y se destruyen desde un
+ * mismo hilo (el dueño de `heap`), antes y después de usarlos.
+ *
+ * @param heap Contexto dueño del heap (no compartido).
+ * @return Contexto nuevo, o NULL si no hay memoria o `heap` es compartido.
+ */
+SimContext *sim_context_create_shared(SimContext *heap);
+
+/**
+ * @brief Destruye un contexto creado con `sim_context_create()` o
+ *        `sim_context_create_shared()`.
+ *
+ * Libera su arena, bloques, motores y variables (como `memory_destroy()` y
+ * `vars_destroy()`) y el estado de cada módulo. De un contexto compartido
+ * solo se liberan sus variables y su caché; los bloques de las variables que
+ * queden siguen reservados en el heap. No debe estar en uso por ningún otro
+ * hilo. El contexto por defecto no se destruye.
+ *
+ * @param ctx Contexto a destruir.
+ */
+void sim_context_destroy(SimContext *ctx);
+
+/**
+ * @brief Enlaza el hilo actual a un contexto.
+ *
+ * @param ctx Contexto a usar desde ahora en este hilo, o NULL para volver
+ *            al contexto por defecto.
+ * @return Contexto enlazado anteriormente (NULL si era el por defecto).
+ */
+SimContext *sim_context_bind(SimContext *ctx);
+
+/**
+ * @brief Contexto con el que opera el hilo actual.
+ *
+ * @return El contexto enlazado, o el contexto por defecto.
+ */
+SimContext *sim_context_current(void);
+
+/**
+ * @brief Estado de un módulo en el contexto del hilo actual.
+ *
+ * La primera vez que un módulo lo pide en un contexto, se crea como copia
+ * de `initial`. Uso interno de cada módulo.
+ *
+ * @param slot    Ranura del módulo.
+ * @param initial Valor inicial del estado.
+ * @param size    Tamaño del estado en bytes.
+ * @return Estado del módulo (nunca NULL).
+ */
+void *sim_context_state(SimStateSlot slot, const void *initial, size_t size);
+
+/**
+ * @brief Indica si el contexto del hilo actual comparte el heap de otro.
+ */
+bool sim_context_shared(void);
+
+/**
+ * @brief Toma el cerrojo del heap del contexto actual.
+ *
+ * No hace nada si el contexto no es compartido. Se puede anidar: solo la
+ * toma más externa adquiere el cerrojo y se cuenta en las estadísticas.
+ */
+void sim_context_lock(void);
+
+/**
+ * @brief Suelta el cerrojo tomado con `sim_context_lock()`.
+ */
+void sim_context_unlock(void);
+
+/**
+ * @brief Uso del cerrojo de un heap desde que empezó a compartirse.
+ *
+ * @param heap Contexto dueño del heap, o NULL para el contexto por defecto.
+ * @return Copia de los contadores.
+ */
+SimLockStats sim_context_lock_stats(SimContext *heap);
+
+#endif /* SIM_CONTEXT_H */
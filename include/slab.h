@@ -0,0 +1,131 @@
+/**
+ * @file slab.h
+ * @brief Capa slab para reservas pequeñas de tamaño fijo.
+ *
+ * Las solicitudes que caben en alguna clase de tamaño se atienden desde
+ * "slabs": bloques de la arena reservados al algoritmo activo y divididos en
+ * ranuras (slots) del mismo tamaño. Cada slab lleva un mapa de bits de
+ * ranuras libres, por lo que reservar y liberar una ranura no divide ni
+ * fusiona bloques de la lista general.
+ *
+ * Cada ranura se representa con un `Block` propio del slab (campo `slab`
+ * distinto de NULL) que no pertenece a la lista general de bloques. Las
+ * solicitudes más grandes que la mayor clase pasan al asignador general.
+ */
+
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "blocks.h"
+
+/** @brief Cantidad máxima de clases de tamaño. */
+#define SLAB_MAX_CLASSES 8
+
+/** @brief Bytes máximos de la arena que ocupa un slab. */
+#define SLAB_CHUNK_SIZE 256
+
+/** @brief Ranuras máximas por slab (un bit por ranura en un entero de 64 bits). */
+#define SLAB_MAX_SLOTS 64
+
+/**
+ * @struct SlabClassStats
+ * @brief Ocupación de una clase de tamaño.
+ */
+typedef struct {
+    size_t slot_size;   /**< Tamaño de cada ranura en bytes. */
+    size_t slot_count;  /**< Ranuras por slab. */
+    size_t slabs;       /**< Slabs reservados actualmente. */
+    size_t slots_used;  /**< Ranuras ocupadas actualmente. */
+    size_t allocs;      /**< Reservas atendidas por la clase. */
+} SlabClassStats;
+
+/**
+ * @brief Activa la capa slab con las clases de tamaño indicadas.
+ *
+ * Con `classes == NULL` se usan las clases por defecto (16, 32, 64 y 128
+ * bytes). Solo puede reconfigurarse mientras no haya slabs reservados.
+ *
+ * @param classes Tamaños de ranura en orden estrictamente creciente.
+ * @param count   Cantidad de clases (1..SLAB_MAX_CLASSES).
+ * @return true si la capa quedó activa, false si la configuración es inválida.
+ */
+bool slab_enable(const size_t *classes, size_t count);
+
+/**
+ * @brief Indica si la capa slab está activa.
+ */
+bool slab_enabled(void);
+
+/**
+ * @brief Libera los descriptores de todos los slabs y desactiva la capa.
+ *
+ * No devuelve los bloques de la arena; se invoca al destruir la arena.
+ */
+void slab_destroy(void);
+
+/**
+ * @brief Devuelve a la arena los slabs vacíos que se conservaban en caché.
+ *
+ * Se invoca cuando el asignador general se queda sin espacio.
+ *
+ * @return Cantidad de slabs devueltos.
+ */
+size_t slab_reclaim(void);
+
+/**
+ * @brief Reserva una ranura de la menor clase que contiene `size` bytes.
+ *
+ * @param size Tamaño solicitado en bytes.
+ * @return Ranura ocupada, o NULL si la capa está inactiva, ninguna clase
+ *         sirve o no hay espacio para un slab nuevo.
+ */
+Block *slab_alloc(size_t size);
+
+/**
+ * @brief Libera una ranura; un slab vacío se devuelve a la arena si su
+ *        clase tiene otro slab con ranuras libres.
+ *
+ * @param slot Ranura ocupada (con `slot->slab != NULL`).
+ */
+void slab_free(Block *slot);
+
+/**
+ * @brief Cambia el tamaño solicitado de una ranura sin moverla.
+ *
+ * @param slot     Ranura ocupada.
+ * @param new_size Nuevo tamaño solicitado.
+ * @return true si `new_size` cabe en la ranura.
+ */
+bool slab_resize(Block *slot, size_t new_size);
+
+/**
+ * @brief Actualiza los offsets de las ranuras tras mover el bloque de un
+ *        slab (por ejemplo, al compactar la arena).
+ *
+ * @param chunk Bloque que respalda el slab (`chunk->slab != NULL`), ya con
+ *              su offset nuevo.
+ */
+void slab_moved(Block *chunk);
+
+/**
+ * @brief Cantidad de clases configuradas.
+ */
+size_t slab_class_count(void);
+
+/**
+ * @brief Ocupación de la clase `idx`.
+ *
+ * @param idx Índice de la clase (0..slab_class_count()-1).
+ * @return Puntero de solo lectura, o NULL si el índice no existe.
+ */
+const SlabClassStats *slab_class_stats(size_t idx);
+
+/**
+ * @brief Reservas pequeñas que no pudieron atenderse con un slab y
+ *        reservas mayores a la mayor clase.
+ */
+size_t slab_fallthrough(void);
+
+#endif /* SLAB_H */
@@ -0,0 +1,45 @@
+/**
+ * @file snapshot.h
+ * @brief Instantáneas del heap simulado en un archivo.
+ *
+ * Una instantánea guarda en un solo archivo los bytes de la arena, la lista
+ * de bloques y la tabla de variables, para poder "calentar" un heap una vez
+ * (comando SNAPSHOT o `--snapshot`) y luego retomar desde ese punto tantos
+ * experimentos como se quiera (comando RESTORE o `--restore`).
+ *
+ * El archivo se restaura con `mmap`: la lista de bloques se arma de una sola
+ * vez desde arreglos paralelos del archivo, sin volver a interpretar
+ * comandos, y las páginas de la arena se mapean en forma privada, así que
+ * se leen recién cuando se tocan y el archivo no cambia.
+ *
+ * Solo se admiten los motores que guardan todo su estado en la lista de
+ * bloques (first-fit, best-fit, worst-fit y next-fit), con la capa slab
+ * inactiva y sin hilos compartiendo el heap.
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdbool.h>
+
+/**
+ * @brief Guarda el heap actual en un archivo.
+ *
+ * @param path Ruta del archivo; se reemplaza si existe.
+ * @return true si la instantánea quedó escrita.
+ */
+bool snapshot_save(const char *path);
+
+/**
+ * @brief Reemplaza el heap actual por el de una instantánea.
+ *
+ * Restaura la arena, los bloques, las variables y el motor de asignación.
+ * Las estadísticas se reinician y la capa slab queda inactiva. Si el archivo
+ * no es válido, el heap actual no cambia.
+ *
+ * @param path Ruta del archivo.
+ * @return true si el heap quedó restaurado.
+ */
+bool snapshot_load(const char *path);
+
+#endif /* SNAPSHOT_H */
@@ -11,6 +11,8 @@
 #ifndef STRING_UTILS_H
 #define STRING_UTILS_H
 
+#include <stddef.h>
+
 /**
  * @brief Elimina espacios en blanco al inicio y al final de una cadena.
  *
@@ -35,4 +37,18 @@ char *str_trim(char *s);
  */
 int str_starts_with(const char *s, const char *prefix);
 
+/**
+ * @brief Interpreta un tamaño en bytes con sufijo binario opcional.
+ *
+ * Acepta un entero decimal seguido opcionalmente de `K`, `M`, `G` o `T`
+ * (potencias de 1024, sin distinguir mayúsculas), por ejemplo `2000`,
+ * `64K` o `16G`.
+ *
+ * @param s   Cadena a interpretar.
+ * @param out Tamaño resultante en bytes.
+ * @return int Retorna 1 si la cadena es válida y no desborda `size_t`, 0 en
+ *         caso contrario.
+ */
+int str_parse_size(const char *s, size_t *out);
+
 #endif /* STRING_UTILS_H */
@@ -0,0 +1,120 @@
+/**
+ * @file tags.h
+ * @brief Motor de asignación con etiquetas de frontera (boundary tags)
+ *        dentro de la arena.
+ *
+ * Cada bloque guarda su metadato en los propios bytes de `memory_arena()`:
+ * una cabecera y un pie de TAGS_WORD bytes con el tamaño del bloque y un bit
+ * de ocupado. Los bloques libres guardan además, en su carga útil, los
+ * offsets del siguiente y el anterior en la lista de libres.
+ *
+ * Los vecinos físicos se encuentran solo con aritmética sobre las etiquetas:
+ * la cabecera del siguiente está en `offset + size` y el pie del anterior en
+ * `offset - TAGS_WORD`. La lista general de bloques no se usa mientras el
+ * motor está activo; cada reserva viva tiene un `Block` manejador (del pool
+ * de `blocks.c`) cuyo offset y tamaño describen solo la carga útil.
+ *
+ * Así el simulador cobra el costo real de cabeceras, pies y tamaño mínimo
+ * de bloque, que se informa en el comando STATS.
+ *
+ * La lista de libres va ordenada por dirección y la búsqueda sigue la
+ * política del motor: `tags` (First-Fit), `tags-best`, `tags-worst` o
+ * `tags-next`. Todos comparten las funciones salvo la de activación.
+ */
+
+#ifndef TAGS_H
+#define TAGS_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "blocks.h"
+#include "allocator.h"
+
+/** @brief Bytes de la cabecera y del pie; también la alineación de los bloques. */
+#define TAGS_WORD 8
+
+/** @brief Bloque mínimo: cabecera, pie y los dos enlaces de la lista de libres. */
+#define TAGS_MIN_BLOCK (4 * TAGS_WORD)
+
+/**
+ * @brief Escribe un único bloque libre que cubre la arena y busca con
+ *        First-Fit.
+ *
+ * @param arena_size Tamaño total de la arena.
+ * @return true si el motor quedó listo (arena vacía y de al menos
+ *         TAGS_MIN_BLOCK bytes).
+ */
+bool tags_init(size_t arena_size);
+
+/** @brief Como tags_init(), con Best-Fit. */
+bool tags_best_init(size_t arena_size);
+
+/** @brief Como tags_init(), con Worst-Fit. */
+bool tags_worst_init(size_t arena_size);
+
+/** @brief Como tags_init(), con Next-Fit. */
+bool tags_next_init(size_t arena_size);
+
+/**
+ * @brief Libera el mapa de manejadores y reactiva el índice general.
+ */
+void tags_destroy(void);
+
+/**
+ * @brief Carga útil del bloque libre que elegiría la política del motor.
+ *
+ * @param size  Tamaño solicitado en bytes.
+ * @param align Alineación de la carga útil (potencia de dos).
+ * @return Descriptor temporal de la carga útil disponible, o NULL.
+ */
+Block *tags_find_block(size_t size, size_t align);
+
+/**
+ * @brief Reserva un bloque con la política del motor sobre la lista de libres.
+ *
+ * @param size  Tamaño solicitado en bytes.
+ * @param align Alineación de la carga útil (potencia de dos).
+ * @return Manejador de la carga útil, o NULL si no hay espacio.
+ */
+Block *tags_alloc(size_t size, size_t align);
+
+/**
+ * @brief Libera un bloque y lo fusiona con los vecinos libres que indican
+ *        sus etiquetas.
+ *
+ * @param block Manejador ocupado.
+ */
+void tags_free(Block *block);
+
+/**
+ * @brief Redimensiona en su lugar usando el bloque libre siguiente.
+ *
+ * @param block    Manejador ocupado.
+ * @param new_size Nuevo tamaño solicitado.
+ * @return true si no necesita moverse.
+ */
+bool tags_resize(Block *block, size_t new_size);
+
+/**
+ * @brief Recorre la arena de cabecera en cabecera.
+ *
+ * Los segmentos informados incluyen cabecera y pie.
+ *
+ * @param visit Función invocada por cada bloque.
+ * @param ctx   Contexto para `visit`.
+ */
+void tags_walk(BlockVisitor visit, void *ctx);
+
+/**
+ * @brief Metadatos en la arena (etiquetas) y fuera de ella (manejadores).
+ *
+ * @param out Resultado.
+ */
+void tags_overhead(AllocOverhead *out);
+
+/**
+ * @brief Imprime bloques, lista de libres y bytes de etiquetas.
+ */
+void tags_print_stats(void);
+
+#endif /* TAGS_H */
@@ -0,0 +1,116 @@
+/**
+ * @file tlsf.h
+ * @brief Motor de asignación TLSF (Two-Level Segregated Fit).
+ *
+ * Los bloques libres se clasifican en dos niveles: el primer nivel es la
+ * potencia de dos del tamaño y el segundo subdivide cada potencia en
+ * TLSF_SL_COUNT rangos lineales. Dos mapas de bits indican qué listas tienen
+ * bloques, de modo que encontrar un bloque adecuado cuesta un par de
+ * instrucciones `ctz`/`clz` y nunca depende de la cantidad de bloques.
+ *
+ * La fusión al liberar usa los vecinos físicos del bloque, por lo que
+ * reservar, liberar y redimensionar en su lugar son O(1).
+ */
+
+#ifndef TLSF_H
+#define TLSF_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "blocks.h"
+#include "allocator.h"
+
+/** @brief log2 de la cantidad de subdivisiones del segundo nivel. */
+#define TLSF_SL_LOG2 4
+
+/** @brief Cantidad de listas por cada clase de primer nivel. */
+#define TLSF_SL_COUNT (1u << TLSF_SL_LOG2)
+
+/** @brief Sobrante mínimo para que una división genere un bloque libre. */
+#define TLSF_MIN_BLOCK 16
+
+/**
+ * @brief Prepara el motor TLSF sobre la arena.
+ *
+ * @param arena_size Tamaño total de la arena.
+ * @return true si se inicializó, false si hay bloques ocupados.
+ */
+bool tlsf_init(size_t arena_size);
+
+/**
+ * @brief Vacía las estructuras internas del motor.
+ *
+ * Los bloques de la lista se conservan tal como están.
+ */
+void tlsf_destroy(void);
+
+/**
+ * @brief Bloque libre que `tlsf_alloc()` usaría para `size` bytes.
+ *
+ * @param size  Tamaño solicitado en bytes.
+ * @param align Alineación en bytes (potencia de dos).
+ * @return Bloque libre que aloja la solicitud alineada, o NULL.
+ */
+Block *tlsf_find_block(size_t size, size_t align);
+
+/**
+ * @brief Reserva un bloque en tiempo constante.
+ *
+ * Con alineación, el relleno inicial (0 o al menos TLSF_MIN_BLOCK bytes)
+ * queda en las listas como bloque libre.
+ *
+ * @param size  Tamaño solicitado en bytes.
+ * @param align Alineación en bytes (potencia de dos).
+ * @return Bloque ocupado, o NULL si no hay uno suficiente.
+ */
+Block *tlsf_alloc(size_t size, size_t align);
+
+/**
+ * @brief Libera un bloque y lo fusiona con sus vecinos físicos libres.
+ *
+ * @param block Bloque ocupado reservado por el motor.
+ */
+void tlsf_free(Block *block);
+
+/**
+ * @brief Cambia el tamaño de un bloque ocupado sin moverlo.
+ *
+ * @param block    Bloque ocupado.
+ * @param new_size Nuevo tamaño solicitado.
+ * @return true si el bloque cubre `new_size` sin moverse.
+ */
+bool tlsf_resize(Block *block, size_t new_size);
+
+/**
+ * @brief Imprime las listas no vacías y los bloques libres de cada una.
+ */
+void tlsf_print_stats(void);
+
+/**
+ * @brief Metadatos: nodos de la lista, cabezas de listas y mapas de bits.
+ *
+ * @param out Resultado.
+ */
+void tlsf_overhead(AllocOverhead *out);
+
+/**
+ * @brief Extiende (o crea) el bloque libre final tras crecer la arena y lo
+ *        reclasifica.
+ *
+ * @param old_size Tamaño anterior de la arena.
+ * @param new_size Tamaño nuevo.
+ * @return true si el espacio nuevo quedó disponible.
+ */
+bool tlsf_grow(size_t old_size, size_t new_size);
+
+/**
+ * @brief Desliza los bloques ocupados al inicio de la arena y reconstruye
+ *        las listas con el espacio libre resultante.
+ *
+ * @param move Función que mueve los datos de cada bloque desplazado.
+ * @param ctx  Contexto para `move`.
+ * @return Bytes movidos.
+ */
+size_t tlsf_compact(BlockMover move, void *ctx);
+
+#endif /* TLSF_H */
@@ -2,9 +2,9 @@
  * @file variables.h
  * @brief Gestión de la tabla de variables usadas en la simulación de memoria.
  *
- * Este módulo implementa una tabla de símbolos simple (name → Block*), utilizada
- * para mapear nombres de variables definidos en el archivo de entrada a los
- * bloques de memoria asignados dentro del simulador.  
+ * Este módulo implementa una tabla de símbolos (name → Block*) con una tabla
+ * hash, utilizada para mapear nombres de variables definidos en el archivo de
+ * entrada a los bloques de memoria asignados dentro del simulador.  
  * 
  * La tabla permite registrar, recuperar, actualizar y eliminar variables, así como
  * detectar fugas de memoria al finalizar la ejecución.
@@ -17,18 +17,23 @@
 
 /**
  * @struct VarEntry
- * @brief Nodo de una lista enlazada que representa una variable del programa.
+ * @brief Entrada que representa una variable del programa.
  *
  * Cada entrada asocia:
- * - un nombre de variable (`name`)
+ * - un nombre de variable (`name`), guardado al final de la misma reserva
  * - un puntero a un bloque de memoria asignado (`block`)
  *
- * La tabla completa se implementa como una lista enlazada simple.
+ * La tabla hash guarda punteros a las entradas; además, las entradas forman
+ * una lista doble en orden de registro y un árbol ordenado por nombre.
  */
 typedef struct VarEntry {
-    char            *name;   /**< Nombre simbólico de la variable (ALOC, REALLOC). */
-    Block           *block;  /**< Puntero al bloque de memoria asociado. */
-    struct VarEntry *next;   /**< Siguiente nodo en la lista. */
+    Block           *block;     /**< Puntero al bloque de memoria asociado. */
+    struct VarEntry *newer;     /**< Variable registrada después, o NULL. */
+    struct VarEntry *older;     /**< Variable registrada antes, o NULL. */
+    AvlNode          name_node; /**< Nodo en el árbol ordenado por nombre, si está armado. */
+    size_t           seq;       /**< Número de registro (crece con cada variable). */
+    size_t           hash;      /**< Hash de `name`. */
+    char             name[];    /**< Nombre simbólico de la variable (ALOC, REALLOC). */
 } VarEntry;
 
 /**
@@ -57,6 +62,18 @@ void vars_destroy(void);
  */
 void var_set(const char *name, Block *block);
 
+/**
+ * @brief Registra una variable que se sabe nueva.
+ *
+ * Como `var_set()`, pero sin buscar el nombre en la tabla; lo usan las
+ * reservas en lote, que ya validaron sus nombres con `var_get()`, y la
+ * restauración de instantáneas, que comprueba que no se repitan.
+ *
+ * @param name Nombre de una variable que aún no existe.
+ * @param block Puntero al bloque asignado.
+ */
+void var_add(const char *name, Block *block);
+
 /**
  * @brief Obtiene el bloque asociado a una variable.
  *
@@ -74,6 +91,41 @@ Block *var_get(const char *name);
  */
 void var_remove(const char *name);
 
+/**
+ * @brief Función que recibe cada variable en `vars_visit()`.
+ *
+ * @param name  Nombre de la variable.
+ * @param block Bloque asociado.
+ * @param ctx   Contexto del llamador.
+ */
+typedef void (*VarVisitor)(const char *name, Block *block, void *ctx);
+
+/**
+ * @brief Elimina todas las variables cuyo nombre empieza con `prefix`.
+ *
+ * Cuesta O(log n + k) para k variables del prefijo (la primera llamada
+ * arma además un índice por nombre en O(n log n)); se quitan de la más
+ * reciente a la más antigua. Como `var_remove()`, no libera los bloques;
+ * `visit` recibe cada variable justo antes de quitarla, para que el llamador
+ * pueda reunir sus bloques.
+ *
+ * @param prefix Prefijo de los nombres ("" elimina todas).
+ * @param visit  Función llamada por cada variable eliminada, o NULL.
+ * @param ctx    Contexto pasado a `visit`.
+ * @return Cantidad de variables eliminadas.
+ */
+size_t vars_remove_prefix(const char *prefix, VarVisitor visit, void *ctx);
+
+/**
+ * @brief Recorre las variables registradas, de la más reciente a la más antigua.
+ *
+ * El visitante no debe agregar ni quitar variables.
+ *
+ * @param visit Función llamada por cada variable.
+ * @param ctx   Contexto pasado a `visit`.
+ */
+void vars_visit(VarVisitor visit, void *ctx);
+
 /**
  * @brief Imprime variables que aún tienen bloques asignados.
  *
@@ -1,29 +1,114 @@
 /**
  * @file allocator.c
  * @brief Implementación de los algoritmos de asignación dinámica de memoria
- *        (First-Fit, Best-Fit y Worst-Fit) para el simulador.
+ *        (First-Fit, Next-Fit, Best-Fit, Worst-Fit, buddy y TLSF) para el
+ *        simulador.
  *
  * Este módulo se encarga de seleccionar bloques libres dentro de la memoria
  * simulada usando diferentes estrategias de búsqueda. Los algoritmos operan
- * sobre la lista enlazada de bloques administrativos definida en `blocks.c`.
+ * sobre el índice de bloques libres (`free_index.c`), que `blocks.c`
+ * mantiene sincronizado con la lista enlazada de bloques administrativos.
+ *
+ * Con el comando STORE las políticas de lista pueden buscar, en su lugar,
+ * sobre la tabla de bloques en arreglos paralelos (`block_table.c`), con
+ * pasadas lineales en vez de descensos por árbol.
+ *
+ * Cada algoritmo se expone como un motor (`AllocEngine`): una tabla de
+ * ganchos find/alloc/free/resize/stats registrada por nombre. Los motores
+ * buddy (`buddy.c`) y TLSF (`tlsf.c`) administran sus propias listas de
+ * libres, el motor bitmap (`bitmap.c`) reemplaza la lista general por un
+ * mapa de bits y el motor tags (`tags.c`) por etiquetas de frontera escritas
+ * en la arena; las políticas de lista comparten las operaciones de este
+ * módulo.
+ *
+ * Cada reserva se cronometra para poder comparar la latencia de cola de los
+ * algoritmos (ver `allocator_stats()`).
+ *
+ * Con el comando COALESCE las políticas de lista pueden diferir la fusión de
+ * los bloques liberados y hacerla en barridos, para no fusionar y volver a
+ * dividir la misma región cuando se libera y se reserva el mismo tamaño.
  */
 
 #include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
 #include "allocator.h"
 #include "blocks.h"
+#include "free_index.h"
+#include "block_table.h"
+#include "buddy.h"
+#include "tlsf.h"
+#include "bitmap.h"
+#include "tags.h"
+#include "slab.h"
+#include "memory.h"
+#include "sim_context.h"
 #include "log.h"
 
 /* ------------------------------------------------------------------------- */
-/*                        VARIABLES ESTÁTICAS INTERNAS                       */
+/*                             ESTADO POR CONTEXTO                           */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Estado del asignador en un contexto de simulación.
+ */
+typedef struct {
+    /**
+     * @brief Motor de asignación activo.
+     *
+     * Por defecto es First-Fit (ver `initial`, junto a la tabla de motores).
+     * Se enlaza una vez con `allocator_select()` y cada operación llama
+     * directamente a sus ganchos, sin despachar por caso.
+     */
+    const AllocEngine *active;
+
+    /**
+     * @brief Estadísticas del algoritmo activo.
+     */
+    AllocStats stats;
+
+    /**
+     * @brief Liberaciones por barrido de fusión diferida (0 = fusión inmediata).
+     */
+    size_t coalesce_threshold;
+
+    /**
+     * @brief Bloques liberados por las políticas de lista aún sin fusionar.
+     */
+    size_t pending_frees;
+} AllocState;
+
+/** @brief Estado del contexto actual (definido tras la tabla de motores). */
+static AllocState *state(void);
+
+/* ------------------------------------------------------------------------- */
+/*                         MEDICIÓN DE LATENCIAS                             */
 /* ------------------------------------------------------------------------- */
 
 /**
- * @brief Algoritmo de asignación actualmente activo.
+ * @brief Marca de tiempo actual en nanosegundos.
+ */
+static unsigned long long now_ns(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+/**
+ * @brief Registra la latencia de una reserva en el histograma.
  *
- * El valor por defecto es `ALLOC_FIRST_FIT`. Puede modificarse en tiempo
- * de ejecución mediante `allocator_set_algorithm()`.
+ * @param ns Duración de la reserva en nanosegundos.
  */
-static AllocAlgorithm current_algo = ALLOC_FIRST_FIT;
+static void record_latency(unsigned long long ns) {
+    AllocState *st = state();
+    unsigned k = ns ? (unsigned)(63 - __builtin_clzll(ns)) : 0;
+
+    st->stats.lat_hist[k]++;
+    if (ns > st->stats.lat_max_ns) {
+        st->stats.lat_max_ns = ns;
+    }
+}
 
 /* ------------------------------------------------------------------------- */
 /*                      IMPLEMENTACIÓN DE FIRST-FIT                          */
@@ -32,22 +117,59 @@ static AllocAlgorithm current_algo = ALLOC_FIRST_FIT;
 /**
  * @brief Busca el primer bloque libre lo suficientemente grande (First-Fit).
  *
- * Recorre la lista de bloques desde el inicio y retorna el primer bloque
- * libre cuyo tamaño sea mayor o igual al solicitado.
+ * Retorna el bloque libre de menor offset cuyo tamaño sea mayor o igual al
+ * solicitado, descendiendo por el árbol de libres ordenado por dirección
+ * (o con una pasada sobre la tabla de bloques, si está activa). Con
+ * alineación, el bloque debe cubrir además su relleno inicial.
  *
- * @param size Tamaño solicitado en bytes.
+ * @param size  Tamaño solicitado en bytes.
+ * @param align Alineación en bytes.
  * @return Puntero al bloque adecuado, o `NULL` si no se encontró ninguno.
  */
-static Block *find_first_fit(size_t size) {
-    Block *curr = blocks_first();
+static Block *find_first_fit(size_t size, size_t align) {
+    if (blocks_table_active()) return block_table_first_fit(0, size, align);
 
-    while (curr) {
-        if (curr->is_free && curr->size >= size) {
-            return curr;
-        }
-        curr = curr->next;
+    return align > 1 ? free_index_first_fit_aligned(0, size, align)
+                     : free_index_first_fit(size);
+}
+
+/* ------------------------------------------------------------------------- */
+/*                      IMPLEMENTACIÓN DE NEXT-FIT                           */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Busca el primer bloque libre suficiente a partir del puntero móvil
+ *        (Next-Fit).
+ *
+ * La búsqueda inicia en el offset del bloque donde terminó la última
+ * asignación exitosa; si no hay un bloque adecuado desde ahí hasta el final
+ * de la arena, se da la vuelta y se busca desde el inicio. El bloque elegido
+ * pasa a ser el nuevo puntero móvil.
+ *
+ * El puntero móvil vive en `blocks.c`, que lo traslada al bloque
+ * sobreviviente cuando una fusión libera el nodo al que apuntaba.
+ *
+ * @param size  Tamaño solicitado en bytes.
+ * @param align Alineación en bytes.
+ * @return Puntero al bloque adecuado, o `NULL` si no se encontró ninguno.
+ */
+static Block *find_next_fit(size_t size, size_t align) {
+    Block *rover = blocks_rover();
+    Block *found = NULL;
+
+    if (rover) {
+        found = blocks_table_active()
+              ? block_table_first_fit(rover->offset, size, align)
+              : free_index_first_fit_aligned(rover->offset, size, align);
     }
-    return NULL;
+    if (!found) {
+        found = find_first_fit(size, align);
+    }
+
+    if (found) {
+        blocks_set_rover(found);
+    }
+    return found;
 }
 
 /* ------------------------------------------------------------------------- */
@@ -58,26 +180,20 @@ static Block *find_first_fit(size_t size) {
  * @brief Busca el bloque libre más pequeño que sea suficientemente grande
  *        (Best-Fit).
  *
- * Recorre todos los bloques libres y selecciona aquel cuyo tamaño sea
- * el mínimo posible pero aún así >= size. Minimiza fragmentación externa.
+ * Selecciona el bloque libre cuyo tamaño sea el mínimo posible pero aún así
+ * >= size. Minimiza fragmentación externa. Se resuelve como una cota
+ * inferior en el árbol de libres ordenado por tamaño, o con dos pasadas
+ * sobre la tabla de bloques.
  *
- * @param size Tamaño solicitado en bytes.
+ * @param size  Tamaño solicitado en bytes.
+ * @param align Alineación en bytes.
  * @return El bloque más ajustado, o `NULL` si no existe uno adecuado.
  */
-static Block *find_best_fit(size_t size) {
-    Block *curr = blocks_first();
-    Block *best = NULL;
-
-    while (curr) {
-        if (curr->is_free && curr->size >= size) {
-            if (best == NULL || curr->size < best->size) {
-                best = curr;
-            }
-        }
-        curr = curr->next;
-    }
+static Block *find_best_fit(size_t size, size_t align) {
+    if (blocks_table_active()) return block_table_best_fit(size, align);
 
-    return best;
+    return align > 1 ? free_index_best_fit_aligned(size, align)
+                     : free_index_best_fit(size);
 }
 
 /* ------------------------------------------------------------------------- */
@@ -88,63 +204,831 @@ static Block *find_best_fit(size_t size) {
  * @brief Busca el bloque libre más grande disponible (Worst-Fit).
  *
  * Selecciona el bloque libre con mayor tamaño. Tiende a reducir
- * fragmentación interna generando huecos más grandes.
+ * fragmentación interna generando huecos más grandes. Es el máximo del árbol
+ * de libres ordenado por tamaño, o dos pasadas sobre la tabla de bloques.
  *
- * @param size Tamaño solicitado en bytes.
+ * @param size  Tamaño solicitado en bytes.
+ * @param align Alineación en bytes.
  * @return El bloque más grande que puede usarse, o `NULL` si no existe.
  */
-static Block *find_worst_fit(size_t size) {
-    Block *curr = blocks_first();
-    Block *worst = NULL;
+static Block *find_worst_fit(size_t size, size_t align) {
+    if (blocks_table_active()) return block_table_worst_fit(size, align);
+
+    return align > 1 ? free_index_worst_fit_aligned(size, align)
+                     : free_index_worst_fit(size);
+}
+
+/* ------------------------------------------------------------------------- */
+/*                  OPERACIONES DE LAS POLÍTICAS DE LISTA                    */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Une los bloques libres pendientes en un barrido de la lista.
+ *
+ * @return true si el barrido unió algún par de bloques.
+ */
+static bool coalesce_pending(void) {
+    AllocState *st = state();
+    if (!st->pending_frees) return false;
+
+    st->pending_frees = 0;
+    st->stats.coalesce_sweeps++;
+    return blocks_coalesce() > 0;
+}
+
+/**
+ * @brief Fusiona un bloque recién liberado o lo deja pendiente.
+ *
+ * En modo diferido solo se cuenta; al alcanzar el umbral se barre la lista.
+ *
+ * @param block Bloque libre.
+ */
+static void list_coalesce(Block *block) {
+    AllocState *st = state();
+    if (!st->coalesce_threshold) {
+        block_merge(block);
+        return;
+    }
+    if (++st->pending_frees >= st->coalesce_threshold) {
+        coalesce_pending();
+    }
+}
+
+/**
+ * @brief Reserva con First/Best/Worst/Next-Fit: búsqueda, marcado y split.
+ *
+ * Si el bloque elegido no está alineado, el relleno inicial se separa y
+ * queda en la lista como bloque libre propio. Si la búsqueda falla con
+ * fusiones diferidas pendientes, se barre la lista y se busca otra vez.
+ *
+ * @param size  Tamaño solicitado en bytes.
+ * @param align Alineación en bytes.
+ * @return Bloque ocupado de exactamente `size` bytes, o `NULL`.
+ */
+static Block *list_alloc(size_t size, size_t align) {
+    AllocState *st = state();
+    Block *block = st->active->find(size, align);
+    if (!block && coalesce_pending()) {
+        block = st->active->find(size, align);
+    }
+    if (!block) return NULL;
+
+    size_t pad = free_index_align_pad(block->offset, align);
+    if (pad) {
+        block_split(block, pad);
+        block = block->next;
+        allocator_note_alignment(pad, 0);
+    }
+
+    /* Marcar primero para que el split no reindexe el bloque elegido */
+    block_mark_used(block);
+
+    if (block->size > size) {
+        block_split(block, size);
+    }
+    return block;
+}
+
+/**
+ * @brief Liberación con fusión de ambos vecinos, inmediata o diferida.
+ *
+ * @param block Bloque ocupado a liberar.
+ */
+static void list_free(Block *block) {
+    block_mark_free(block);
+    list_coalesce(block);
+}
+
+/**
+ * @brief Redimensionamiento in-place de las políticas de lista.
+ *
+ * Una reducción separa el sobrante como bloque libre y lo fusiona con el
+ * bloque libre siguiente, si existe (o lo deja pendiente en modo diferido).
+ * Una expansión toma bytes del bloque libre siguiente; si no alcanzan y hay
+ * fusiones pendientes, se barre la lista y se reintenta.
+ *
+ * @param block    Bloque ocupado.
+ * @param new_size Nuevo tamaño en bytes.
+ * @return true si el bloque quedó con `new_size` bytes sin moverse.
+ */
+static bool list_resize(Block *block, size_t new_size) {
+    if (new_size <= block->size) {
+        if (new_size < block->size) {
+            block_split(block, new_size);
+            list_coalesce(block->next);
+        }
+        return true;
+    }
+
+    size_t extra = new_size - block->size;
+    return block_grow(block, extra) ||
+           (coalesce_pending() && block_grow(block, extra));
+}
+
+/**
+ * @brief Expansión de las políticas de lista que también usa el bloque
+ *        libre anterior, desplazando el bloque hacia atrás.
+ *
+ * Si no alcanza y hay fusiones pendientes, se barre la lista y se reintenta.
+ *
+ * @param block    Bloque ocupado.
+ * @param new_size Nuevo tamaño en bytes.
+ * @param align    Alineación del nuevo offset.
+ * @return true si el bloque cubre `new_size` bytes en su nuevo offset.
+ */
+static bool list_expand(Block *block, size_t new_size, size_t align) {
+    return block_expand_back(block, new_size, align) ||
+           (coalesce_pending() && block_expand_back(block, new_size, align));
+}
+
+/**
+ * @brief Reserva de las políticas de lista para una corrida de bloques.
+ *
+ * La corrida completa se busca como un único bloque de `size * count`
+ * bytes, con la política activa, y se divide con `block_carve()`.
+ *
+ * @param size  Tamaño de cada bloque (múltiplo de `align`).
+ * @param align Alineación en bytes.
+ * @param count Cantidad de bloques.
+ * @param out   Recibe los bloques reservados.
+ * @return Bloques reservados, o 0 si ningún bloque libre alcanza.
+ */
+static size_t list_alloc_run(size_t size, size_t align, size_t count, Block **out) {
+    AllocState *st = state();
+    size_t total = size * count;
+    Block *block = st->active->find(total, align);
+    if (!block && coalesce_pending()) {
+        block = st->active->find(total, align);
+    }
+    if (!block) return 0;
+
+    size_t pad = free_index_align_pad(block->offset, align);
+    if (pad) {
+        block_split(block, pad);
+        block = block->next;
+        allocator_note_alignment(pad, 0);
+    }
+
+    size_t carved = block_carve(block, size, count);
+    for (size_t i = 0; i < carved; i++, block = block->next) {
+        out[i] = block;
+    }
+    return carved;
+}
+
+/**
+ * @brief Liberación en grupo de las políticas de lista.
+ *
+ * El grupo se fusiona de inmediato aun con la fusión diferida activa: la
+ * pasada única ya es el barrido.
+ *
+ * @param blocks Bloques ocupados a liberar.
+ * @param count  Cantidad de bloques.
+ */
+static void list_free_run(Block **blocks, size_t count) {
+    blocks_release(blocks, count);
+}
+
+/**
+ * @brief Incorpora a la lista los bytes agregados al final de la arena.
+ *
+ * @param old_size Tamaño anterior de la arena.
+ * @param new_size Tamaño nuevo.
+ * @return true si la lista cubre la arena nueva.
+ */
+static bool list_grow(size_t old_size, size_t new_size) {
+    return blocks_extend(new_size - old_size) != NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                          REGISTRO DE MOTORES                              */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Motores incluidos, en el orden de `AllocAlgorithm`.
+ */
+static const AllocEngine builtin_engines[] = {
+    { "first-fit", NULL,        NULL,           find_first_fit,    list_alloc,   list_free,   list_resize,   NULL,               NULL,        NULL,            blocks_compact, list_grow, list_expand, list_alloc_run, list_free_run },
+    { "best-fit",  NULL,        NULL,           find_best_fit,     list_alloc,   list_free,   list_resize,   NULL,               NULL,        NULL,            blocks_compact, list_grow, list_expand, list_alloc_run, list_free_run },
+    { "worst-fit", NULL,        NULL,           find_worst_fit,    list_alloc,   list_free,   list_resize,   NULL,               NULL,        NULL,            blocks_compact, list_grow, list_expand, list_alloc_run, list_free_run },
+    { "next-fit",  NULL,        NULL,           find_next_fit,     list_alloc,   list_free,   list_resize,   NULL,               NULL,        NULL,            blocks_compact, list_grow, list_expand, list_alloc_run, list_free_run },
+    { "buddy",     buddy_init,  buddy_destroy,  buddy_find_block,  buddy_alloc,  buddy_free,  buddy_resize,  buddy_print_stats,  NULL,        buddy_overhead,  NULL,           NULL,      NULL,        NULL,           NULL },
+    { "tlsf",      tlsf_init,   tlsf_destroy,   tlsf_find_block,   tlsf_alloc,   tlsf_free,   tlsf_resize,   tlsf_print_stats,   NULL,        tlsf_overhead,   tlsf_compact,   tlsf_grow, NULL,        NULL,           NULL },
+    { "bitmap",    bitmap_init, bitmap_destroy, bitmap_find_block, bitmap_alloc, bitmap_free, bitmap_resize, bitmap_print_stats, bitmap_walk, bitmap_overhead, NULL,           NULL,      NULL,        NULL,           NULL },
+    { "tags",      tags_init,   tags_destroy,   tags_find_block,   tags_alloc,   tags_free,   tags_resize,   tags_print_stats,   tags_walk,   tags_overhead,   NULL,           NULL,      NULL,        NULL,           NULL },
+    { "tags-best", tags_best_init,  tags_destroy, tags_find_block, tags_alloc, tags_free, tags_resize, tags_print_stats, tags_walk, tags_overhead, NULL,   NULL,      NULL,        NULL,           NULL },
+    { "tags-worst", tags_worst_init, tags_destroy, tags_find_block, tags_alloc, tags_free, tags_resize, tags_print_stats, tags_walk, tags_overhead, NULL,  NULL,      NULL,        NULL,           NULL },
+    { "tags-next", tags_next_init,  tags_destroy, tags_find_block, tags_alloc, tags_free, tags_resize, tags_print_stats, tags_walk, tags_overhead, NULL,   NULL,      NULL,        NULL,           NULL },
+};
+
+/** @brief Cantidad de motores incluidos. */
+#define BUILTIN_ENGINES (sizeof(builtin_engines) / sizeof(builtin_engines[0]))
+
+/**
+ * @brief Motores registrados; los primeros son los incluidos.
+ */
+static const AllocEngine *registry[ALLOC_MAX_ENGINES] = {
+    &builtin_engines[0], &builtin_engines[1], &builtin_engines[2],
+    &builtin_engines[3], &builtin_engines[4], &builtin_engines[5],
+    &builtin_engines[6], &builtin_engines[7], &builtin_engines[8],
+    &builtin_engines[9], &builtin_engines[10],
+};
+
+/** @brief Cantidad de motores registrados. */
+static size_t registry_count = BUILTIN_ENGINES;
+
+/** @brief Estado de un contexto nuevo: First-Fit y fusión inmediata. */
+static const AllocState initial = { .active = &builtin_engines[ALLOC_FIRST_FIT] };
+
+/**
+ * @brief Estado del asignador en el contexto del hilo actual.
+ */
+static AllocState *state(void) {
+    return sim_context_state(SIM_STATE_ALLOCATOR, &initial, sizeof(initial));
+}
+
+/**
+ * @brief Visitante que detecta segmentos ocupados.
+ */
+static void note_used(const Block *block, void *ctx) {
+    if (!block->is_free) {
+        *(bool *)ctx = false;
+    }
+}
+
+/**
+ * @brief Indica si ningún bloque de la arena está ocupado.
+ */
+static bool heap_is_empty(void) {
+    bool empty = true;
+    allocator_walk(note_used, &empty);
+    return empty;
+}
 
-    while (curr) {
-        if (curr->is_free && curr->size >= size) {
-            if (worst == NULL || curr->size > worst->size) {
-                worst = curr;
-            }
+/**
+ * @brief Libera el estado interno del motor activo, si tiene.
+ */
+static void engine_destroy(void) {
+    AllocState *st = state();
+    if (st->active->destroy) {
+        st->active->destroy();
+    }
+}
+
+/**
+ * @brief Registra un motor para que pueda seleccionarse por nombre.
+ *
+ * @param engine Motor con nombre único y ganchos find/alloc/free/resize.
+ * @return true si se registró.
+ */
+bool allocator_register(const AllocEngine *engine) {
+    if (!engine || !engine->name || !engine->find || !engine->alloc ||
+        !engine->free || !engine->resize) {
+        log_error("allocator_register: motor incompleto");
+        return false;
+    }
+    if (allocator_find_engine(engine->name)) {
+        log_error("allocator_register: el motor '%s' ya existe", engine->name);
+        return false;
+    }
+    if (registry_count == ALLOC_MAX_ENGINES) {
+        log_error("allocator_register: no caben más de %d motores", ALLOC_MAX_ENGINES);
+        return false;
+    }
+
+    registry[registry_count++] = engine;
+    return true;
+}
+
+/**
+ * @brief Busca un motor registrado por nombre.
+ *
+ * @param name Nombre del motor.
+ * @return Motor encontrado, o NULL.
+ */
+const AllocEngine *allocator_find_engine(const char *name) {
+    for (size_t i = 0; i < registry_count; i++) {
+        if (strcmp(registry[i]->name, name) == 0) {
+            return registry[i];
         }
-        curr = curr->next;
     }
+    return NULL;
+}
 
-    return worst;
+/**
+ * @brief Cantidad de motores registrados.
+ */
+size_t allocator_engine_count(void) {
+    return registry_count;
+}
+
+/**
+ * @brief Motor registrado en la posición `idx`.
+ *
+ * @param idx Índice (0..allocator_engine_count()-1).
+ * @return Motor, o NULL si el índice no existe.
+ */
+const AllocEngine *allocator_engine_at(size_t idx) {
+    return idx < registry_count ? registry[idx] : NULL;
+}
+
+/**
+ * @brief Motor activo.
+ */
+const AllocEngine *allocator_engine(void) {
+    return state()->active;
 }
 
 /* ------------------------------------------------------------------------- */
 /*                           API DE ASIGNACIÓN                               */
 /* ------------------------------------------------------------------------- */
 
+/**
+ * @brief Activa un motor registrado.
+ *
+ * Los motores con gancho `init` reorganizan la arena, por lo que solo pueden
+ * activarse con la arena vacía; lo mismo ocurre al salir de un motor con
+ * gancho `walk`, cuyas reservas no están en la lista general. En caso
+ * contrario se conserva el motor anterior. Si `init` falla, se vuelve a
+ * First-Fit.
+ *
+ * @param name Nombre del motor.
+ * @return true si el motor quedó activo.
+ */
+bool allocator_select(const char *name) {
+    AllocState *st = state();
+    const AllocEngine *engine = allocator_find_engine(name);
+    if (!engine) {
+        log_error("Motor de asignación desconocido: '%s'", name);
+        return false;
+    }
+    if (engine == st->active) return true;
+
+    if ((engine->init || st->active->walk) && !heap_is_empty()) {
+        log_error("No se pudo activar el motor '%s': la arena no está vacía", name);
+        return false;
+    }
+
+    /* Los motores entrantes esperan bloques libres ya fusionados */
+    coalesce_pending();
+
+    /* El motor saliente se libera antes para que el entrante parta del
+     * índice general de libres reconstruido. */
+    engine_destroy();
+    st->active = engine;
+
+    bool ok = !engine->init || engine->init(memory_size());
+    if (!ok) {
+        log_error("No se pudo activar el motor '%s'", name);
+        st->active = &builtin_engines[ALLOC_FIRST_FIT];
+    }
+
+    /* Los bytes en uso pertenecen a la arena, no al motor */
+    allocator_reset_stats(st->stats.in_use);
+    log_info("Motor de asignación: %s", st->active->name);
+    return ok;
+}
+
 /**
  * @brief Cambia el algoritmo de asignación utilizado por el simulador.
  *
- * @param algo El nuevo algoritmo a utilizar (FIRST, BEST o WORST-FIT).
+ * Equivale a `allocator_select()` con el nombre del motor incluido.
+ *
+ * @param algo El nuevo algoritmo a utilizar (FIRST, BEST, WORST, NEXT-FIT,
+ *             BUDDY, TLSF, BITMAP o TAGS).
  */
 void allocator_set_algorithm(AllocAlgorithm algo) {
-    current_algo = algo;
-    log_info("Algoritmo de asignación cambiado a %d", (int)algo);
+    if ((size_t)algo >= BUILTIN_ENGINES) {
+        log_error("Algoritmo de asignación desconocido (%d)", (int)algo);
+        return;
+    }
+    allocator_select(builtin_engines[algo].name);
+}
+
+/**
+ * @brief Mueve en la arena los datos de un bloque compactado.
+ *
+ * Los offsets de origen y destino pueden solaparse. El destino queda marcado
+ * como escrito para CALLOC. Si el bloque respalda un slab, sus ranuras se
+ * reubican con él.
+ *
+ * @param block      Bloque con su offset nuevo.
+ * @param old_offset Offset anterior.
+ * @param ctx        Sin uso.
+ */
+static void move_block(Block *block, size_t old_offset, void *ctx) {
+    unsigned char *arena = memory_arena();
+    (void)ctx;
+
+    memmove(arena + block->offset, arena + old_offset, block->size);
+    memory_mark_dirty(block->offset, block->size);
+    if (block->slab) {
+        slab_moved(block);
+    }
+}
+
+/**
+ * @brief Compacta la arena con el gancho del motor activo y lo cronometra.
+ *
+ * @param moved Bytes movidos (puede ser NULL).
+ * @param ns    Duración en nanosegundos (puede ser NULL).
+ * @return false si el motor no tiene gancho `compact`.
+ */
+bool allocator_compact(size_t *moved, unsigned long long *ns) {
+    AllocState *st = state();
+    if (!st->active->compact) {
+        log_error("El motor '%s' no admite compactación", st->active->name);
+        return false;
+    }
+
+    unsigned long long start = now_ns();
+    size_t bytes = st->active->compact(move_block, NULL);
+    unsigned long long elapsed = now_ns() - start;
+
+    st->stats.compactions++;
+    st->stats.compact_moved += bytes;
+    st->stats.compact_ns += elapsed;
+
+    if (moved) *moved = bytes;
+    if (ns) *ns = elapsed;
+    return true;
+}
+
+/**
+ * @brief Elige entre el índice de árboles y la tabla de bloques.
+ *
+ * @param table true para la tabla de bloques.
+ * @return true si quedó en uso el almacén pedido.
+ */
+bool allocator_use_table(bool table) {
+    if (!blocks_set_table(table)) return false;
+
+    log_info("Almacén de libres: %s", table ? "tabla" : "índice");
+    return true;
+}
+
+/**
+ * @brief Hace crecer la arena para una reserva que no cupo.
+ *
+ * Lo que falta se calcula para el peor relleno de alineación, descontando
+ * el bloque libre final que el crecimiento extiende. Si el bloque final ya
+ * alcanzaba (el motor redondea la búsqueda, como TLSF), se pide el tamaño
+ * completo.
+ *
+ * @param size  Tamaño de la reserva.
+ * @param align Alineación en bytes.
+ * @return true si la arena creció.
+ */
+bool allocator_grow(size_t size, size_t align) {
+    AllocState *st = state();
+    if (!st->active->grow) return false;
+
+    Block *last = blocks_last();
+    size_t tail = last && last->is_free ? last->size : 0;
+    size_t want = size + align - 1;
+    size_t old_size = memory_size();
+
+    if (!memory_grow(want > tail ? want - tail : want)) return false;
+
+    if (!st->active->grow(old_size, memory_size())) {
+        log_error("El motor '%s' no pudo incorporar la arena nueva", st->active->name);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Activa la fusión diferida de las políticas de lista o vuelve a la
+ *        inmediata.
+ *
+ * @param threshold Liberaciones por barrido, o 0 para fusión inmediata.
+ */
+void allocator_defer_coalescing(size_t threshold) {
+    state()->coalesce_threshold = threshold;
+    if (!threshold) {
+        coalesce_pending();
+        log_info("Fusión de libres: inmediata");
+    } else {
+        log_info("Fusión de libres: diferida (barrido cada %zu liberaciones)", threshold);
+    }
 }
 
 /**
- * @brief Selecciona un bloque libre usando el algoritmo configurado.
+ * @brief Recorre la arena con el motor activo o con la lista general.
  *
- * Esta función actúa como fachada, delegando a la función correspondiente
- * según el algoritmo activo.
+ * @param visit Función invocada por cada segmento.
+ * @param ctx   Contexto para `visit`.
+ */
+void allocator_walk(BlockVisitor visit, void *ctx) {
+    AllocState *st = state();
+    if (st->active->walk) {
+        st->active->walk(visit, ctx);
+        return;
+    }
+    for (Block *b = blocks_first(); b; b = b->next) {
+        visit(b, ctx);
+    }
+}
+
+/**
+ * @brief Selecciona un bloque libre usando el motor activo.
  *
  * @param size Tamaño solicitado en bytes.
  * @return Un bloque adecuado para la asignación, o `NULL` si no se encuentra.
  */
 Block *allocator_find_block(size_t size) {
-    switch (current_algo) {
-        case ALLOC_FIRST_FIT:
-            return find_first_fit(size);
+    return state()->active->find(size, 1);
+}
+
+/**
+ * @brief Reserva un bloque sin restricción de alineación.
+ *
+ * @param size Tamaño solicitado en bytes.
+ * @return Bloque ocupado con `requested == size`, o `NULL` si no hay espacio.
+ */
+Block *allocator_alloc(size_t size) {
+    return allocator_alloc_aligned(size, 1);
+}
+
+/**
+ * @brief Reserva un bloque alineado con el motor activo.
+ *
+ * @param size  Tamaño solicitado en bytes.
+ * @param align Alineación en bytes (potencia de dos).
+ * @return Bloque ocupado con `requested == size`, o `NULL` si no hay espacio.
+ */
+Block *allocator_alloc_aligned(size_t size, size_t align) {
+    AllocState *st = state();
+    unsigned long long start = now_ns();
+    Block *block = st->active->alloc(size, align);
+
+    record_latency(now_ns() - start);
+
+    if (!block) {
+        st->stats.failures++;
+        return NULL;
+    }
+
+    st->stats.allocs++;
+    if (align > 1) {
+        st->stats.aligned++;
+    }
+    st->stats.in_use += size;
+    if (st->stats.in_use > st->stats.peak_in_use) {
+        st->stats.peak_in_use = st->stats.in_use;
+    }
+    block->requested = size;
+    block_set_alignment(block, align);
+    return block;
+}
+
+/**
+ * @brief Reserva una corrida de bloques contiguos con el motor activo.
+ *
+ * Cada bloque ocupa `size` redondeado a múltiplo de `align`; ese redondeo
+ * se cuenta como relleno de alineación desperdiciado.
+ *
+ * @param size  Tamaño solicitado de cada bloque.
+ * @param align Alineación en bytes (potencia de dos).
+ * @param count Cantidad de bloques.
+ * @param out   Recibe los bloques reservados.
+ * @return Bloques reservados, o 0 si el motor no reserva corridas o ningún
+ *         bloque libre alcanza.
+ */
+size_t allocator_alloc_run(size_t size, size_t align, size_t count, Block **out) {
+    AllocState *st = state();
+    size_t stride = (size + align - 1) & ~(align - 1);
+
+    if (!st->active->alloc_run || stride < size || count > SIZE_MAX / stride) {
+        return 0;
+    }
 
-        case ALLOC_BEST_FIT:
-            return find_best_fit(size);
+    unsigned long long start = now_ns();
+    size_t n = st->active->alloc_run(stride, align, count, out);
 
-        case ALLOC_WORST_FIT:
-            return find_worst_fit(size);
+    record_latency(now_ns() - start);
+    if (!n) return 0;
 
-        default:
-            log_error("Algoritmo de asignación desconocido (%d)", (int)current_algo);
-            return NULL;
+    for (size_t i = 0; i < n; i++) {
+        out[i]->requested = size;
+        block_set_alignment(out[i], align);
     }
+
+    st->stats.allocs += n;
+    if (align > 1) {
+        st->stats.aligned += n;
+    }
+    st->stats.align_kept += n * (stride - size);
+    st->stats.alloc_runs++;
+    st->stats.run_blocks += n;
+    st->stats.in_use += n * size;
+    if (st->stats.in_use > st->stats.peak_in_use) {
+        st->stats.peak_in_use = st->stats.in_use;
+    }
+    return n;
+}
+
+/**
+ * @brief Acumula el relleno de alineación informado por un motor.
+ *
+ * @param split Bytes devueltos a la arena como bloque libre.
+ * @param kept  Bytes que quedan dentro del bloque reservado.
+ */
+void allocator_note_alignment(size_t split, size_t kept) {
+    AllocState *st = state();
+    st->stats.align_split += split;
+    st->stats.align_kept += kept;
+}
+
+/**
+ * @brief Libera un bloque con el motor activo.
+ *
+ * @param block Bloque ocupado a liberar.
+ */
+void allocator_free(Block *block) {
+    AllocState *st = state();
+    if (!block || block->is_free) return;
+
+    st->stats.frees++;
+    st->stats.in_use -= block->requested;
+    st->active->free(block);
+}
+
+/**
+ * @brief Libera un grupo de bloques con el motor activo.
+ *
+ * @param blocks Bloques ocupados a liberar.
+ * @param count  Cantidad de bloques.
+ */
+void allocator_free_run(Block **blocks, size_t count) {
+    AllocState *st = state();
+
+    for (size_t i = 0; i < count; i++) {
+        st->stats.in_use -= blocks[i]->requested;
+    }
+    st->stats.frees += count;
+    st->stats.free_groups++;
+    st->stats.group_blocks += count;
+
+    if (st->active->free_run) {
+        st->active->free_run(blocks, count);
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        st->active->free(blocks[i]);
+    }
+}
+
+/**
+ * @brief Actualiza los bytes en uso tras redimensionar un bloque.
+ *
+ * @param st       Estado del contexto actual.
+ * @param block    Bloque redimensionado.
+ * @param new_size Nuevo tamaño solicitado.
+ */
+static void note_resize(AllocState *st, Block *block, size_t new_size) {
+    st->stats.in_use = st->stats.in_use - block->requested + new_size;
+    if (st->stats.in_use > st->stats.peak_in_use) {
+        st->stats.peak_in_use = st->stats.in_use;
+    }
+    block->requested = new_size;
+}
+
+/**
+ * @brief Redimensiona un bloque en su lugar con el motor activo.
+ *
+ * @param block    Bloque ocupado.
+ * @param new_size Nuevo tamaño solicitado en bytes.
+ * @return true si el bloque no necesita moverse.
+ */
+bool allocator_resize(Block *block, size_t new_size) {
+    AllocState *st = state();
+    bool done = st->active->resize(block, new_size);
+
+    if (done) {
+        note_resize(st, block, new_size);
+    }
+    return done;
+}
+
+/**
+ * @brief Redimensiona un bloque desplazándolo hacia el bloque libre anterior.
+ *
+ * @param block    Bloque ocupado.
+ * @param new_size Nuevo tamaño solicitado en bytes.
+ * @param align    Alineación del nuevo offset.
+ * @return true si el bloque cambió de offset y cubre `new_size` bytes.
+ */
+bool allocator_expand(Block *block, size_t new_size, size_t align) {
+    AllocState *st = state();
+
+    if (!st->active->expand || !st->active->expand(block, new_size, align)) {
+        return false;
+    }
+    note_resize(st, block, new_size);
+    block_set_alignment(block, align);
+    return true;
+}
+
+/**
+ * @brief Registra cómo se resolvió un REALLOC.
+ *
+ * @param kind   En su lugar, deslizado o movido.
+ * @param copied Bytes de contenido copiados.
+ */
+void allocator_note_realloc(AllocRealloc kind, size_t copied) {
+    AllocState *st = state();
+
+    switch (kind) {
+    case ALLOC_REALLOC_IN_PLACE: st->stats.realloc_in_place++; break;
+    case ALLOC_REALLOC_SLID:     st->stats.realloc_slid++;     break;
+    case ALLOC_REALLOC_MOVED:    st->stats.realloc_moved++;    break;
+    }
+    st->stats.realloc_copied += copied;
+}
+
+/**
+ * @brief Registra un CALLOC.
+ *
+ * @param size   Bytes pedidos.
+ * @param zeroed Bytes que hubo que poner en cero.
+ */
+void allocator_note_calloc(size_t size, size_t zeroed) {
+    AllocState *st = state();
+    st->stats.callocs++;
+    st->stats.calloc_bytes += size;
+    st->stats.calloc_zeroed += zeroed;
+}
+
+/**
+ * @brief Registra las reservas y liberaciones atendidas por la caché de un
+ *        hilo.
+ *
+ * @param hits   Reservas atendidas por la caché.
+ * @param stores Liberaciones que quedaron en la caché.
+ * @param grown  Cambio de los bytes en uso (módulo `SIZE_MAX + 1`).
+ */
+void allocator_note_cache(size_t hits, size_t stores, size_t grown) {
+    AllocState *st = state();
+    st->stats.cache_hits += hits;
+    st->stats.cache_stores += stores;
+    st->stats.in_use += grown;
+    if (st->stats.in_use > st->stats.peak_in_use) {
+        st->stats.peak_in_use = st->stats.in_use;
+    }
+}
+
+/**
+ * @brief Libera el estado interno del motor activo.
+ *
+ * El motor vuelve a First-Fit, que no requiere estado propio. Las fusiones
+ * diferidas pendientes se descartan junto con la lista de bloques.
+ */
+void allocator_shutdown(void) {
+    AllocState *st = state();
+    engine_destroy();
+    st->pending_frees = 0;
+    st->active = &builtin_engines[ALLOC_FIRST_FIT];
+}
+
+/**
+ * @brief Metadatos del motor activo.
+ *
+ * Sin gancho `overhead`, son los nodos `Block` de la lista general (el
+ * índice de libres vive dentro de ellos).
+ *
+ * @param out Bytes dentro y fuera de la arena.
+ */
+void allocator_overhead(AllocOverhead *out) {
+    AllocState *st = state();
+    if (st->active->overhead) {
+        st->active->overhead(out);
+        return;
+    }
+
+    size_t live;
+    blocks_pool_usage(&live, NULL);
+    out->in_arena = 0;
+    out->outside = live * sizeof(Block);
+}
+
+/**
+ * @brief Estadísticas acumuladas desde la última selección de motor.
+ *
+ * @return Puntero de solo lectura a los contadores internos.
+ */
+const AllocStats *allocator_stats(void) {
+    return &state()->stats;
+}
+
+/**
+ * @brief Pone en cero las estadísticas, salvo los bytes en uso.
+ *
+ * @param in_use Bytes en uso; también es el pico inicial.
+ */
+void allocator_reset_stats(size_t in_use) {
+    AllocState *st = state();
+    memset(&st->stats, 0, sizeof(st->stats));
+    st->stats.in_use = st->stats.peak_in_use = in_use;
+    blocks_churn_reset();
 }
@@ -0,0 +1,772 @@
+/**
+ * @file bitmap.c
+ * @brief Implementación del motor de asignación por mapa de bits.
+ *
+ * Estructuras internas:
+ *  - `bits`: un bit por gránulo (1 = ocupado). Los bits sobrantes de la
+ *    última palabra se marcan ocupados para que nunca se reserven.
+ *  - `hint`: primera palabra que puede tener un bit libre; todas las
+ *    anteriores están llenas. Mantiene el costo de First-Fit acotado por la
+ *    zona fragmentada en lugar del tamaño de la arena.
+ *  - Un pool de manejadores `Block` reservados por lotes, con una lista de
+ *    reciclaje enlazada por `free_next`.
+ *  - `owners`: tabla hash de direccionamiento abierto del primer gránulo de
+ *    cada reserva a su manejador. El recorrido de la arena lee los tramos
+ *    ocupados del propio mapa y ubica el manejador de cada uno por su
+ *    offset, sin juntar ni ordenar los manejadores.
+ *
+ * La búsqueda recorre palabras de 64 bits: las llenas y las vacías se saltan
+ * en bloque (de a dos con SSE2 si está disponible) y dentro de una palabra
+ * mixta los tramos se miden con `ctz`. Un contador de gránulos libres
+ * (mantenido con `popcount` al iniciar) descarta en O(1) las solicitudes que
+ * no caben en absoluto.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "bitmap.h"
+#include "sim_context.h"
+#include "log.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/** @brief Bits por palabra del mapa. */
+#define WORD_BITS 64
+
+/** @brief Valor devuelto por la búsqueda cuando no hay secuencia libre. */
+#define NO_RUN SIZE_MAX
+
+/**
+ * @struct HandleChunk
+ * @brief Lote de manejadores reservado con un solo `malloc`.
+ */
+typedef struct HandleChunk {
+    struct HandleChunk *next;                /**< Siguiente lote. */
+    Block handles[BITMAP_HANDLE_CHUNK];      /**< Manejadores del lote. */
+} HandleChunk;
+
+/* ------------------------------------------------------------------------- */
+/*                             ESTADO POR CONTEXTO                           */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Estado del motor bitmap en un contexto de simulación.
+ */
+typedef struct {
+    /** @brief Mapa de bits de gránulos (1 = ocupado). */
+    uint64_t *bits;
+
+    /** @brief Cantidad de palabras del mapa. */
+    size_t word_count;
+
+    /** @brief Cantidad de gránulos utilizables. */
+    size_t granule_count;
+
+    /** @brief Tamaño total de la arena administrada. */
+    size_t heap_size;
+
+    /** @brief Gránulos libres actualmente. */
+    size_t free_granules;
+
+    /** @brief Primera palabra que puede contener un gránulo libre. */
+    size_t hint;
+
+    /** @brief Lotes del pool de manejadores. */
+    HandleChunk *chunks;
+
+    /** @brief Manejadores disponibles para reciclar. */
+    Block *free_handles;
+
+    /** @brief Manejadores en uso. */
+    size_t live_handles;
+
+    /** @brief Tabla hash gránulo inicial -> manejador (NULL = vacía). */
+    Block **owners;
+
+    /** @brief Entradas de `owners` (potencia de dos, o 0 sin tabla). */
+    size_t owner_cap;
+
+    /** @brief Descriptor temporal devuelto por `bitmap_find_block()`. */
+    Block scratch;
+} BitmapState;
+
+/** @brief Estado de un contexto nuevo: sin mapa ni manejadores. */
+static const BitmapState initial = { 0 };
+
+/**
+ * @brief Estado del motor bitmap en el contexto del hilo actual.
+ */
+static BitmapState *state(void) {
+    return sim_context_state(SIM_STATE_BITMAP, &initial, sizeof(initial));
+}
+
+/* ------------------------------------------------------------------------- */
+/*                        OPERACIONES SOBRE EL MAPA                          */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Primera palabra desde `i` distinta de `value`.
+ *
+ * Con SSE2 compara dos palabras por instrucción.
+ */
+static size_t skip_words(size_t i, uint64_t value) {
+    BitmapState *st = state();
+#if defined(__SSE2__)
+    const __m128i v = _mm_set1_epi64x((long long)value);
+    while (i + 2 <= st->word_count) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(st->bits + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(x, v)) != 0xFFFF) break;
+        i += 2;
+    }
+#endif
+    while (i < st->word_count && st->bits[i] == value) {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * @brief Máscara de los bits [lo, hi) de una palabra (0 <= lo < hi <= 64).
+ */
+static uint64_t range_mask(unsigned lo, unsigned hi) {
+    uint64_t upper = (hi == WORD_BITS) ? ~0ULL : ((1ULL << hi) - 1);
+    return upper & ~((1ULL << lo) - 1);
+}
+
+/**
+ * @brief Enciende o apaga los gránulos [first, first + n).
+ */
+static void set_range(size_t first, size_t n, bool used) {
+    BitmapState *st = state();
+    size_t end = first + n;
+
+    while (first < end) {
+        size_t w = first / WORD_BITS;
+        unsigned lo = (unsigned)(first % WORD_BITS);
+        unsigned hi = (end - w * WORD_BITS >= WORD_BITS) ? WORD_BITS
+                                                          : (unsigned)(end - w * WORD_BITS);
+        uint64_t mask = range_mask(lo, hi);
+
+        if (used) {
+            st->bits[w] |= mask;
+        } else {
+            st->bits[w] &= ~mask;
+        }
+        first = w * WORD_BITS + hi;
+    }
+
+    if (used) {
+        st->free_granules -= n;
+    } else {
+        st->free_granules += n;
+    }
+}
+
+/**
+ * @brief Indica si los gránulos [first, first + n) están todos libres.
+ */
+static bool range_is_free(size_t first, size_t n) {
+    BitmapState *st = state();
+    if (first + n > st->granule_count) return false;
+
+    size_t end = first + n;
+    while (first < end) {
+        size_t w = first / WORD_BITS;
+        unsigned lo = (unsigned)(first % WORD_BITS);
+        unsigned hi = (end - w * WORD_BITS >= WORD_BITS) ? WORD_BITS
+                                                          : (unsigned)(end - w * WORD_BITS);
+        if (st->bits[w] & range_mask(lo, hi)) return false;
+        first = w * WORD_BITS + hi;
+    }
+    return true;
+}
+
+/**
+ * @brief Primer gránulo de la primera secuencia libre de `n` gránulos.
+ *
+ * @param n Gránulos necesarios (> 0).
+ * @return Gránulo inicial, o NO_RUN.
+ */
+static size_t find_run(size_t n) {
+    BitmapState *st = state();
+    if (n > st->free_granules) return NO_RUN;
+
+    /* Las palabras llenas antes de la pista nunca tienen gránulos libres */
+    st->hint = skip_words(st->hint, ~0ULL);
+
+    size_t run_start = 0;
+    size_t run_len = 0;
+
+    for (size_t i = st->hint; i < st->word_count; i++) {
+        uint64_t avail = ~st->bits[i];
+
+        if (avail == ~0ULL) {
+            /* Palabras completamente libres: extender el tramo en bloque */
+            size_t j = skip_words(i, 0);
+            if (run_len == 0) run_start = i * WORD_BITS;
+            run_len += (j - i) * WORD_BITS;
+            if (run_len >= n) return run_start;
+            i = j - 1;
+            continue;
+        }
+
+        if (avail == 0) {
+            /* Palabras completamente ocupadas: cortar el tramo y saltar */
+            run_len = 0;
+            i = skip_words(i, ~0ULL) - 1;
+            continue;
+        }
+
+        unsigned bit = 0;
+        while (bit < WORD_BITS) {
+            uint64_t rest = avail >> bit;
+
+            if (!rest) {
+                run_len = 0;
+                break;
+            }
+            if (rest & 1) {
+                unsigned len = (unsigned)__builtin_ctzll(~rest);
+                if (bit + len > WORD_BITS) len = WORD_BITS - bit;
+                if (run_len == 0) run_start = i * WORD_BITS + bit;
+                run_len += len;
+                if (run_len >= n) return run_start;
+                bit += len;
+            } else {
+                run_len = 0;
+                bit += (unsigned)__builtin_ctzll(rest);
+            }
+        }
+    }
+
+    return NO_RUN;
+}
+
+/**
+ * @brief Indica si el gránulo `g` está ocupado.
+ */
+static bool granule_used(size_t g) {
+    return (state()->bits[g / WORD_BITS] >> (g % WORD_BITS)) & 1;
+}
+
+/**
+ * @brief Último gránulo ocupado dentro de [first, first + n).
+ *
+ * @return Índice del gránulo, o NO_RUN si el rango está libre.
+ */
+static size_t last_used(size_t first, size_t n) {
+    size_t end = first + n;
+    size_t found = NO_RUN;
+
+    while (first < end) {
+        size_t w = first / WORD_BITS;
+        unsigned lo = (unsigned)(first % WORD_BITS);
+        unsigned hi = (end - w * WORD_BITS >= WORD_BITS) ? WORD_BITS
+                                                          : (unsigned)(end - w * WORD_BITS);
+        uint64_t used = state()->bits[w] & range_mask(lo, hi);
+        if (used) {
+            found = w * WORD_BITS + (WORD_BITS - 1 - (size_t)__builtin_clzll(used));
+        }
+        first = w * WORD_BITS + hi;
+    }
+    return found;
+}
+
+/**
+ * @brief Primera secuencia libre de `n` gránulos que inicia en un múltiplo
+ *        de `step` gránulos.
+ *
+ * Cada candidato que falla descarta todas las posiciones hasta su último
+ * gránulo ocupado, de modo que ningún gránulo ocupado se examina dos veces
+ * desde el mismo candidato.
+ *
+ * @param n    Gránulos necesarios (> 0).
+ * @param step Alineación en gránulos (potencia de dos > 1).
+ * @return Gránulo inicial, o NO_RUN.
+ */
+static size_t find_aligned_run(size_t n, size_t step) {
+    BitmapState *st = state();
+    if (n > st->free_granules) return NO_RUN;
+
+    st->hint = skip_words(st->hint, ~0ULL);
+
+    size_t g = (st->hint * WORD_BITS + step - 1) & ~(step - 1);
+    while (g < st->granule_count && n <= st->granule_count - g) {
+        size_t u = last_used(g, n);
+        if (u == NO_RUN) return g;
+        g = (u + step) & ~(step - 1);
+    }
+    return NO_RUN;
+}
+
+/**
+ * @brief Primer gránulo de la secuencia libre que aloja `n` gránulos
+ *        alineados a `align` bytes.
+ */
+static size_t find_placement(size_t n, size_t align) {
+    if (n == 0) return NO_RUN;
+    return align > BITMAP_GRANULE ? find_aligned_run(n, align / BITMAP_GRANULE)
+                                  : find_run(n);
+}
+
+/**
+ * @brief Gránulos libres consecutivos a partir de `first`.
+ *
+ * Mide con `ctz` el tramo dentro de la primera palabra, salta en bloque las
+ * palabras vacías y suma los bits libres iniciales de la palabra donde el
+ * tramo termina. Los bits sobrantes de la última palabra están ocupados, así
+ * que el tramo nunca pasa de `granule_count`.
+ */
+static size_t run_length(size_t first) {
+    BitmapState *st = state();
+    size_t w = first / WORD_BITS;
+    unsigned bit = (unsigned)(first % WORD_BITS);
+    uint64_t rest = ~st->bits[w] >> bit;
+    unsigned len = ~rest ? (unsigned)__builtin_ctzll(~rest) : WORD_BITS;
+
+    if (bit + len < WORD_BITS) return len;
+
+    size_t j = skip_words(w + 1, 0);
+    size_t total = (WORD_BITS - bit) + (j - w - 1) * WORD_BITS;
+    if (j < st->word_count) {
+        total += (size_t)__builtin_ctzll(st->bits[j]);
+    }
+    return total;
+}
+
+/**
+ * @brief Primer gránulo ocupado desde `first`, o `granule_count` si no hay.
+ */
+static size_t next_used(size_t first) {
+    BitmapState *st = state();
+    if (first >= st->granule_count) return st->granule_count;
+
+    size_t g = first + run_length(first);
+    return g < st->granule_count ? g : st->granule_count;
+}
+
+/**
+ * @brief Gránulos necesarios para `size` bytes.
+ */
+static size_t granules_for(size_t size) {
+    return size / BITMAP_GRANULE + (size % BITMAP_GRANULE != 0);
+}
+
+/* ------------------------------------------------------------------------- */
+/*                          POOL DE MANEJADORES                              */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Toma un manejador del pool, reservando un lote si está vacío.
+ *
+ * @return Manejador sin inicializar, o NULL si `malloc` falla.
+ */
+static Block *handle_get(void) {
+    BitmapState *st = state();
+    if (!st->free_handles) {
+        HandleChunk *c = malloc(sizeof(HandleChunk));
+        if (!c) {
+            log_error("Error: malloc falló en handle_get()");
+            return NULL;
+        }
+        c->next = st->chunks;
+        st->chunks = c;
+
+        for (size_t i = 0; i < BITMAP_HANDLE_CHUNK; i++) {
+            c->handles[i].is_free = true;
+            c->handles[i].free_next = st->free_handles;
+            st->free_handles = &c->handles[i];
+        }
+    }
+
+    Block *h = st->free_handles;
+    st->free_handles = h->free_next;
+    st->live_handles++;
+    return h;
+}
+
+/**
+ * @brief Devuelve un manejador al pool.
+ */
+static void handle_put(Block *h) {
+    BitmapState *st = state();
+    h->is_free = true;
+    h->requested = 0;
+    h->free_next = st->free_handles;
+    st->free_handles = h;
+    st->live_handles--;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                      TABLA DE MANEJADORES POR OFFSET                      */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Posición inicial de un gránulo en la tabla.
+ */
+static size_t owner_home(size_t granule) {
+    uint64_t h = (uint64_t)granule * 0x9E3779B97F4A7C15ULL;
+    return (size_t)(h ^ (h >> 32)) & (state()->owner_cap - 1);
+}
+
+/**
+ * @brief Entrada de la tabla que guarda el manejador del gránulo, o la
+ *        vacía donde iría.
+ */
+static size_t owner_slot(size_t granule) {
+    BitmapState *st = state();
+    size_t i = owner_home(granule);
+
+    while (st->owners[i] && st->owners[i]->offset / BITMAP_GRANULE != granule) {
+        i = (i + 1) & (st->owner_cap - 1);
+    }
+    return i;
+}
+
+/**
+ * @brief Duplica la tabla (o la crea) y reubica los manejadores.
+ *
+ * @return false si no hubo memoria; la tabla anterior sigue en uso.
+ */
+static bool owners_grow(void) {
+    BitmapState *st = state();
+    size_t old_cap = st->owner_cap;
+    Block **old = st->owners;
+    size_t cap = old_cap ? old_cap * 2 : 64;
+    Block **slots = calloc(cap, sizeof(Block *));
+
+    if (!slots) {
+        log_error("Error: calloc falló en owners_grow()");
+        return false;
+    }
+
+    st->owners = slots;
+    st->owner_cap = cap;
+    for (size_t i = 0; i < old_cap; i++) {
+        if (old[i]) {
+            st->owners[owner_slot(old[i]->offset / BITMAP_GRANULE)] = old[i];
+        }
+    }
+    free(old);
+    return true;
+}
+
+/**
+ * @brief Registra el manejador de una reserva nueva.
+ *
+ * La tabla se mantiene a lo sumo a la mitad de su capacidad.
+ */
+static bool owner_add(Block *h) {
+    BitmapState *st = state();
+    if (2 * (st->live_handles + 1) > st->owner_cap && !owners_grow()) {
+        return false;
+    }
+    st->owners[owner_slot(h->offset / BITMAP_GRANULE)] = h;
+    return true;
+}
+
+/**
+ * @brief Quita el manejador de una reserva.
+ *
+ * Las entradas siguientes del mismo grupo retroceden para ocupar el hueco,
+ * así que la tabla no necesita marcas de borrado.
+ */
+static void owner_remove(const Block *h) {
+    BitmapState *st = state();
+    size_t mask = st->owner_cap - 1;
+    size_t i = owner_slot(h->offset / BITMAP_GRANULE);
+
+    for (size_t j = (i + 1) & mask; st->owners[j]; j = (j + 1) & mask) {
+        size_t k = owner_home(st->owners[j]->offset / BITMAP_GRANULE);
+        /* La entrada j puede pasar a i si su posición inicial no queda
+         * en el tramo circular (i, j] */
+        bool stays = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+        if (!stays) {
+            st->owners[i] = st->owners[j];
+            i = j;
+        }
+    }
+    st->owners[i] = NULL;
+}
+
+/**
+ * @brief Manejador de la reserva que empieza en `granule`, o NULL.
+ */
+static Block *owner_find(size_t granule) {
+    BitmapState *st = state();
+    return st->owner_cap ? st->owners[owner_slot(granule)] : NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                              CICLO DE VIDA                                */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Reserva el mapa de bits y reúne la lista general en un bloque.
+ *
+ * @param arena_size Tamaño total de la arena.
+ * @return true si el motor quedó listo.
+ */
+bool bitmap_init(size_t arena_size) {
+    BitmapState *st = state();
+    size_t granules = arena_size / BITMAP_GRANULE;
+    size_t words = (granules + WORD_BITS - 1) / WORD_BITS;
+
+    st->bits = calloc(words ? words : 1, sizeof(uint64_t));
+    if (!st->bits) {
+        log_error("Error: calloc falló en bitmap_init()");
+        return false;
+    }
+
+    st->word_count = words;
+    st->granule_count = granules;
+    st->heap_size = arena_size;
+    st->hint = 0;
+
+    /* Bits de la última palabra que no corresponden a gránulos */
+    if (granules % WORD_BITS) {
+        st->bits[words - 1] = ~range_mask(0, (unsigned)(granules % WORD_BITS));
+    }
+
+    st->free_granules = 0;
+    for (size_t i = 0; i < words; i++) {
+        st->free_granules += (size_t)__builtin_popcountll(~st->bits[i]);
+    }
+
+    /* La lista general queda como un solo bloque libre sin indexar */
+    blocks_set_indexed(false);
+    Block *first = blocks_first();
+    while (first && first->next) {
+        block_join(first);
+    }
+
+    log_info("Motor bitmap inicializado (%zu gránulos de %d bytes)",
+             granules, BITMAP_GRANULE);
+    return true;
+}
+
+/**
+ * @brief Libera el mapa y todos los lotes de manejadores.
+ */
+void bitmap_destroy(void) {
+    BitmapState *st = state();
+    free(st->bits);
+    st->bits = NULL;
+    st->word_count = 0;
+    st->granule_count = 0;
+    st->heap_size = 0;
+    st->free_granules = 0;
+    st->hint = 0;
+
+    while (st->chunks) {
+        HandleChunk *next = st->chunks->next;
+        free(st->chunks);
+        st->chunks = next;
+    }
+    st->free_handles = NULL;
+    st->live_handles = 0;
+
+    free(st->owners);
+    st->owners = NULL;
+    st->owner_cap = 0;
+
+    blocks_set_indexed(true);
+}
+
+/* ------------------------------------------------------------------------- */
+/*                                OPERACIONES                                */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Describe la secuencia libre que usaría una reserva.
+ *
+ * @param size  Tamaño solicitado.
+ * @param align Alineación en bytes.
+ * @return Descriptor temporal, o NULL.
+ */
+Block *bitmap_find_block(size_t size, size_t align) {
+    BitmapState *st = state();
+    size_t first = find_placement(granules_for(size), align);
+    if (first == NO_RUN) return NULL;
+
+    st->scratch.offset = first * BITMAP_GRANULE;
+    st->scratch.size = run_length(first) * BITMAP_GRANULE;
+    st->scratch.requested = 0;
+    st->scratch.is_free = true;
+    return &st->scratch;
+}
+
+/**
+ * @brief Reserva gránulos con First-Fit sobre el mapa de bits.
+ *
+ * Los gránulos libres que quedan antes de una reserva alineada siguen
+ * libres en el mapa; se informan como relleno separado.
+ *
+ * @param size  Tamaño solicitado.
+ * @param align Alineación en bytes.
+ * @return Manejador ocupado, o NULL.
+ */
+Block *bitmap_alloc(size_t size, size_t align) {
+    size_t n = granules_for(size);
+    size_t first = find_placement(n, align);
+    if (first == NO_RUN) return NULL;
+
+    Block *h = handle_get();
+    if (!h) return NULL;
+
+    h->offset = first * BITMAP_GRANULE;
+    if (!owner_add(h)) {
+        handle_put(h);
+        return NULL;
+    }
+
+    set_range(first, n, true);
+
+    if (align > BITMAP_GRANULE) {
+        size_t pad = 0;
+        while (pad + 1 < align / BITMAP_GRANULE && pad < first && !granule_used(first - pad - 1)) {
+            pad++;
+        }
+        allocator_note_alignment(pad * BITMAP_GRANULE, 0);
+    }
+
+    h->size = n * BITMAP_GRANULE;
+    h->requested = size;
+    h->is_free = false;
+    h->next = NULL;
+    h->prev = NULL;
+    h->free_next = NULL;
+    h->free_prev = NULL;
+    h->slab = NULL;
+    return h;
+}
+
+/**
+ * @brief Apaga los bits del manejador y lo recicla.
+ *
+ * @param block Manejador ocupado.
+ */
+void bitmap_free(Block *block) {
+    BitmapState *st = state();
+    size_t first = block->offset / BITMAP_GRANULE;
+
+    set_range(first, block->size / BITMAP_GRANULE, false);
+    if (first / WORD_BITS < st->hint) {
+        st->hint = first / WORD_BITS;
+    }
+    owner_remove(block);
+    handle_put(block);
+}
+
+/**
+ * @brief Redimensiona en su lugar usando los gránulos siguientes.
+ *
+ * @param block    Manejador ocupado.
+ * @param new_size Nuevo tamaño solicitado.
+ * @return true si no necesita moverse.
+ */
+bool bitmap_resize(Block *block, size_t new_size) {
+    BitmapState *st = state();
+    size_t first = block->offset / BITMAP_GRANULE;
+    size_t have = block->size / BITMAP_GRANULE;
+    size_t need = granules_for(new_size);
+
+    if (need == 0) need = 1;
+
+    if (need <= have) {
+        if (need < have) {
+            set_range(first + need, have - need, false);
+            if ((first + need) / WORD_BITS < st->hint) {
+                st->hint = (first + need) / WORD_BITS;
+            }
+        }
+    } else {
+        if (!range_is_free(first + have, need - have)) return false;
+        set_range(first + have, need - have, true);
+    }
+
+    block->size = need * BITMAP_GRANULE;
+    return true;
+}
+
+/**
+ * @brief Recorre reservas y huecos en orden de offset.
+ *
+ * Los tramos se leen del mapa: los huecos se miden de a palabras como en
+ * `run_length()` y se informan con un descriptor temporal libre; cada
+ * reserva se ubica en `owners` por su gránulo inicial y su tamaño lleva al
+ * siguiente tramo. Cuesta O(palabras + reservas). El resto de la arena que
+ * no completa un gránulo se informa como parte del último hueco.
+ *
+ * @param visit Función invocada por cada segmento.
+ * @param ctx   Contexto para `visit`.
+ */
+void bitmap_walk(BlockVisitor visit, void *ctx) {
+    BitmapState *st = state();
+    Block gap = {0};
+    gap.is_free = true;
+
+    size_t g = 0;
+    while (g < st->granule_count) {
+        size_t used = granule_used(g) ? g : next_used(g);
+
+        if (used > g) {
+            gap.offset = g * BITMAP_GRANULE;
+            gap.size = (used - g) * BITMAP_GRANULE;
+            if (used == st->granule_count) {
+                gap.size = st->heap_size - gap.offset;
+            }
+            visit(&gap, ctx);
+            g = used;
+            if (g == st->granule_count) return;
+        }
+
+        Block *h = owner_find(g);
+        if (!h) {
+            log_error("bitmap_walk: el gránulo %zu está ocupado sin manejador", g);
+            return;
+        }
+        visit(h, ctx);
+        g += h->size / BITMAP_GRANULE;
+    }
+
+    if (st->granule_count * BITMAP_GRANULE < st->heap_size) {
+        gap.offset = st->granule_count * BITMAP_GRANULE;
+        gap.size = st->heap_size - gap.offset;
+        visit(&gap, ctx);
+    }
+}
+
+/**
+ * @brief Imprime ocupación del mapa y del pool de manejadores.
+ */
+void bitmap_print_stats(void) {
+    BitmapState *st = state();
+    size_t pool_chunks = 0;
+    for (HandleChunk *c = st->chunks; c; c = c->next) {
+        pool_chunks++;
+    }
+
+    printf("Gránulos libres:     %zu / %zu (%d B)\n",
+           st->free_granules, st->granule_count, BITMAP_GRANULE);
+    printf("Mapa de bits:        %zu bytes\n", st->word_count * sizeof(uint64_t));
+    printf("Manejadores vivos:   %zu (%zu lotes de %d)\n",
+           st->live_handles, pool_chunks, BITMAP_HANDLE_CHUNK);
+    printf("Tabla por offset:    %zu bytes (%zu entradas)\n",
+           st->owner_cap * sizeof(Block *), st->owner_cap);
+}
+
+/**
+ * @brief Palabras del mapa de bits y manejadores vivos.
+ *
+ * @param out Resultado.
+ */
+void bitmap_overhead(AllocOverhead *out) {
+    BitmapState *st = state();
+    out->in_arena = 0;
+    out->outside = st->word_count * sizeof(uint64_t) + st->live_handles * sizeof(Block) +
+                   st->owner_cap * sizeof(Block *);
+}
@@ -0,0 +1,267 @@
+/**
+ * @file block_table.c
+ * @brief Implementación de la tabla de bloques en arreglos paralelos.
+ *
+ * Las búsquedas no siguen punteros: cada una es una o dos reducciones
+ * (mínimo o máximo) sobre los arreglos de offsets, tamaños e indicadores,
+ * escritas sin saltos dentro del ciclo para que el compilador las vectorice.
+ * Las comparaciones son de 64 bits, así que en x86-64 hace falta un conjunto
+ * de instrucciones que las tenga (p. ej. `-O3 -march=x86-64-v3`); con SSE2
+ * quedan como ciclos escalares sin saltos. Como los offsets de la lista son
+ * únicos, el resultado de la reducción se traduce a su fila con una última
+ * pasada de igualdad.
+ *
+ * Un candidato descartado aporta SIZE_MAX a un mínimo (o 0 a un máximo)
+ * mediante una máscara, no una selección, para que GCC reconozca la
+ * reducción. Con alineación, el relleno de cada fila se calcula en la misma
+ * pasada: `(-offset) & (align - 1)`.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "block_table.h"
+#include "sim_context.h"
+
+/** @brief Filas reservadas la primera vez que crece la tabla. */
+#define BLOCK_TABLE_MIN_ROWS 64
+
+/* ------------------------------------------------------------------------- */
+/*                             ESTADO POR CONTEXTO                           */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Tabla de bloques de un contexto de simulación.
+ */
+typedef struct {
+    /** @brief Offset de cada fila. */
+    size_t *offsets;
+
+    /** @brief Tamaño de cada fila. */
+    size_t *sizes;
+
+    /** @brief 1 si el bloque de la fila está libre, 0 si está ocupado. */
+    unsigned char *free_flags;
+
+    /** @brief Nodo de la lista al que corresponde cada fila. */
+    Block **nodes;
+
+    /** @brief Filas en uso. */
+    size_t rows;
+
+    /** @brief Filas que caben en los arreglos actuales. */
+    size_t capacity;
+} BlockTableState;
+
+/** @brief Tabla de un contexto nuevo: vacía y sin arreglos. */
+static const BlockTableState initial = { 0 };
+
+/**
+ * @brief Tabla de bloques del contexto del hilo actual.
+ */
+static BlockTableState *state(void) {
+    return sim_context_state(SIM_STATE_BLOCK_TABLE, &initial, sizeof(initial));
+}
+
+/* ------------------------------------------------------------------------- */
+/*                           FUNCIONES INTERNAS                              */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Duplica la capacidad de los cuatro arreglos.
+ *
+ * Si un `realloc` falla, los arreglos ya ampliados se conservan y la
+ * capacidad no cambia.
+ *
+ * @return true si hay lugar para una fila más.
+ */
+static bool table_grow(void) {
+    BlockTableState *st = state();
+    size_t cap = st->capacity ? st->capacity * 2 : BLOCK_TABLE_MIN_ROWS;
+
+    size_t *o = realloc(st->offsets, cap * sizeof(*o));
+    if (!o) return false;
+    st->offsets = o;
+
+    size_t *s = realloc(st->sizes, cap * sizeof(*s));
+    if (!s) return false;
+    st->sizes = s;
+
+    unsigned char *f = realloc(st->free_flags, cap * sizeof(*f));
+    if (!f) return false;
+    st->free_flags = f;
+
+    Block **n = realloc(st->nodes, cap * sizeof(*n));
+    if (!n) return false;
+    st->nodes = n;
+
+    st->capacity = cap;
+    return true;
+}
+
+/**
+ * @brief Nodo de la fila con el offset indicado.
+ *
+ * @param offset Offset obtenido de una reducción, o SIZE_MAX si no hubo
+ *               candidatos.
+ * @return Nodo de esa fila, o NULL.
+ */
+static Block *row_at(size_t offset) {
+    BlockTableState *st = state();
+    if (offset == SIZE_MAX) return NULL;
+
+    for (size_t i = 0; i < st->rows; i++) {
+        if (st->offsets[i] == offset) return st->nodes[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Menor offset entre las filas libres que alojan la solicitud y
+ *        cuyo tamaño está en [lo, hi].
+ *
+ * @return El offset, o SIZE_MAX si ninguna fila califica.
+ */
+static size_t min_fitting_offset(size_t from, size_t size, size_t mask, size_t lo, size_t hi) {
+    BlockTableState *st = state();
+    size_t best = SIZE_MAX;
+
+    for (size_t i = 0; i < st->rows; i++) {
+        size_t s = st->sizes[i];
+        size_t pad = (0 - st->offsets[i]) & mask;
+        size_t ok = st->free_flags[i] & (s >= size) & (s - size >= pad) &
+                    (st->offsets[i] >= from) & (s >= lo) & (s <= hi);
+        size_t key = st->offsets[i] | (ok - 1);
+        best = key < best ? key : best;
+    }
+    return best;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                           API PÚBLICA                                     */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Libera los arreglos de la tabla.
+ */
+void block_table_clear(void) {
+    BlockTableState *st = state();
+    free(st->offsets);
+    free(st->sizes);
+    free(st->free_flags);
+    free(st->nodes);
+
+    st->offsets = NULL;
+    st->sizes = NULL;
+    st->free_flags = NULL;
+    st->nodes = NULL;
+    st->rows = 0;
+    st->capacity = 0;
+}
+
+/**
+ * @brief Agrega la fila de un bloque al final de la tabla.
+ *
+ * @param block Bloque de la lista.
+ * @return false si no hubo memoria para crecer.
+ */
+bool block_table_add(Block *block) {
+    BlockTableState *st = state();
+    if (st->rows == st->capacity && !table_grow()) {
+        return false;
+    }
+
+    block->slot = st->rows;
+    st->nodes[st->rows] = block;
+    st->rows++;
+    block_table_sync(block);
+    return true;
+}
+
+/**
+ * @brief Quita la fila de un bloque moviendo la última a su lugar.
+ *
+ * @param block Bloque con fila.
+ */
+void block_table_remove(Block *block) {
+    BlockTableState *st = state();
+    size_t slot = block->slot;
+    size_t last = --st->rows;
+
+    if (slot != last) {
+        st->offsets[slot] = st->offsets[last];
+        st->sizes[slot] = st->sizes[last];
+        st->free_flags[slot] = st->free_flags[last];
+        st->nodes[slot] = st->nodes[last];
+        st->nodes[slot]->slot = slot;
+    }
+}
+
+/**
+ * @brief Copia el estado de un bloque en su fila.
+ *
+ * @param block Bloque con fila.
+ */
+void block_table_sync(const Block *block) {
+    BlockTableState *st = state();
+    size_t slot = block->slot;
+
+    st->offsets[slot] = block->offset;
+    st->sizes[slot] = block->size;
+    st->free_flags[slot] = block->is_free;
+}
+
+/**
+ * @brief Cantidad de filas de la tabla.
+ */
+size_t block_table_rows(void) {
+    return state()->rows;
+}
+
+/**
+ * @brief First-Fit: una reducción de mínimo sobre los offsets.
+ */
+Block *block_table_first_fit(size_t from, size_t size, size_t align) {
+    return row_at(min_fitting_offset(from, size, align - 1, 0, SIZE_MAX));
+}
+
+/**
+ * @brief Best-Fit: mínimo de los tamaños que alojan la solicitud y luego
+ *        menor offset con ese tamaño.
+ */
+Block *block_table_best_fit(size_t size, size_t align) {
+    BlockTableState *st = state();
+    size_t mask = align - 1;
+    size_t best = SIZE_MAX;
+
+    for (size_t i = 0; i < st->rows; i++) {
+        size_t s = st->sizes[i];
+        size_t pad = (0 - st->offsets[i]) & mask;
+        size_t ok = st->free_flags[i] & (s >= size) & (s - size >= pad);
+        size_t key = s | (ok - 1);
+        best = key < best ? key : best;
+    }
+    if (best == SIZE_MAX) return NULL;
+
+    return row_at(min_fitting_offset(0, size, mask, best, best));
+}
+
+/**
+ * @brief Worst-Fit: máximo de los tamaños que alojan la solicitud y luego
+ *        menor offset con ese tamaño.
+ */
+Block *block_table_worst_fit(size_t size, size_t align) {
+    BlockTableState *st = state();
+    size_t mask = align - 1;
+    size_t worst = 0;
+
+    for (size_t i = 0; i < st->rows; i++) {
+        size_t s = st->sizes[i];
+        size_t pad = (0 - st->offsets[i]) & mask;
+        size_t ok = st->free_flags[i] & (s >= size) & (s - size >= pad);
+        size_t key = s & (0 - ok);
+        worst = key > worst ? key : worst;
+    }
+    if (worst == 0) return NULL;
+
+    return row_at(min_fitting_offset(0, size, mask, worst, worst));
+}
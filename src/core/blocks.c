@@ -12,18 +12,244 @@
  *
  * La estructura mantiene un puntero global al primer bloque, actuando como la
  * cabecera de la lista sobre la cual operan los algoritmos de asignación.
+ *
+ * Toda operación que cambia el estado o el tamaño de un bloque libre mantiene
+ * sincronizado el índice de `free_index.c`, de modo que los algoritmos de
+ * asignación no necesitan recorrer los bloques ocupados. Los motores que
+ * llevan sus propias listas de libres (buddy, TLSF) desactivan el índice
+ * para no pagar su costo O(log n) en cada operación.
+ *
+ * Los nodos provienen de un pool propio: lotes de BLOCK_POOL_CHUNK
+ * descriptores contiguos que se entregan en orden y una lista de reciclaje
+ * (enlazada por `free_next`) con los nodos absorbidos por fusiones. Así,
+ * dividir y fusionar bloques no llama al asignador del sistema y los nodos
+ * vecinos en la lista tienden a quedar cerca en memoria.
+ *
+ * Como alternativa al índice, `blocks_set_table()` mantiene la tabla de
+ * `block_table.c`: una fila por nodo de la lista con su offset, tamaño y
+ * estado, que se actualiza en los mismos puntos que el índice.
  */
 
 #include <stdlib.h>
 #include "blocks.h"
+#include "sim_context.h"
+#include "free_index.h"
+#include "block_table.h"
 #include "log.h"
 
-/** 
- * @brief Puntero al primer bloque de la lista doblemente enlazada.
+/**
+ * @struct NodeChunk
+ * @brief Lote de descriptores reservado con un solo `malloc`.
+ */
+typedef struct NodeChunk {
+    struct NodeChunk *next;             /**< Lote reservado anteriormente. */
+    Block nodes[BLOCK_POOL_CHUNK];      /**< Descriptores del lote. */
+} NodeChunk;
+
+/**
+ * @brief Lista de bloques de un contexto de simulación.
+ */
+typedef struct {
+    /** 
+     * @brief Puntero al primer bloque de la lista doblemente enlazada.
+     *
+     * Representa el estado inicial de la memoria simulada.
+     */
+    Block *first_block;
+
+    /**
+     * @brief Último bloque de la lista, para crecer la arena sin recorrerla.
+     */
+    Block *last_block;
+
+    /**
+     * @brief Puntero móvil de Next-Fit.
+     *
+     * Se mantiene aquí porque este módulo es el único que libera nodos; cuando
+     * un nodo desaparece, el puntero se traslada al bloque que lo absorbió.
+     */
+    Block *rover;
+
+    /**
+     * @brief Indica si el motor activo busca en el almacén de libres general.
+     *
+     * Los motores con listas propias lo desactivan con `blocks_set_indexed()`.
+     */
+    bool index_wanted;
+
+    /**
+     * @brief Indica si se eligió la tabla de bloques en lugar del índice.
+     */
+    bool table_wanted;
+
+    /**
+     * @brief Indica si el índice de `free_index.c` se está manteniendo.
+     */
+    bool index_enabled;
+
+    /**
+     * @brief Indica si la tabla de `block_table.c` se está manteniendo.
+     */
+    bool table_enabled;
+
+    /** @brief Lote más reciente del pool (cabeza de la lista de lotes). */
+    NodeChunk *chunks;
+
+    /** @brief Descriptores del lote más reciente que ya se entregaron. */
+    size_t chunk_used;
+
+    /** @brief Nodos devueltos al pool, enlazados por `free_next`. */
+    Block *spare_nodes;
+
+    /** @brief Lotes reservados. */
+    size_t chunk_count;
+
+    /** @brief Nodos en uso por la lista. */
+    size_t live_nodes;
+
+    /** @brief Divisiones realizadas desde el último `blocks_churn_reset()`. */
+    size_t split_count;
+
+    /** @brief Uniones de bloques libres desde el último `blocks_churn_reset()`. */
+    size_t join_count;
+} BlocksState;
+
+/** @brief Lista de un contexto nuevo: vacía, con el índice de libres activo. */
+static const BlocksState initial = {
+    .index_wanted = true,
+    .index_enabled = true,
+    .chunk_used = BLOCK_POOL_CHUNK
+};
+
+/**
+ * @brief Lista de bloques del contexto del hilo actual.
+ */
+static BlocksState *state(void) {
+    return sim_context_state(SIM_STATE_BLOCKS, &initial, sizeof(initial));
+}
+
+/**
+ * @brief Toma un descriptor del pool.
+ *
+ * Primero recicla nodos devueltos; si no hay, entrega el siguiente del lote
+ * actual y reserva un lote nuevo cuando se agota. También lo usan los
+ * motores que necesitan manejadores fuera de la lista.
+ *
+ * @return Descriptor sin inicializar, o NULL si `malloc` falla.
+ */
+Block *block_node_get(void) {
+    BlocksState *st = state();
+    Block *b = st->spare_nodes;
+
+    if (b) {
+        st->spare_nodes = b->free_next;
+    } else {
+        if (st->chunk_used == BLOCK_POOL_CHUNK) {
+            NodeChunk *c = malloc(sizeof(NodeChunk));
+            if (!c) return NULL;
+
+            c->next = st->chunks;
+            st->chunks = c;
+            st->chunk_used = 0;
+            st->chunk_count++;
+        }
+        b = &st->chunks->nodes[st->chunk_used++];
+    }
+
+    st->live_nodes++;
+    return b;
+}
+
+/**
+ * @brief Devuelve un descriptor al pool.
+ */
+void block_node_put(Block *b) {
+    BlocksState *st = state();
+    b->free_next = st->spare_nodes;
+    st->spare_nodes = b;
+    st->live_nodes--;
+}
+
+static void store_apply(void);
+
+/**
+ * @brief Agrega la fila de un nodo nuevo de la lista, si la tabla está activa.
+ *
+ * Si la tabla no puede crecer se abandona y se vuelve al índice.
+ */
+static void table_add(Block *block) {
+    BlocksState *st = state();
+    if (st->table_enabled && !block_table_add(block)) {
+        log_error("Error: sin memoria para la tabla de bloques; se usará el índice");
+        st->table_wanted = false;
+        store_apply();
+    }
+}
+
+/**
+ * @brief Quita la fila de un nodo que deja la lista, si la tabla está activa.
+ */
+static void table_remove(Block *block) {
+    if (state()->table_enabled) block_table_remove(block);
+}
+
+/**
+ * @brief Copia offset, tamaño y estado de un nodo a su fila, si la tabla
+ *        está activa.
+ */
+static void table_sync(const Block *block) {
+    if (state()->table_enabled) block_table_sync(block);
+}
+
+/**
+ * @brief Inserta un bloque libre en el índice, si está activo.
+ */
+static void index_insert(Block *block) {
+    if (state()->index_enabled) free_index_insert(block);
+}
+
+/**
+ * @brief Retira un bloque libre del índice, si está activo.
+ */
+static void index_remove(Block *block) {
+    if (state()->index_enabled) free_index_remove(block);
+}
+
+/**
+ * @brief Actualiza offset y tamaño de un bloque libre en el índice.
+ *
+ * Con el índice inactivo solo se modifican los campos del bloque.
+ */
+static void index_resize(Block *block, size_t offset, size_t size) {
+    if (state()->index_enabled) {
+        free_index_resize(block, offset, size);
+    } else {
+        block->offset = offset;
+        block->size = size;
+    }
+    table_sync(block);
+}
+
+/**
+ * @brief Devuelve al pool un nodo absorbido por otro bloque.
  *
- * Representa el estado inicial de la memoria simulada.
+ * Si el puntero móvil o el último bloque apuntaban al nodo liberado, pasan a
+ * apuntar al bloque que ocupa ahora su rango de memoria.
+ *
+ * @param dead Nodo que deja de existir.
+ * @param heir Bloque que absorbió el rango de `dead`.
  */
-static Block *first_block = NULL;
+static void block_release(Block *dead, Block *heir) {
+    BlocksState *st = state();
+    if (st->rover == dead) {
+        st->rover = heir;
+    }
+    if (st->last_block == dead) {
+        st->last_block = heir;
+    }
+    table_remove(dead);
+    block_node_put(dead);
+}
 
 /**
  * @brief Crea un nuevo bloque de memoria en la lista.
@@ -35,10 +261,11 @@ static Block *first_block = NULL;
  * @param size    Tamaño en bytes del bloque.
  * @param is_free Indica si el bloque está libre (true) u ocupado (false).
  *
- * @return Puntero al bloque recién creado, o NULL si malloc falla.
+ * @return Puntero al bloque recién creado, o NULL si el pool no puede crecer.
  */
 Block *block_create(size_t offset, size_t size, bool is_free) {
-    Block *b = malloc(sizeof(Block));
+    BlocksState *st = state();
+    Block *b = block_node_get();
     if (!b) {
         log_error("Error: malloc falló en block_create()");
         return NULL;
@@ -46,26 +273,119 @@ Block *block_create(size_t offset, size_t size, bool is_free) {
 
     b->offset = offset;
     b->size = size;
+    b->requested = is_free ? 0 : size;
+    b->zeroed = 0;
     b->is_free = is_free;
+    b->align_shift = 0;
+    b->slab = NULL;
 
     b->prev = NULL;
     b->next = NULL;
 
+    if (is_free) {
+        index_insert(b);
+    }
+
     /* Si no hay bloques previos, este se convierte en el primero */
-    if (first_block == NULL) {
-        first_block = b;
+    if (st->first_block == NULL) {
+        st->first_block = b;
+        st->last_block = b;
     }
 
+    table_add(b);
     return b;
 }
 
+/**
+ * @brief Cambia el tamaño de un bloque manteniendo el índice de libres.
+ *
+ * Si el bloque está libre, el cambio se propaga al índice de libres.
+ *
+ * @param block    Bloque a modificar.
+ * @param new_size Nuevo tamaño en bytes.
+ */
+static void block_resize(Block *block, size_t new_size) {
+    if (block->is_free) {
+        index_resize(block, block->offset, new_size);
+    } else {
+        block->size = new_size;
+        table_sync(block);
+    }
+}
+
+/**
+ * @brief Marca un bloque como libre y lo inserta en el índice.
+ *
+ * @param block Bloque a liberar.
+ */
+void block_mark_free(Block *block) {
+    if (!block || block->is_free) return;
+
+    block->is_free = true;
+    block->requested = 0;
+    block->zeroed = 0;
+    index_insert(block);
+    table_sync(block);
+}
+
+/**
+ * @brief Marca un bloque como ocupado y lo retira del índice.
+ *
+ * @param block Bloque a ocupar.
+ */
+void block_mark_used(Block *block) {
+    if (!block || !block->is_free) return;
+
+    index_remove(block);
+    block->is_free = false;
+    block->requested = block->size;
+    block->zeroed = 0;
+    table_sync(block);
+}
+
 /**
  * @brief Obtiene el primer bloque de la lista.
  *
  * @return Puntero al primer bloque o NULL si la lista está vacía.
  */
 Block *blocks_first(void) {
-    return first_block;
+    return state()->first_block;
+}
+
+/**
+ * @brief Obtiene el último bloque de la lista.
+ *
+ * @return Puntero al último bloque o NULL si la lista está vacía.
+ */
+Block *blocks_last(void) {
+    return state()->last_block;
+}
+
+/**
+ * @brief Agrega `extra` bytes al final de la lista tras crecer la arena.
+ *
+ * Si el último bloque está libre, crece; si no, se enlaza un bloque libre
+ * nuevo detrás de él.
+ *
+ * @param extra Bytes agregados al final de la arena.
+ * @return Bloque libre que cubre el final de la arena, o NULL si no hubo
+ *         descriptor disponible.
+ */
+Block *blocks_extend(size_t extra) {
+    Block *last = blocks_last();
+
+    if (last && last->is_free) {
+        index_resize(last, last->offset, last->size + extra);
+        return last;
+    }
+
+    Block *tail = block_create(last ? last->offset + last->size : 0, extra, true);
+    if (!tail || !last) return tail;
+
+    tail->prev = last;
+    last->next = tail;
+    state()->last_block = tail;
+    return tail;
 }
 
 /**
@@ -79,6 +399,98 @@ Block *blocks_next(Block *block) {
     return block->next;
 }
 
+/**
+ * @brief Mantiene el índice o la tabla según lo pedido por el motor y el
+ *        usuario.
+ *
+ * La estructura que se activa se reconstruye a partir de la lista; la que se
+ * desactiva se descarta. Si la tabla no puede construirse, se vuelve al
+ * índice.
+ */
+static void store_apply(void) {
+    BlocksState *st = state();
+    bool use_index = st->index_wanted && !st->table_wanted;
+    bool use_table = st->index_wanted && st->table_wanted;
+
+    if (use_index != st->index_enabled) {
+        free_index_reset();
+        st->index_enabled = use_index;
+
+        if (use_index) {
+            for (Block *b = st->first_block; b; b = b->next) {
+                if (b->is_free) free_index_insert(b);
+            }
+        }
+    }
+
+    if (use_table != st->table_enabled) {
+        block_table_clear();
+        st->table_enabled = use_table;
+
+        for (Block *b = st->first_block; use_table && b; b = b->next) {
+            if (!block_table_add(b)) {
+                log_error("Error: sin memoria para la tabla de bloques; se usará el índice");
+                block_table_clear();
+                st->table_enabled = false;
+                st->table_wanted = false;
+                store_apply();
+                return;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Activa o desactiva el mantenimiento del almacén de libres.
+ *
+ * Al activarlo se reconstruye a partir de los bloques libres actuales.
+ *
+ * @param enabled true para mantener el índice (o la tabla, si se eligió),
+ *                false para descartarlo.
+ */
+void blocks_set_indexed(bool enabled) {
+    state()->index_wanted = enabled;
+    store_apply();
+}
+
+/**
+ * @brief Elige la tabla de bloques o el índice como almacén de libres.
+ *
+ * @param enabled true para la tabla, false para el índice.
+ * @return true si el almacén pedido quedó en uso.
+ */
+bool blocks_set_table(bool enabled) {
+    BlocksState *st = state();
+    st->table_wanted = enabled;
+    store_apply();
+    return st->table_wanted == enabled;
+}
+
+/**
+ * @brief Indica si la tabla de bloques se está manteniendo.
+ */
+bool blocks_table_active(void) {
+    return state()->table_enabled;
+}
+
+/**
+ * @brief Obtiene el puntero móvil de Next-Fit.
+ *
+ * @return Bloque actual del puntero móvil, o NULL.
+ */
+Block *blocks_rover(void) {
+    return state()->rover;
+}
+
+/**
+ * @brief Establece el puntero móvil de Next-Fit.
+ *
+ * @param block Nuevo bloque de referencia.
+ */
+void blocks_set_rover(Block *block) {
+    state()->rover = block;
+}
+
 /**
  * @brief Divide un bloque en dos cuando el tamaño solicitado es menor al bloque original.
  *
@@ -95,15 +507,19 @@ void block_split(Block *block, size_t size) {
     }
 
     /* Crear bloque restante */
-    Block *rest = malloc(sizeof(Block));
+    Block *rest = block_node_get();
     if (!rest) {
         log_error("Error: malloc falló en block_split()");
         return;
     }
 
-    rest->offset  = block->offset + size;
-    rest->size    = block->size - size;
-    rest->is_free = true;
+    rest->offset    = block->offset + size;
+    rest->size      = block->size - size;
+    rest->requested = 0;
+    rest->zeroed    = 0;
+    rest->is_free   = true;
+    rest->align_shift = 0;
+    rest->slab      = NULL;
 
     /* Enlazar resto en la lista */
     rest->next = block->next;
@@ -111,12 +527,125 @@ void block_split(Block *block, size_t size) {
 
     if (block->next) {
         block->next->prev = rest;
+    } else {
+        state()->last_block = rest;
     }
 
     block->next = rest;
 
-    /* Ajustar tamaño del bloque original */
+    /* Ajustar tamaño del bloque original e indexar el resto libre */
+    block_resize(block, size);
+    index_insert(rest);
+    table_add(rest);
+    state()->split_count++;
+}
+
+/**
+ * @brief Enlaza un nodo nuevo detrás de otro, sin pasar por el índice.
+ *
+ * @param tail   Bloque que precede al nuevo.
+ * @param size   Tamaño del nuevo bloque; su offset sigue a `tail`.
+ * @param is_free Estado del nuevo bloque.
+ * @return Nodo enlazado, o NULL si el pool no puede crecer.
+ */
+static Block *link_after(Block *tail, size_t size, bool is_free) {
+    Block *b = block_node_get();
+    if (!b) {
+        log_error("Error: malloc falló en block_carve()");
+        return NULL;
+    }
+
+    b->offset    = tail->offset + tail->size;
+    b->size      = size;
+    b->requested = is_free ? 0 : size;
+    b->zeroed    = 0;
+    b->is_free   = is_free;
+    b->align_shift = 0;
+    b->slab      = NULL;
+
+    b->prev = tail;
+    b->next = tail->next;
+    if (tail->next) {
+        tail->next->prev = b;
+    } else {
+        state()->last_block = b;
+    }
+    tail->next = b;
+
+    table_add(b);
+    state()->split_count++;
+    return b;
+}
+
+/**
+ * @brief Divide un bloque libre en una corrida de bloques ocupados contiguos.
+ *
+ * El bloque sale del índice una sola vez y los nodos de la corrida se
+ * enlazan ya ocupados, sin pasar por el índice; solo el sobrante final, si
+ * queda, se indexa como bloque libre. Si el pool de nodos no puede crecer,
+ * la corrida se corta y el resto queda libre.
+ *
+ * @param block Bloque libre de al menos `size * count` bytes.
+ * @param size  Tamaño de cada bloque de la corrida.
+ * @param count Bloques de la corrida.
+ * @return Bloques reservados; el primero es `block`.
+ */
+size_t block_carve(Block *block, size_t size, size_t count) {
+    size_t end = block->offset + block->size;
+    size_t carved = 1;
+    Block *tail = block;
+
+    block_mark_used(block);
     block->size = size;
+    block->requested = size;
+    block->zeroed = 0;
+    table_sync(block);
+
+    for (Block *b; carved < count && (b = link_after(tail, size, false)); carved++) {
+        tail = b;
+    }
+
+    /* El sobrante vuelve a la lista como un único bloque libre */
+    size_t rest = end - (tail->offset + tail->size);
+    if (rest) {
+        Block *free_rest = link_after(tail, rest, true);
+        if (free_rest) {
+            index_insert(free_rest);
+        } else {
+            tail->size += rest;
+            table_sync(tail);
+        }
+    }
+    return carved;
+}
+
+/**
+ * @brief Une un bloque libre con su siguiente, también libre.
+ *
+ * El nodo siguiente se retira del índice y se libera; el bloque izquierdo
+ * crece para cubrir ambos rangos.
+ *
+ * @param left Bloque izquierdo de la unión.
+ * @return `left` tras absorber a su siguiente, o NULL si no era posible.
+ */
+Block *block_join(Block *left) {
+    if (!left || !left->is_free || !left->next || !left->next->is_free) {
+        return NULL;
+    }
+
+    Block *right = left->next;
+
+    index_remove(right);
+    block_resize(left, left->size + right->size);
+    left->next = right->next;
+
+    if (right->next) {
+        right->next->prev = left;
+    }
+
+    block_release(right, left);
+    state()->join_count++;
+    return left;
 }
 
 /**
@@ -135,34 +664,303 @@ Block *block_merge(Block *block) {
 
     /* Intento de merge con el bloque anterior */
     if (b->prev && b->prev->is_free && b->is_free) {
-        Block *prev = b->prev;
+        b = block_join(b->prev);
+    }
+
+    /* Intento de merge con el siguiente */
+    if (b->next && b->next->is_free && b->is_free) {
+        block_join(b);
+    }
+
+    return b;
+}
+
+/**
+ * @brief Une en una sola pasada todas las corridas de bloques libres contiguos.
+ *
+ * @return Uniones realizadas.
+ */
+size_t blocks_coalesce(void) {
+    size_t joins = 0;
+
+    for (Block *b = state()->first_block; b; b = b->next) {
+        while (block_join(b)) {
+            joins++;
+        }
+    }
+    return joins;
+}
+
+/**
+ * @brief Orden por offset para `blocks_release()`.
+ */
+static int compare_offset(const void *a, const void *b) {
+    const Block *x = *(Block *const *)a;
+    const Block *y = *(Block *const *)b;
+    return (x->offset > y->offset) - (x->offset < y->offset);
+}
+
+/**
+ * @brief Libera un grupo de bloques ocupados con una sola pasada de fusión.
+ *
+ * Los bloques se ordenan por offset y cada corrida de bloques contiguos del
+ * grupo se une fuera del índice, absorbiendo cada nodo en el primero de la
+ * corrida. Recién entonces la corrida se indexa, una vez, y se fusiona con
+ * sus vecinos libres. Los punteros del arreglo quedan inválidos.
+ *
+ * @param blocks Bloques ocupados de la lista; el arreglo se reordena.
+ * @param count  Cantidad de bloques.
+ */
+void blocks_release(Block **blocks, size_t count) {
+    qsort(blocks, count, sizeof(*blocks), compare_offset);
+
+    for (size_t i = 0; i < count; ) {
+        Block *run = blocks[i++];
 
-        prev->size += b->size;
-        prev->next  = b->next;
+        run->is_free = true;
+        run->requested = 0;
+        run->zeroed = 0;
+        while (i < count && run->next == blocks[i]) {
+            Block *dead = blocks[i++];
 
-        if (b->next) {
-            b->next->prev = prev;
+            run->size += dead->size;
+            run->next = dead->next;
+            if (dead->next) {
+                dead->next->prev = run;
+            }
+            block_release(dead, run);
+            state()->join_count++;
         }
 
-        free(b);
-        b = prev;
+        table_sync(run);
+        index_insert(run);
+        block_merge(run);
     }
+}
 
-    /* Intento de merge con el siguiente */
-    if (b->next && b->next->is_free && b->is_free) {
-        Block *next = b->next;
+/**
+ * @brief Expande un bloque consumiendo el inicio del bloque libre siguiente.
+ *
+ * @param block Bloque a expandir.
+ * @param extra Bytes adicionales requeridos.
+ * @return true si se expandió, false si no hay espacio contiguo suficiente.
+ */
+bool block_grow(Block *block, size_t extra) {
+    Block *next = block ? block->next : NULL;
 
-        b->size += next->size;
-        b->next  = next->next;
+    if (!next || !next->is_free || next->size < extra) {
+        return false;
+    }
 
+    if (next->size == extra) {
+        /* Tomar todo el bloque next */
+        index_remove(next);
+
+        block->next = next->next;
         if (next->next) {
-            next->next->prev = b;
+            next->next->prev = block;
         }
+        block_release(next, block);
+    } else {
+        /* Consumir parte del bloque siguiente */
+        index_resize(next, next->offset + extra, next->size - extra);
+    }
+
+    block_resize(block, block->size + extra);
+    return true;
+}
+
+/**
+ * @brief Expande un bloque ocupado hacia el bloque libre anterior y, si hace
+ *        falta, también hacia el siguiente.
+ *
+ * @param block Bloque ocupado.
+ * @param size  Tamaño requerido en bytes.
+ * @param align Alineación del nuevo offset.
+ * @return true si el bloque se desplazó y cubre `size` bytes.
+ */
+bool block_expand_back(Block *block, size_t size, size_t align) {
+    Block *prev = block->prev;
+    Block *next = block->next;
 
-        free(next);
+    if (!prev || !prev->is_free) {
+        return false;
     }
 
-    return b;
+    size_t end = block->offset + block->size;
+    if (next && next->is_free) {
+        end += next->size;
+    } else {
+        next = NULL;
+    }
+    if (end - prev->offset < size) {
+        return false;
+    }
+
+    /* Offset más alto posible: se toma lo mínimo del bloque anterior */
+    size_t offset = (end - size) & ~(align - 1);
+    if (offset < prev->offset || offset >= block->offset) {
+        return false;
+    }
+    size_t tail = end - (offset + size);
+
+    /* El anterior se reduce, o se absorbe si se usa completo */
+    if (offset == prev->offset) {
+        index_remove(prev);
+
+        block->prev = prev->prev;
+        if (prev->prev) {
+            prev->prev->next = block;
+        } else {
+            state()->first_block = block;
+        }
+        block_release(prev, block);
+    } else {
+        index_resize(prev, prev->offset, offset - prev->offset);
+    }
+
+    /* El siguiente conserva el sobrante final, o se absorbe si no queda */
+    if (next && tail == 0) {
+        index_remove(next);
+
+        block->next = next->next;
+        if (next->next) {
+            next->next->prev = block;
+        }
+        block_release(next, block);
+    } else if (next) {
+        index_resize(next, offset + size, tail);
+        tail = 0;
+    }
+
+    block->offset = offset;
+    block->size = size + tail;
+    table_sync(block);
+    return true;
+}
+
+/**
+ * @brief Registra la alineación que un bloque ocupado debe conservar.
+ *
+ * @param block Bloque ocupado.
+ * @param align Alineación en bytes (potencia de dos).
+ */
+void block_set_alignment(Block *block, size_t align) {
+    block->align_shift = (unsigned char)__builtin_ctzll(align);
+}
+
+/**
+ * @brief Enlaza un bloque al final de la lista que se está reconstruyendo.
+ *
+ * @param tail  Último bloque enlazado, o NULL si la lista está vacía.
+ * @param block Bloque a enlazar.
+ * @return `block`, el nuevo último bloque.
+ */
+static Block *compact_append(Block *tail, Block *block) {
+    block->prev = tail;
+    block->next = NULL;
+
+    if (tail) {
+        tail->next = block;
+    } else {
+        state()->first_block = block;
+    }
+    state()->last_block = block;
+    return block;
+}
+
+/**
+ * @brief Agrega al final de la lista un bloque libre de `size` bytes.
+ *
+ * Si no hay descriptor disponible, los bytes se suman al bloque ocupado
+ * anterior (quedan como fragmentación interna) para no perderlos.
+ *
+ * @param tail   Último bloque enlazado (ocupado).
+ * @param offset Inicio del rango libre.
+ * @param size   Tamaño del rango libre.
+ * @return El nuevo último bloque.
+ */
+static Block *compact_hole(Block *tail, size_t offset, size_t size) {
+    Block *hole = block_create(offset, size, true);
+    if (!hole) {
+        tail->size += size;
+        table_sync(tail);
+        return tail;
+    }
+    return compact_append(tail, hole);
+}
+
+/**
+ * @brief Desliza los bloques ocupados hacia el inicio de la arena.
+ *
+ * Los bloques libres se descartan y cada bloque ocupado pasa al primer
+ * offset disponible que respeta su alineación; el espacio restante queda
+ * en un único bloque libre al final. Los nodos ocupados conservan su
+ * identidad, así que quien guarde un `Block *` sigue siendo válido y solo
+ * ve cambiar su offset. Un bloque alineado puede dejar antes de sí un hueco
+ * libre menor que su alineación.
+ *
+ * El índice (o la tabla) queda sincronizado; las listas propias de un
+ * motor deben reconstruirse después.
+ *
+ * @param move Invocada por cada bloque que cambia de offset, ya con el
+ *             offset nuevo, para mover sus datos.
+ * @param ctx  Contexto para `move`.
+ * @return Bytes de bloques ocupados que cambiaron de lugar.
+ */
+size_t blocks_compact(BlockMover move, void *ctx) {
+    BlocksState *st = state();
+    Block *hole = st->first_block;
+    while (hole && !hole->is_free) hole = hole->next;
+
+    Block *used = hole;
+    while (used && used->is_free) used = used->next;
+
+    /* Sin bloques ocupados detrás de un hueco no hay nada que mover */
+    if (!used) return 0;
+
+    Block *b = st->first_block;
+    Block *tail = NULL;
+    size_t cursor = 0;
+    size_t end = 0;
+    size_t moved = 0;
+
+    st->first_block = NULL;
+
+    while (b) {
+        Block *next = b->next;
+        end = b->offset + b->size;
+
+        if (b->is_free) {
+            index_remove(b);
+            table_remove(b);
+            if (st->rover == b) st->rover = NULL;
+            block_node_put(b);
+        } else {
+            size_t mask = ((size_t)1 << b->align_shift) - 1;
+            size_t target = (cursor + mask) & ~mask;
+
+            if (target > cursor) {
+                tail = compact_hole(tail, cursor, target - cursor);
+            }
+            tail = compact_append(tail, b);
+
+            if (target != b->offset) {
+                size_t old = b->offset;
+                b->offset = target;
+                table_sync(b);
+                move(b, old, ctx);
+                moved += b->size;
+            }
+            cursor = target + b->size;
+        }
+        b = next;
+    }
+
+    if (cursor < end) {
+        compact_hole(tail, cursor, end - cursor);
+    }
+    return moved;
 }
 
 /**
@@ -172,11 +970,135 @@ Block *block_merge(Block *block) {
  * asociada a la estructura de administración.
  */
 void blocks_destroy(void) {
-    Block *curr = first_block;
-    while (curr) {
-        Block *next = curr->next;
-        free(curr);
-        curr = next;
+    BlocksState *st = state();
+    while (st->chunks) {
+        NodeChunk *next = st->chunks->next;
+        free(st->chunks);
+        st->chunks = next;
+    }
+    st->chunk_used = BLOCK_POOL_CHUNK;
+    st->chunk_count = 0;
+    st->spare_nodes = NULL;
+    st->live_nodes = 0;
+    blocks_churn_reset();
+
+    st->first_block = NULL;
+    st->last_block = NULL;
+    st->rover = NULL;
+    free_index_reset();
+    block_table_clear();
+}
+
+/**
+ * @brief Reconstruye la lista completa desde arreglos paralelos.
+ *
+ * Los offsets se deducen de los tamaños, porque la lista cubre la arena sin
+ * huecos. Los nodos salen del pool y se enlazan en una sola pasada. Como los
+ * libres ya llegan en orden de offset, el índice se arma de una vez con
+ * `free_index_build()` en lugar de insertarlos uno por uno; solo si no hay
+ * memoria para ello se insertan de a uno. La tabla, si está activa, recibe
+ * cada fila al enlazarla.
+ *
+ * @param count        Cantidad de bloques.
+ * @param sizes        Tamaño de cada bloque, en orden de offset.
+ * @param requested    Bytes solicitados de cada bloque (0 si está libre).
+ * @param zeroed       Bytes iniciales en cero de CALLOC de cada bloque.
+ * @param free_flags   Distinto de 0 si el bloque está libre.
+ * @param align_shifts log2 de la alineación de cada bloque.
+ * @param nodes        Recibe el nodo de cada bloque (puede ser NULL).
+ * @return true si la lista quedó armada; si no, queda vacía.
+ */
+bool blocks_restore(size_t count, const size_t *sizes, const size_t *requested,
+                    const size_t *zeroed, const unsigned char *free_flags,
+                    const unsigned char *align_shifts, Block **nodes) {
+    BlocksState *st = state();
+    Block *prev = NULL;
+    size_t offset = 0;
+    size_t free_count = 0;
+
+    if (st->first_block) {
+        log_error("blocks_restore: la lista de bloques no está vacía");
+        return false;
+    }
+
+    /* Bloques libres en orden de offset, para armar el índice de una vez */
+    Block **free_blocks = st->index_enabled ? malloc((count ? count : 1) * sizeof(Block *)) : NULL;
+
+    for (size_t i = 0; i < count; i++) {
+        Block *b = block_node_get();
+        if (!b) {
+            log_error("Error: malloc falló en blocks_restore()");
+            free(free_blocks);
+            blocks_destroy();
+            return false;
+        }
+
+        b->offset = offset;
+        b->size = sizes[i];
+        b->requested = requested[i];
+        b->zeroed = zeroed[i];
+        b->is_free = free_flags[i] != 0;
+        b->align_shift = align_shifts[i];
+        b->slab = NULL;
+        b->prev = prev;
+        b->next = NULL;
+
+        if (prev) {
+            prev->next = b;
+        } else {
+            st->first_block = b;
+        }
+        if (b->is_free && free_blocks) {
+            free_blocks[free_count++] = b;
+        } else if (b->is_free) {
+            index_insert(b);
+        }
+        table_add(b);
+
+        if (nodes) nodes[i] = b;
+        offset += b->size;
+        prev = b;
+    }
+    st->last_block = prev;
+
+    if (free_blocks && !free_index_build(free_blocks, free_count)) {
+        for (Block *b = st->first_block; b; b = b->next) {
+            if (b->is_free) index_insert(b);
+        }
     }
-    first_block = NULL;
+    free(free_blocks);
+    return true;
+}
+
+/**
+ * @brief Ocupación del pool de descriptores.
+ *
+ * @param live     Nodos en uso por la lista (puede ser NULL).
+ * @param reserved Descriptores reservados en todos los lotes (puede ser NULL).
+ */
+void blocks_pool_usage(size_t *live, size_t *reserved) {
+    BlocksState *st = state();
+    if (live) *live = st->live_nodes;
+    if (reserved) *reserved = st->chunk_count * BLOCK_POOL_CHUNK;
+}
+
+/**
+ * @brief Divisiones y uniones acumuladas.
+ *
+ * @param splits Bloques divididos (puede ser NULL).
+ * @param joins  Pares de bloques libres unidos (puede ser NULL).
+ */
+void blocks_churn(size_t *splits, size_t *joins) {
+    BlocksState *st = state();
+    if (splits) *splits = st->split_count;
+    if (joins) *joins = st->join_count;
+}
+
+/**
+ * @brief Reinicia los contadores de `blocks_churn()`.
+ */
+void blocks_churn_reset(void) {
+    BlocksState *st = state();
+    st->split_count = 0;
+    st->join_count = 0;
 }
@@ -0,0 +1,362 @@
+/**
+ * @file buddy.c
+ * @brief Implementación del motor de asignación buddy binario.
+ *
+ * Estructuras internas:
+ *  - Una lista doblemente enlazada de bloques libres por orden, enlazada con
+ *    los campos `free_next`/`free_prev` de cada bloque.
+ *  - Un mapa de bits con los órdenes que tienen bloques libres, de modo que
+ *    el orden a dividir se obtiene con una sola instrucción `ctz`.
+ *  - Un mapa `offset -> Block*` con granularidad de 2^BUDDY_MIN_ORDER bytes
+ *    que registra el inicio de cada bloque libre. Con él, el buddy de un
+ *    bloque se localiza en O(1) a partir de `offset ^ 2^k`.
+ *
+ * Reservar y liberar recorren a lo sumo un paso por orden, por lo que el
+ * peor caso es O(log N), con N el tamaño de la arena.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "buddy.h"
+#include "sim_context.h"
+#include "allocator.h"
+#include "log.h"
+
+/** @brief Cantidad de órdenes posibles (uno por bit de `size_t`). */
+#define BUDDY_ORDERS (sizeof(size_t) * 8)
+
+/* ------------------------------------------------------------------------- */
+/*                             ESTADO POR CONTEXTO                           */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Estado del motor buddy en un contexto de simulación.
+ */
+typedef struct {
+    /** @brief Cabeza de la lista de bloques libres de cada orden. */
+    Block *order_heads[BUDDY_ORDERS];
+
+    /** @brief Bit `k` encendido si la lista del orden `k` no está vacía. */
+    unsigned long long order_mask;
+
+    /** @brief Bloque libre que inicia en cada gránulo de la arena, o NULL. */
+    Block **buddy_map;
+
+    /** @brief Tamaño de la arena administrada por el motor. */
+    size_t heap_size;
+} BuddyState;
+
+/** @brief Estado de un contexto nuevo: sin listas ni mapa. */
+static const BuddyState initial = { 0 };
+
+/**
+ * @brief Estado del motor buddy en el contexto del hilo actual.
+ */
+static BuddyState *state(void) {
+    return sim_context_state(SIM_STATE_BUDDY, &initial, sizeof(initial));
+}
+
+/* ------------------------------------------------------------------------- */
+/*                           FUNCIONES AUXILIARES                            */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief floor(log2(size)); para bloques buddy es exactamente su orden.
+ */
+static unsigned floor_log2(size_t size) {
+    return (unsigned)(BUDDY_ORDERS - 1 - __builtin_clzll((unsigned long long)size));
+}
+
+/**
+ * @brief Orden mínimo cuyo tamaño 2^k contiene `size` bytes.
+ */
+static unsigned order_for(size_t size) {
+    if (size <= ((size_t)1 << BUDDY_MIN_ORDER)) return BUDDY_MIN_ORDER;
+
+    unsigned k = floor_log2(size);
+    return (size & (size - 1)) ? k + 1 : k;
+}
+
+/**
+ * @brief Inserta un bloque libre en la lista de su orden y en el mapa.
+ */
+static void order_push(Block *b, unsigned k) {
+    BuddyState *st = state();
+    b->free_prev = NULL;
+    b->free_next = st->order_heads[k];
+    if (st->order_heads[k]) {
+        st->order_heads[k]->free_prev = b;
+    }
+    st->order_heads[k] = b;
+    st->order_mask |= 1ULL << k;
+
+    st->buddy_map[b->offset >> BUDDY_MIN_ORDER] = b;
+}
+
+/**
+ * @brief Retira un bloque de la lista de su orden y del mapa.
+ */
+static void order_pop(Block *b, unsigned k) {
+    BuddyState *st = state();
+    if (b->free_prev) {
+        b->free_prev->free_next = b->free_next;
+    } else {
+        st->order_heads[k] = b->free_next;
+    }
+    if (b->free_next) {
+        b->free_next->free_prev = b->free_prev;
+    }
+    b->free_prev = NULL;
+    b->free_next = NULL;
+
+    if (!st->order_heads[k]) {
+        st->order_mask &= ~(1ULL << k);
+    }
+
+    st->buddy_map[b->offset >> BUDDY_MIN_ORDER] = NULL;
+}
+
+/**
+ * @brief Obtiene el buddy libre de orden `k` que inicia en `offset`.
+ *
+ * @return El bloque buddy si existe, está libre y tiene exactamente orden
+ *         `k`; NULL en cualquier otro caso.
+ */
+static Block *free_buddy_at(size_t offset, unsigned k) {
+    BuddyState *st = state();
+    size_t size = (size_t)1 << k;
+
+    if (offset + size > st->heap_size) return NULL;
+
+    Block *m = st->buddy_map[offset >> BUDDY_MIN_ORDER];
+    return (m && m->size == size) ? m : NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                              CICLO DE VIDA                                */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Descompone la arena en bloques potencia de dos.
+ *
+ * @param arena_size Tamaño de la arena.
+ * @return true si el motor quedó listo.
+ */
+bool buddy_init(size_t arena_size) {
+    BuddyState *st = state();
+    Block *first = blocks_first();
+
+    for (Block *b = first; b; b = b->next) {
+        if (!b->is_free) {
+            log_error("buddy: la arena debe estar vacía para activar el motor");
+            return false;
+        }
+    }
+
+    st->buddy_map = calloc((arena_size >> BUDDY_MIN_ORDER) + 1, sizeof(Block *));
+    if (!st->buddy_map) {
+        log_error("Error: calloc falló en buddy_init()");
+        return false;
+    }
+    st->heap_size = arena_size;
+    blocks_set_indexed(false);
+    st->order_mask = 0;
+    for (size_t k = 0; k < BUDDY_ORDERS; k++) {
+        st->order_heads[k] = NULL;
+    }
+
+    /* Reunir la arena en un solo bloque libre */
+    while (first && first->next) {
+        block_join(first);
+    }
+
+    /* Cada pieza es la mayor potencia de dos que cabe en el resto; como los
+     * tamaños decrecen, cada offset queda alineado a su tamaño. */
+    for (Block *b = first; b && b->size >= ((size_t)1 << BUDDY_MIN_ORDER); b = b->next) {
+        unsigned k = floor_log2(b->size);
+
+        if (b->size > ((size_t)1 << k)) {
+            block_split(b, (size_t)1 << k);
+        }
+        order_push(b, k);
+    }
+
+    log_info("Motor buddy inicializado (%zu bytes)", arena_size);
+    return true;
+}
+
+/**
+ * @brief Libera el mapa, vacía las listas por orden y reactiva el índice
+ *        general de libres.
+ */
+void buddy_destroy(void) {
+    BuddyState *st = state();
+    blocks_set_indexed(true);
+    free(st->buddy_map);
+    st->buddy_map = NULL;
+    st->heap_size = 0;
+    st->order_mask = 0;
+    for (size_t k = 0; k < BUDDY_ORDERS; k++) {
+        st->order_heads[k] = NULL;
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+/*                                OPERACIONES                                */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Orden necesario para `size` bytes alineados a `align`.
+ *
+ * Cada bloque de orden k inicia en un múltiplo de 2^k, así que basta con
+ * que 2^k alcance también la alineación.
+ */
+static unsigned order_for_aligned(size_t size, size_t align) {
+    return order_for(size > align ? size : align);
+}
+
+/**
+ * @brief Primer bloque del menor orden no vacío que contiene `size`.
+ *
+ * @param size  Tamaño solicitado.
+ * @param align Alineación en bytes.
+ * @return Bloque libre candidato, o NULL.
+ */
+Block *buddy_find_block(size_t size, size_t align) {
+    BuddyState *st = state();
+    unsigned k = order_for_aligned(size, align);
+    if (k >= BUDDY_ORDERS) return NULL;
+
+    unsigned long long pending = st->order_mask >> k;
+    if (!pending) return NULL;
+
+    return st->order_heads[k + (unsigned)__builtin_ctzll(pending)];
+}
+
+/**
+ * @brief Reserva un bloque buddy dividiendo desde el menor orden disponible.
+ *
+ * La alineación nunca deja relleno inicial; el redondeo adicional del orden
+ * que exige se contabiliza como desperdicio de alineación.
+ *
+ * @param size  Tamaño solicitado.
+ * @param align Alineación en bytes.
+ * @return Bloque ocupado de tamaño 2^k >= size, o NULL.
+ */
+Block *buddy_alloc(size_t size, size_t align) {
+    Block *b = buddy_find_block(size, align);
+    if (!b) return NULL;
+
+    unsigned k = order_for_aligned(size, align);
+    unsigned plain = order_for(size);
+
+    if (k > plain) {
+        allocator_note_alignment(0, ((size_t)1 << k) - ((size_t)1 << plain));
+    }
+    unsigned j = floor_log2(b->size);
+
+    order_pop(b, j);
+    block_mark_used(b);
+
+    /* Dividir a la mitad: la mitad superior queda libre en el orden inferior */
+    while (j > k) {
+        j--;
+        block_split(b, (size_t)1 << j);
+        order_push(b->next, j);
+    }
+
+    return b;
+}
+
+/**
+ * @brief Libera un bloque y lo fusiona con su buddy orden por orden.
+ *
+ * @param block Bloque ocupado.
+ */
+void buddy_free(Block *block) {
+    Block *b = block;
+    unsigned k = floor_log2(b->size);
+
+    block_mark_free(b);
+
+    while (k + 1 < BUDDY_ORDERS) {
+        Block *buddy = free_buddy_at(b->offset ^ ((size_t)1 << k), k);
+        if (!buddy) break;
+
+        order_pop(buddy, k);
+        if (buddy->offset < b->offset) {
+            b = buddy;
+        }
+        block_join(b);
+        k++;
+    }
+
+    order_push(b, k);
+}
+
+/**
+ * @brief Redimensiona un bloque buddy sin moverlo.
+ *
+ * @param block    Bloque ocupado.
+ * @param new_size Nuevo tamaño solicitado.
+ * @return true si el bloque cubre `new_size` en su lugar.
+ */
+bool buddy_resize(Block *block, size_t new_size) {
+    unsigned k = floor_log2(block->size);
+    unsigned t = order_for(new_size);
+
+    /* Reducir: liberar mitades superiores (su buddy es este bloque, ocupado) */
+    while (k > t) {
+        k--;
+        block_split(block, (size_t)1 << k);
+        order_push(block->next, k);
+    }
+    if (k == t) return true;
+
+    /* Crecer: en cada orden el bloque debe ser la mitad inferior y su buddy
+     * superior debe estar libre y completo */
+    for (unsigned l = k; l < t; l++) {
+        size_t half = (size_t)1 << l;
+        if ((block->offset & half) || !free_buddy_at(block->offset + half, l)) {
+            return false;
+        }
+    }
+
+    for (unsigned l = k; l < t; l++) {
+        Block *buddy = free_buddy_at(block->offset + ((size_t)1 << l), l);
+        order_pop(buddy, l);
+        block_grow(block, buddy->size);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Imprime los bloques libres de cada orden no vacío.
+ */
+void buddy_print_stats(void) {
+    BuddyState *st = state();
+    for (unsigned k = 0; k < BUDDY_ORDERS; k++) {
+        if (!(st->order_mask & (1ULL << k))) continue;
+
+        size_t n = 0;
+        for (Block *b = st->order_heads[k]; b; b = b->free_next) {
+            n++;
+        }
+        printf("Orden %2u (%6zu B):  %zu libres\n", k, (size_t)1 << k, n);
+    }
+}
+
+/**
+ * @brief Nodos de la lista y mapa `offset -> Block*` de bloques libres.
+ *
+ * @param out Resultado.
+ */
+void buddy_overhead(AllocOverhead *out) {
+    size_t live;
+    blocks_pool_usage(&live, NULL);
+
+    out->in_arena = 0;
+    out->outside = live * sizeof(Block) +
+                   ((state()->heap_size >> BUDDY_MIN_ORDER) + 1) * sizeof(Block *);
+}
@@ -0,0 +1,462 @@
+/**
+ * @file free_index.c
+ * @brief Implementación del índice de bloques libres.
+ *
+ * Cada bloque libre pertenece a dos árboles AVL intrusivos:
+ *
+ * - **Árbol por dirección:** ordenado por offset y aumentado con el tamaño
+ *   máximo de cada subárbol (`subtree_max`). First-Fit desciende hacia la
+ *   izquierda siempre que el subárbol izquierdo contenga un bloque que quepa,
+ *   por lo que encuentra el bloque de menor dirección en O(log n).
+ * - **Árbol por tamaño:** ordenado por (tamaño, offset). Best-Fit es la cota
+ *   inferior de la solicitud y Worst-Fit el máximo del árbol. Desempatar por
+ *   offset conserva la elección del bloque de menor dirección entre bloques
+ *   del mismo tamaño.
+ *
+ * Las variantes alineadas usan los mismos árboles: un bloque de tamaño
+ * >= size + align - 1 siempre aloja la solicitud, así que solo los bloques
+ * de tamaño intermedio requieren revisar el relleno de su offset.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include "avl.h"
+#include "free_index.h"
+#include "sim_context.h"
+
+/* ------------------------------------------------------------------------- */
+/*                             ESTADO POR CONTEXTO                           */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Orden del árbol por dirección: por offset.
+ */
+static int cmp_offset(const AvlNode *a, const AvlNode *b) {
+    const Block *x = AVL_ENTRY(a, Block, addr_node);
+    const Block *y = AVL_ENTRY(b, Block, addr_node);
+
+    if (x->offset != y->offset) return x->offset < y->offset ? -1 : 1;
+    return 0;
+}
+
+/**
+ * @brief Recalcula el tamaño máximo libre del subárbol de un nodo.
+ */
+static void update_subtree_max(AvlNode *node) {
+    Block *b = AVL_ENTRY(node, Block, addr_node);
+    size_t max = b->size;
+
+    if (node->left) {
+        size_t l = AVL_ENTRY(node->left, Block, addr_node)->subtree_max;
+        if (l > max) max = l;
+    }
+    if (node->right) {
+        size_t r = AVL_ENTRY(node->right, Block, addr_node)->subtree_max;
+        if (r > max) max = r;
+    }
+
+    b->subtree_max = max;
+}
+
+/**
+ * @brief Orden del árbol por tamaño: por tamaño y, a igual tamaño, por offset.
+ */
+static int cmp_size_offset(const AvlNode *a, const AvlNode *b) {
+    const Block *x = AVL_ENTRY(a, Block, size_node);
+    const Block *y = AVL_ENTRY(b, Block, size_node);
+
+    if (x->size != y->size)     return x->size < y->size ? -1 : 1;
+    if (x->offset != y->offset) return x->offset < y->offset ? -1 : 1;
+    return 0;
+}
+
+/**
+ * @brief Árboles de bloques libres de un contexto de simulación.
+ */
+typedef struct {
+    AvlTree addr_tree;  /**< Ordenado por offset, aumentado con `subtree_max`. */
+    AvlTree size_tree;  /**< Ordenado por (size, offset). */
+} FreeIndexState;
+
+/** @brief Árboles de un contexto nuevo: vacíos. */
+static const FreeIndexState initial = {
+    { NULL, cmp_offset, update_subtree_max },
+    { NULL, cmp_size_offset, NULL }
+};
+
+/**
+ * @brief Árboles del contexto del hilo actual.
+ */
+static FreeIndexState *state(void) {
+    return sim_context_state(SIM_STATE_FREE_INDEX, &initial, sizeof(initial));
+}
+
+/* ------------------------------------------------------------------------- */
+/*                           FUNCIONES AUXILIARES                            */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Tamaño libre máximo de un subárbol del árbol por dirección.
+ */
+static size_t subtree_max(const AvlNode *n) {
+    return n ? AVL_ENTRY(n, Block, addr_node)->subtree_max : 0;
+}
+
+/**
+ * @brief Menor bloque del árbol por tamaño con tamaño >= size (cota inferior).
+ *
+ * Como a igual tamaño el árbol ordena por offset, el bloque retornado es
+ * además el de menor offset entre los de su tamaño.
+ *
+ * @param size Tamaño mínimo buscado.
+ * @return Bloque encontrado, o NULL si ningún bloque alcanza el tamaño.
+ */
+static Block *size_lower_bound(size_t size) {
+    AvlNode *n = state()->size_tree.root;
+    Block *found = NULL;
+
+    while (n) {
+        Block *b = AVL_ENTRY(n, Block, size_node);
+        if (b->size >= size) {
+            found = b;
+            n = n->left;
+        } else {
+            n = n->right;
+        }
+    }
+
+    return found;
+}
+
+/**
+ * @brief Bloque de menor offset >= from que puede contener `size` bytes.
+ *
+ * Los subárboles cuyo `subtree_max` no alcanza la solicitud se descartan de
+ * inmediato, y los que quedan completamente antes de `from` nunca se
+ * visitan, por lo que el costo se mantiene en O(log n).
+ *
+ * @param n    Raíz del subárbol del árbol por dirección.
+ * @param from Offset mínimo de los candidatos.
+ * @param size Tamaño solicitado.
+ * @return Bloque encontrado, o NULL.
+ */
+static Block *first_fit_from(AvlNode *n, size_t from, size_t size, size_t align) {
+    if (!n || subtree_max(n) < size) return NULL;
+
+    Block *b = AVL_ENTRY(n, Block, addr_node);
+
+    if (b->offset < from) {
+        return first_fit_from(n->right, from, size, align);
+    }
+
+    Block *left = first_fit_from(n->left, from, size, align);
+    if (left) return left;
+
+    if (free_index_fits(b, size, align)) return b;
+
+    return first_fit_from(n->right, from, size, align);
+}
+
+/**
+ * @brief Siguiente bloque en el orden (size, offset) del árbol por tamaño.
+ */
+static Block *size_successor(const Block *prev) {
+    AvlNode *n = state()->size_tree.root;
+    Block *found = NULL;
+
+    while (n) {
+        Block *b = AVL_ENTRY(n, Block, size_node);
+        if (b->size > prev->size || (b->size == prev->size && b->offset > prev->offset)) {
+            found = b;
+            n = n->left;
+        } else {
+            n = n->right;
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief Mayor tamaño presente en el árbol que es estrictamente menor a `size`.
+ *
+ * @return Un bloque con ese tamaño, o NULL.
+ */
+static Block *size_below(size_t size) {
+    AvlNode *n = state()->size_tree.root;
+    Block *found = NULL;
+
+    while (n) {
+        Block *b = AVL_ENTRY(n, Block, size_node);
+        if (b->size < size) {
+            found = b;
+            n = n->right;
+        } else {
+            n = n->left;
+        }
+    }
+    return found;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                          MANTENIMIENTO DEL ÍNDICE                         */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Vacía ambos árboles del índice.
+ */
+void free_index_reset(void) {
+    FreeIndexState *st = state();
+    st->addr_tree.root = NULL;
+    st->size_tree.root = NULL;
+}
+
+/**
+ * @brief Orden (tamaño, offset) para armar el árbol por tamaño.
+ */
+static int compare_size_offset(const void *a, const void *b) {
+    const Block *x = *(Block *const *)a;
+    const Block *y = *(Block *const *)b;
+
+    if (x->size != y->size) return x->size < y->size ? -1 : 1;
+    return (x->offset > y->offset) - (x->offset < y->offset);
+}
+
+/**
+ * @brief Arma ambos árboles de una vez a partir de bloques en orden de offset.
+ *
+ * El árbol por dirección se arma directamente en O(n); para el árbol por
+ * tamaño los bloques se ordenan una vez por (tamaño, offset) y se arma
+ * igual, sin rebalanceos.
+ *
+ * @param blocks Bloques libres en orden de offset; el arreglo se reordena.
+ * @param count  Cantidad de bloques.
+ * @return false si no hubo memoria (el índice queda vacío).
+ */
+bool free_index_build(Block **blocks, size_t count) {
+    FreeIndexState *st = state();
+    AvlNode **nodes = malloc((count ? count : 1) * sizeof(AvlNode *));
+
+    free_index_reset();
+    if (!nodes) return false;
+
+    for (size_t i = 0; i < count; i++) {
+        nodes[i] = &blocks[i]->addr_node;
+    }
+    avl_build(&st->addr_tree, nodes, count);
+
+    qsort(blocks, count, sizeof(*blocks), compare_size_offset);
+    for (size_t i = 0; i < count; i++) {
+        nodes[i] = &blocks[i]->size_node;
+    }
+    avl_build(&st->size_tree, nodes, count);
+
+    free(nodes);
+    return true;
+}
+
+/**
+ * @brief Inserta un bloque libre en ambos árboles.
+ *
+ * @param block Bloque libre a indexar.
+ */
+void free_index_insert(Block *block) {
+    FreeIndexState *st = state();
+    avl_insert(&st->addr_tree, &block->addr_node);
+    avl_insert(&st->size_tree, &block->size_node);
+}
+
+/**
+ * @brief Retira un bloque de ambos árboles.
+ *
+ * @param block Bloque indexado a retirar.
+ */
+void free_index_remove(Block *block) {
+    FreeIndexState *st = state();
+    avl_remove(&st->addr_tree, &block->addr_node);
+    avl_remove(&st->size_tree, &block->size_node);
+}
+
+/**
+ * @brief Cambia offset y tamaño de un bloque indexado.
+ *
+ * En el árbol por tamaño la clave cambia, así que el bloque se reinserta.
+ * En el árbol por dirección su posición relativa se conserva (los bloques
+ * libres no se solapan), por lo que basta con recalcular `subtree_max` en el
+ * camino desde la raíz, sin rotaciones.
+ *
+ * @param block  Bloque libre indexado.
+ * @param offset Nuevo offset.
+ * @param size   Nuevo tamaño.
+ */
+void free_index_resize(Block *block, size_t offset, size_t size) {
+    FreeIndexState *st = state();
+    avl_remove(&st->size_tree, &block->size_node);
+
+    block->offset = offset;
+    block->size = size;
+
+    avl_refresh(&st->addr_tree, &block->addr_node);
+    avl_insert(&st->size_tree, &block->size_node);
+}
+
+/* ------------------------------------------------------------------------- */
+/*                                BÚSQUEDAS                                  */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief First-Fit sobre el índice.
+ *
+ * Desciende por el árbol por dirección: si el subárbol izquierdo contiene un
+ * bloque suficientemente grande se continúa por él; si no, se evalúa el nodo
+ * actual y finalmente el subárbol derecho.
+ *
+ * @param size Tamaño solicitado en bytes.
+ * @return Bloque libre de menor offset que puede contener la solicitud.
+ */
+Block *free_index_first_fit(size_t size) {
+    AvlNode *n = state()->addr_tree.root;
+
+    if (subtree_max(n) < size) return NULL;
+
+    while (n) {
+        Block *b = AVL_ENTRY(n, Block, addr_node);
+
+        if (n->left && subtree_max(n->left) >= size) {
+            n = n->left;
+        } else if (b->size >= size) {
+            return b;
+        } else {
+            n = n->right;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief First-Fit restringido a offsets >= from (base de Next-Fit).
+ *
+ * @param from Offset mínimo de los candidatos.
+ * @param size Tamaño solicitado en bytes.
+ * @return Bloque libre de menor offset >= from que puede contener la solicitud.
+ */
+Block *free_index_first_fit_from(size_t from, size_t size) {
+    return first_fit_from(state()->addr_tree.root, from, size, 1);
+}
+
+/**
+ * @brief Best-Fit sobre el índice.
+ *
+ * Cota inferior de la solicitud en el árbol ordenado por tamaño.
+ *
+ * @param size Tamaño solicitado en bytes.
+ * @return Bloque libre más ajustado a la solicitud.
+ */
+Block *free_index_best_fit(size_t size) {
+    return size_lower_bound(size);
+}
+
+/**
+ * @brief Worst-Fit sobre el índice.
+ *
+ * Se toma el tamaño máximo del árbol y luego su cota inferior, que es el
+ * bloque de ese tamaño con menor offset.
+ *
+ * @param size Tamaño solicitado en bytes.
+ * @return Bloque libre más grande, o NULL si ni siquiera este cabe.
+ */
+Block *free_index_worst_fit(size_t size) {
+    AvlNode *max = avl_max(&state()->size_tree);
+    if (!max) return NULL;
+
+    Block *largest = AVL_ENTRY(max, Block, size_node);
+    if (largest->size < size) return NULL;
+
+    return size_lower_bound(largest->size);
+}
+
+/* ------------------------------------------------------------------------- */
+/*                          BÚSQUEDAS ALINEADAS                              */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Relleno para llevar `offset` al siguiente múltiplo de `align`.
+ *
+ * @param offset Offset original.
+ * @param align  Alineación (potencia de dos).
+ * @return Bytes de relleno (0 si ya está alineado).
+ */
+size_t free_index_align_pad(size_t offset, size_t align) {
+    return (align - (offset & (align - 1))) & (align - 1);
+}
+
+/**
+ * @brief Indica si un bloque aloja `size` bytes a partir de un offset alineado.
+ *
+ * @param block Bloque libre.
+ * @param size  Tamaño solicitado.
+ * @param align Alineación.
+ * @return true si cabe con su relleno.
+ */
+bool free_index_fits(const Block *block, size_t size, size_t align) {
+    if (block->size < size) return false;
+    return align <= 1 || block->size - size >= free_index_align_pad(block->offset, align);
+}
+
+/**
+ * @brief First-Fit alineado sobre el árbol por dirección.
+ *
+ * Los subárboles se descartan por `subtree_max` como en First-Fit; en los
+ * nodos restantes se revisa además el relleno.
+ *
+ * @param from  Offset mínimo.
+ * @param size  Tamaño solicitado.
+ * @param align Alineación.
+ * @return Bloque encontrado, o NULL.
+ */
+Block *free_index_first_fit_aligned(size_t from, size_t size, size_t align) {
+    return first_fit_from(state()->addr_tree.root, from, size, align);
+}
+
+/**
+ * @brief Best-Fit alineado: recorre el árbol por tamaño desde la cota
+ *        inferior hasta el primer bloque que aloja la solicitud.
+ *
+ * El recorrido termina a más tardar en el primer bloque de tamaño
+ * >= size + align - 1.
+ *
+ * @param size  Tamaño solicitado.
+ * @param align Alineación.
+ * @return Bloque encontrado, o NULL.
+ */
+Block *free_index_best_fit_aligned(size_t size, size_t align) {
+    Block *b = size_lower_bound(size);
+
+    while (b && !free_index_fits(b, size, align)) {
+        b = size_successor(b);
+    }
+    return b;
+}
+
+/**
+ * @brief Worst-Fit alineado: recorre los tamaños de mayor a menor y, dentro
+ *        de cada tamaño, los bloques de menor a mayor offset.
+ *
+ * @param size  Tamaño solicitado.
+ * @param align Alineación.
+ * @return Bloque encontrado, o NULL.
+ */
+Block *free_index_worst_fit_aligned(size_t size, size_t align) {
+    Block *group = free_index_worst_fit(size);
+
+    while (group) {
+        for (Block *b = group; b && b->size == group->size; b = size_successor(b)) {
+            if (free_index_fits(b, size, align)) return b;
+        }
+
+        Block *smaller = size_below(group->size);
+        if (!smaller || smaller->size < size) return NULL;
+        group = size_lower_bound(smaller->size);
+    }
+    return NULL;
+}
@@ -4,9 +4,31 @@
  *
  * Este módulo gestiona la creación, destrucción y acceso a la arena principal
  * de memoria utilizada por el simulador. La arena consiste en un único bloque
- * grande solicitado al sistema operativo mediante `malloc()`. A partir de este
- * bloque se administran estructuras lógicas de bloques mediante la lista
- * implementada en `blocks.c`.
+ * grande solicitado al sistema operativo mediante un `mmap()` anónimo. A partir
+ * de este bloque se administran estructuras lógicas de bloques mediante la
+ * lista implementada en `blocks.c`.
+ *
+ * Las páginas de un mapeo anónimo nuevo ya están en cero y el kernel solo las
+ * respalda cuando se tocan, así que crear la arena no cuesta tiempo ni memoria
+ * residente proporcionales a su tamaño nominal: se pueden simular arenas de
+ * decenas de GB. Opcionalmente se evita reservar swap (`MAP_NORESERVE`) y se
+ * piden páginas enormes, explícitas (`MAP_HUGETLB`) o transparentes
+ * (`madvise(MADV_HUGEPAGE)`).
+ *
+ * La arena puede crecer como un heap con `sbrk`: al iniciar se reserva sin
+ * permisos un rango virtual hasta el límite de crecimiento y, cuando una
+ * reserva no cabe, `memory_grow()` habilita más páginas al final según la
+ * política elegida (exacta, en pasos fijos o duplicando). Como el rango no
+ * se mueve, los punteros a la arena siguen siendo válidos.
+ *
+ * Un mapa de bits, uno por página, recuerda qué páginas pudieron escribirse
+ * desde que se mapearon en cero. `memory_zero()` (CALLOC) solo limpia las
+ * páginas marcadas y las que cubre completas vuelven a quedar limpias (si
+ * escribió los ceros; con PAYLOAD none siguen marcadas). El
+ * mapa cubre de entrada todo el rango reservado (en otro mapeo anónimo, que
+ * tampoco ocupa memoria hasta tocarse), así que crecer la arena no lo mueve
+ * y sus bits se actualizan con operaciones atómicas: los hilos que comparten
+ * el heap marcan páginas de sus bloques sin tomar el cerrojo.
  *
  * Responsabilidades principales:
  *  - Inicializar la arena de memoria.
@@ -15,50 +37,230 @@
  *  - Proveer acceso al primer bloque lógico de la lista de bloques.
  */
 
+#define _DEFAULT_SOURCE
+
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "memory.h"
+#include "sim_context.h"
 #include "blocks.h"
+#include "allocator.h"
+#include "slab.h"
 #include "log.h"
 
 /**
- * @brief Puntero a la arena real de memoria simulada.
+ * @brief Arena de un contexto de simulación.
+ */
+typedef struct {
+    /**
+     * @brief Puntero a la arena real de memoria simulada.
+     *
+     * Este bloque grande es solicitado al sistema operativo solo una vez al
+     * inicio mediante `mmap()` y posteriormente simulado como si fuera nuestro
+     * "heap".
+     */
+    void *arena;
+
+    /**
+     * @brief Tamaño total de la arena de memoria en bytes.
+     */
+    size_t arena_size;
+
+    /**
+     * @brief Longitud del rango virtual reservado para la arena.
+     *
+     * Es el límite de crecimiento (redondeado a páginas); con `MAP_HUGETLB` es
+     * el tamaño inicial redondeado a páginas enormes.
+     */
+    size_t reserve_size;
+
+    /**
+     * @brief Bytes del rango reservado con permisos de lectura y escritura
+     *        (el tamaño de la arena redondeado a páginas).
+     */
+    size_t commit_size;
+
+    /** @brief Tamaño de página del sistema. */
+    size_t page_size;
+
+    /** @brief Límite de crecimiento pedido para la próxima `memory_init_flags()`. */
+    size_t limit_wanted;
+
+    /** @brief Política de crecimiento y contadores. */
+    MemoryGrowthStats growth;
+
+    /**
+     * @brief Un bit por página de la arena, en 1 si la página pudo
+     *        escribirse desde que se mapeó en cero.
+     *
+     * Sin mapa (NULL) todas las páginas se consideran escritas.
+     */
+    uint64_t *dirty;
+
+    /** @brief Palabras de `dirty` (cubren todo el rango reservado). */
+    size_t dirty_words;
+} MemoryState;
+
+/** @brief Arena de un contexto nuevo: sin mapear. */
+static const MemoryState initial = {
+    .limit_wanted = MEMORY_DEFAULT_LIMIT,
+    .growth = { MEMORY_GROW_OFF, 0, 0, 0, 0 }
+};
+
+/**
+ * @brief Arena del contexto del hilo actual.
+ */
+static MemoryState *state(void) {
+    return sim_context_state(SIM_STATE_MEMORY, &initial, sizeof(initial));
+}
+
+/** @brief Tamaño de página enorme supuesto para redondear el mapeo. */
+#define HUGE_PAGE_SIZE ((size_t)2 << 20)
+
+/**
+ * @brief Redondea `size` hacia arriba a un múltiplo de `unit` (potencia de dos).
+ */
+static size_t round_up(size_t size, size_t unit) {
+    return (size + unit - 1) & ~(unit - 1);
+}
+
+/**
+ * @brief Crea el mapa de páginas escritas para todo el rango reservado.
  *
- * Este bloque grande es solicitado al sistema operativo solo una vez al inicio
- * mediante `malloc()` y posteriormente simulado como si fuera nuestro "heap".
+ * El mapa es un mapeo anónimo, en cero (páginas limpias), que no cambia de
+ * lugar mientras la arena crece. Las páginas de los primeros `size` bytes
+ * quedan marcadas según `dirty`. Si no se puede mapear, todas las páginas
+ * se consideran escritas.
+ *
+ * @param st    Arena del contexto actual.
+ * @param size  Tamaño inicial de la arena.
+ * @param dirty true si las páginas iniciales pueden tener datos.
  */
-static void *arena = NULL;
+static void dirty_map_create(MemoryState *st, size_t size, bool dirty) {
+    size_t pages = (st->reserve_size + st->page_size - 1) / st->page_size;
+    size_t words = (pages + 63) / 64;
+
+    void *map = mmap(NULL, (words ? words : 1) * sizeof(uint64_t), PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (map == MAP_FAILED) {
+        log_error("Sin memoria para el mapa de páginas; CALLOC limpiará todo el rango");
+        st->dirty = NULL;
+        st->dirty_words = 0;
+        return;
+    }
+    st->dirty = map;
+    st->dirty_words = words ? words : 1;
+    if (dirty) {
+        pages = (size + st->page_size - 1) / st->page_size;
+        memset(st->dirty, 0xff, (pages + 63) / 64 * sizeof(uint64_t));
+    }
+}
 
 /**
- * @brief Tamaño total de la arena de memoria en bytes.
+ * @brief Crea el mapeo anónimo que respalda la arena.
+ *
+ * Reserva sin permisos el rango virtual hasta el límite de crecimiento y
+ * habilita solo las páginas del tamaño inicial; si el sistema no admite
+ * una reserva tan grande, se reserva solo el tamaño inicial. Si no hay
+ * páginas enormes explícitas disponibles, se reintenta con páginas normales.
+ *
+ * @param size  Tamaño de la arena en bytes.
+ * @param flags Combinación de `MEMORY_NORESERVE`, `MEMORY_HUGETLB` y `MEMORY_THP`.
+ * @return Inicio del mapeo, o NULL si el sistema lo rechazó.
  */
-static size_t arena_size = 0;
+static void *arena_map(size_t size, unsigned flags) {
+    MemoryState *st = state();
+    int mmap_flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    void *p = MAP_FAILED;
+
+    if (flags & MEMORY_NORESERVE) {
+        mmap_flags |= MAP_NORESERVE;
+    }
+
+#ifdef MAP_HUGETLB
+    /* Sin MAP_NORESERVE: así el mapeo falla si faltan páginas enormes, en
+     * lugar de provocar SIGBUS al tocar la arena. Las páginas enormes se
+     * reservan completas al mapear, así que la arena no puede crecer más
+     * allá del redondeo. */
+    if (flags & MEMORY_HUGETLB) {
+        st->reserve_size = round_up(size, HUGE_PAGE_SIZE);
+        p = mmap(NULL, st->reserve_size, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            st->commit_size = st->reserve_size;
+            return p;
+        }
+        log_info("Sin páginas enormes disponibles; la arena usa páginas normales");
+    }
+#endif
+
+    st->commit_size = round_up(size, st->page_size);
+    st->reserve_size = round_up(st->limit_wanted > size ? st->limit_wanted : size, st->page_size);
+    p = mmap(NULL, st->reserve_size, PROT_NONE, mmap_flags, -1, 0);
+    if (p == MAP_FAILED && st->reserve_size > st->commit_size) {
+        log_info("No se pudo reservar %zu bytes; la arena no podrá crecer", st->reserve_size);
+        st->reserve_size = st->commit_size;
+        p = mmap(NULL, st->reserve_size, PROT_NONE, mmap_flags, -1, 0);
+    }
+    if (p == MAP_FAILED) return NULL;
+
+    if (mprotect(p, st->commit_size, PROT_READ | PROT_WRITE) != 0) {
+        munmap(p, st->reserve_size);
+        return NULL;
+    }
+
+#ifdef MADV_HUGEPAGE
+    if ((flags & MEMORY_THP) && madvise(p, st->reserve_size, MADV_HUGEPAGE) != 0) {
+        log_info("El kernel no admite páginas enormes transparentes para la arena");
+    }
+#endif
+    return p;
+}
+
+/**
+ * @brief Inicializa la arena de memoria del simulador con páginas normales.
+ *
+ * @param size Tamaño total (en bytes) que tendrá la arena simulada.
+ */
+void memory_init(size_t size) {
+    memory_init_flags(size, 0);
+}
 
 /**
  * @brief Inicializa la arena de memoria del simulador.
  *
- * Solicita un bloque grande al sistema operativo, lo rellena con ceros y crea
- * el bloque inicial libre que representa toda la memoria disponible.  
+ * Mapea la arena (ya en cero, sin tocar sus páginas) y crea el bloque inicial
+ * libre que representa toda la memoria disponible.
  *  
  * Esta función **solo debe llamarse una vez** por ejecución. Si se invoca más
  * de una vez sin haber llamado antes a `memory_destroy()`, se registra un error.
  *
- * @param size Tamaño total (en bytes) que tendrá la arena simulada.
+ * @param size  Tamaño total (en bytes) que tendrá la arena simulada.
+ * @param flags Opciones `MEMORY_*` del mapeo.
  */
-void memory_init(size_t size) {
-    if (arena != NULL) {
+void memory_init_flags(size_t size, unsigned flags) {
+    MemoryState *st = state();
+    if (st->arena != NULL) {
         log_error("memory_init() llamado dos veces sin destroy()");
         return;
     }
 
-    arena = malloc(size);
-    if (!arena) {
+    st->page_size = (size_t)sysconf(_SC_PAGESIZE);
+    st->arena = size ? arena_map(size, flags) : NULL;
+    if (!st->arena) {
         log_error("Error: no se pudo asignar arena de %zu bytes", size);
         exit(1);
     }
 
-    arena_size = size;
-    memset(arena, 0, size);
+    st->arena_size = size;
+    st->growth.initial = size;
+    st->growth.limit = st->reserve_size;
+    st->growth.grows = 0;
+    dirty_map_create(st, size, false);
 
     // Crear bloque inicial libre
     Block *initial = block_create(0, size, true);
@@ -71,22 +273,251 @@ void memory_init(size_t size) {
     log_info("Arena inicializada (%zu bytes)", size);
 }
 
+/**
+ * @brief Copia `size` bytes de un archivo a la arena con `pread`.
+ *
+ * @return true si se leyeron todos los bytes.
+ */
+static bool arena_read(int fd, size_t offset, size_t size) {
+    unsigned char *dst = state()->arena;
+
+    while (size > 0) {
+        ssize_t got = pread(fd, dst, size, (off_t)offset);
+        if (got <= 0) return false;
+        dst += got;
+        offset += (size_t)got;
+        size -= (size_t)got;
+    }
+    return true;
+}
+
+/**
+ * @brief Inicializa la arena con el contenido de un archivo.
+ *
+ * Reserva el rango como `memory_init_flags()` y luego mapea encima, con
+ * `MAP_FIXED`, las páginas del archivo. Así restaurar una arena grande no
+ * lee ni copia nada por adelantado.
+ *
+ * @param size   Tamaño de la arena.
+ * @param fd     Archivo con el contenido.
+ * @param offset Posición del contenido en el archivo.
+ * @return true si la arena quedó inicializada.
+ */
+bool memory_init_image(size_t size, int fd, size_t offset) {
+    MemoryState *st = state();
+    struct stat info;
+
+    if (st->arena != NULL) {
+        log_error("memory_init_image() llamado sin destroy()");
+        return false;
+    }
+    if (size == 0 || fstat(fd, &info) != 0) {
+        log_error("Error: no se pudo leer la arena del archivo");
+        return false;
+    }
+
+    st->page_size = (size_t)sysconf(_SC_PAGESIZE);
+    st->arena = arena_map(size, 0);
+    if (!st->arena) {
+        log_error("Error: no se pudo asignar arena de %zu bytes", size);
+        return false;
+    }
+
+    bool mapped = offset % st->page_size == 0 &&
+                  (size_t)info.st_size >= offset + st->commit_size &&
+                  mmap(st->arena, st->commit_size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_FIXED, fd, (off_t)offset) != MAP_FAILED;
+    if (!mapped && !arena_read(fd, offset, size)) {
+        log_error("Error: no se pudo leer la arena del archivo");
+        munmap(st->arena, st->reserve_size);
+        st->arena = NULL;
+        return false;
+    }
+
+    st->arena_size = size;
+    st->growth.initial = size;
+    st->growth.limit = st->reserve_size;
+    st->growth.grows = 0;
+    dirty_map_create(st, size, true);
+    return true;
+}
+
 /**
  * @brief Libera completamente la arena de memoria.
  *
  * Esta función libera el bloque asignado por `memory_init()`, restablece
- * punteros y tamaños, y prepara al módulo para un uso futuro.
- *
- * Nota: La liberación de la lista de bloques se implementará en fases posteriores.
+ * punteros y tamaños, y prepara al módulo para un uso futuro. También libera
+ * la lista de bloques, la capa slab y el estado interno del algoritmo de
+ * asignación.
  */
 void memory_destroy(void) {
-    if (arena) {
-        free(arena);
-        arena = NULL;
-        arena_size = 0;
+    MemoryState *st = state();
+    slab_destroy();
+    allocator_shutdown();
+    blocks_destroy();
+
+    if (st->arena) {
+        munmap(st->arena, st->reserve_size);
+        st->arena = NULL;
+        st->arena_size = 0;
+        st->reserve_size = 0;
+        st->commit_size = 0;
+    }
+    if (st->dirty) {
+        munmap(st->dirty, st->dirty_words * sizeof(uint64_t));
+    }
+    st->dirty = NULL;
+    st->dirty_words = 0;
+}
+
+/**
+ * @brief Fija el límite de crecimiento de la próxima arena.
+ *
+ * @param limit Tamaño máximo en bytes.
+ */
+void memory_set_limit(size_t limit) {
+    state()->limit_wanted = limit;
+}
+
+/**
+ * @brief Elige cuánto crece la arena cuando una reserva no cabe.
+ *
+ * @param policy Política de crecimiento.
+ * @param step   Bytes por paso con `MEMORY_GROW_STEP`.
+ */
+void memory_set_growth(MemoryGrowth policy, size_t step) {
+    MemoryState *st = state();
+    st->growth.policy = policy;
+    st->growth.step = step;
+}
+
+/**
+ * @brief Hace crecer la arena al menos `need` bytes según la política.
+ *
+ * Las páginas nuevas del rango reservado reciben permisos de lectura y
+ * escritura; como nunca se tocaron, siguen en cero y sin memoria física, y
+ * el mapa de páginas ya las cubre como limpias.
+ *
+ * @param need Bytes adicionales que necesita la reserva.
+ * @return true si la arena creció.
+ */
+bool memory_grow(size_t need) {
+    MemoryState *st = state();
+    if (!st->arena || st->growth.policy == MEMORY_GROW_OFF || need == 0) return false;
+
+    size_t room = st->reserve_size - st->arena_size;
+    if (need > room) {
+        log_error("La arena no puede crecer %zu bytes (límite %zu bytes)", need, st->reserve_size);
+        return false;
+    }
+
+    size_t extra = need;
+    if (st->growth.policy == MEMORY_GROW_STEP && st->growth.step) {
+        extra = (need + st->growth.step - 1) / st->growth.step * st->growth.step;
+    } else if (st->growth.policy == MEMORY_GROW_DOUBLE && st->arena_size > need) {
+        extra = st->arena_size;
     }
+    if (extra > room) extra = room;
 
-    // En FASE 3 agregaremos limpieza de lista de bloques
+    size_t commit = round_up(st->arena_size + extra, st->page_size);
+    if (commit > st->commit_size) {
+        if (mprotect((unsigned char *)st->arena + st->commit_size, commit - st->commit_size,
+                     PROT_READ | PROT_WRITE) != 0) {
+            log_error("No se pudo habilitar la memoria para crecer la arena");
+            return false;
+        }
+        st->commit_size = commit;
+    }
+
+    log_info("Arena: %zu -> %zu bytes", st->arena_size, st->arena_size + extra);
+    st->arena_size += extra;
+    st->growth.grows++;
+    return true;
+}
+
+/**
+ * @brief Política de crecimiento y crecimientos realizados.
+ *
+ * @return Puntero de solo lectura al estado interno.
+ */
+const MemoryGrowthStats *memory_growth(void) {
+    return &state()->growth;
+}
+
+/**
+ * @brief Indica si una página pudo escribirse desde que se mapeó.
+ */
+static bool page_dirty(const MemoryState *st, size_t page) {
+    return !st->dirty || (__atomic_load_n(&st->dirty[page / 64], __ATOMIC_RELAXED) >> (page % 64)) & 1;
+}
+
+/**
+ * @brief Registra que un rango de la arena pudo dejar de estar en cero.
+ *
+ * @param offset Inicio del rango.
+ * @param size   Bytes del rango.
+ */
+void memory_mark_dirty(size_t offset, size_t size) {
+    MemoryState *st = state();
+    if (!st->dirty || size == 0) return;
+
+    size_t last = (offset + size - 1) / st->page_size;
+
+    for (size_t p = offset / st->page_size; p <= last;) {
+        if (p % 64 == 0 && last - p >= 63) {
+            __atomic_store_n(&st->dirty[p / 64], UINT64_MAX, __ATOMIC_RELAXED);
+            p += 64;
+        } else {
+            __atomic_fetch_or(&st->dirty[p / 64], (uint64_t)1 << (p % 64), __ATOMIC_RELAXED);
+            p++;
+        }
+    }
+}
+
+/**
+ * @brief Pone en cero las páginas marcadas de un rango de la arena.
+ *
+ * Las palabras del mapa sin páginas marcadas se saltean de a 64 páginas, y
+ * las páginas marcadas consecutivas se limpian con un solo `memset`.
+ *
+ * @param offset Inicio del rango.
+ * @param size   Bytes del rango.
+ * @param write  true para escribir los ceros.
+ * @return Bytes que hubo que limpiar.
+ */
+size_t memory_zero(size_t offset, size_t size, bool write) {
+    MemoryState *st = state();
+    unsigned char *arena = st->arena;
+    size_t ps = st->page_size;
+    size_t end = offset + size;
+    size_t zeroed = 0;
+    size_t run_lo = 0, run_hi = 0;  /* Rango sucio pendiente de limpiar */
+
+    for (size_t p = offset / ps; p * ps < end; p++) {
+        if (st->dirty && __atomic_load_n(&st->dirty[p / 64], __ATOMIC_RELAXED) == 0) {
+            p |= 63;
+            continue;
+        }
+        if (!page_dirty(st, p)) continue;
+
+        size_t lo = p * ps > offset ? p * ps : offset;
+        size_t hi = (p + 1) * ps < end ? (p + 1) * ps : end;
+        if (lo != run_hi) {
+            if (write) memset(arena + run_lo, 0, run_hi - run_lo);
+            run_lo = lo;
+        }
+        run_hi = hi;
+        zeroed += hi - lo;
+
+        /* Cubierta completa (los bytes tras el final de la arena nunca se
+         * escriben): la página vuelve a estar en cero, si de verdad se
+         * escribieron los ceros */
+        if (write && st->dirty && lo == p * ps && (hi == (p + 1) * ps || hi >= st->arena_size)) {
+            __atomic_fetch_and(&st->dirty[p / 64], ~((uint64_t)1 << (p % 64)), __ATOMIC_RELAXED);
+        }
+    }
+    if (write) memset(arena + run_lo, 0, run_hi - run_lo);
+    return zeroed;
 }
 
 /**
@@ -95,7 +526,43 @@ void memory_destroy(void) {
  * @return Puntero a la arena, o NULL si no ha sido inicializada.
  */
 void *memory_arena(void) {
-    return arena;
+    return state()->arena;
+}
+
+/**
+ * @brief Devuelve el tamaño total de la arena simulada.
+ *
+ * @return Tamaño de la arena en bytes, o 0 si no ha sido inicializada.
+ */
+size_t memory_size(void) {
+    return state()->arena_size;
+}
+
+/**
+ * @brief Bytes de la arena respaldados por memoria física en este momento.
+ *
+ * Consulta con `mincore()` qué páginas habilitadas del mapeo están residentes.
+ *
+ * @return Bytes residentes, o 0 si no se pudo consultar.
+ */
+size_t memory_resident(void) {
+    MemoryState *st = state();
+    if (!st->arena) return 0;
+
+    size_t pages = st->commit_size / st->page_size;
+    unsigned char *vec = malloc(pages);
+    if (!vec) return 0;
+
+    size_t resident = 0;
+    if (mincore(st->arena, st->commit_size, vec) == 0) {
+        for (size_t i = 0; i < pages; i++) {
+            resident += vec[i] & 1;
+        }
+    }
+    free(vec);
+
+    resident *= st->page_size;
+    return resident < st->arena_size ? resident : st->arena_size;
 }
 
 /**
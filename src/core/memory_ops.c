@@ -4,66 +4,663 @@
  *        para el simulador de administración de memoria.
  *
  * Este módulo proporciona las funciones principales que manipulan bloques de la arena,
- * registran variables, aplican los algoritmos de asignación (first-fit, best-fit, worst-fit),
- * realizan splits/merges y garantizan consistencia interna.
+ * registran variables, aplican los algoritmos de asignación (first-fit, best-fit, worst-fit,
+ * next-fit o los motores buddy y TLSF) a través de `allocator.c` y garantizan consistencia
+ * interna.
+ *
+ * Cuando la capa slab está activa, las solicitudes pequeñas se atienden primero
+ * con ranuras de `slab.c` y solo las demás llegan al asignador general. Las
+ * reservas con alineación explícita siempre van al asignador general.
+ *
+ * Como el programa solo conoce sus bloques por nombre, la arena puede
+ * compactarse (comando COMPACT): los bloques ocupados se deslizan hacia el
+ * inicio y cada variable sigue apuntando a su mismo descriptor. Con la
+ * política automática activa, una reserva que no cabe compacta la arena y
+ * se reintenta una vez.
+ *
+ * Si aun así no cabe y hay una política de crecimiento (comando GROW), la
+ * arena crece al final, como un heap con `sbrk`, hasta que la reserva entra
+ * o se alcanza el límite.
+ *
+ * El contenido que se escribe en los bloques depende del modo elegido con el
+ * comando PAYLOAD: la primera letra del nombre (por defecto), un patrón que
+ * luego puede verificarse, o nada, para estudios de ubicación y
+ * fragmentación donde solo importan los metadatos.
+ *
+ * ALLOC_N y FREE_PREFIX operan en lote: una corrida de bloques iguales sale
+ * de una sola búsqueda y un grupo de variables se libera con una sola pasada
+ * de fusión, con un único mensaje por lote.
+ *
+ * En un contexto que comparte el heap con otros hilos, cada operación toma
+ * el cerrojo del heap mientras lo modifica. Las reservas pequeñas sin
+ * alineación y sus liberaciones pasan antes por una caché del hilo (como la
+ * tcache de glibc): un FREE guarda el bloque, todavía ocupado para el heap,
+ * y un ALLOC de la misma clase lo reutiliza sin tomar el cerrojo.
  */
 
+#include <stdint.h>
+#include <stdio.h>
 #include <string.h>
+#include <strings.h>
 #include <stdlib.h>
 #include "memory_ops.h"
 #include "allocator.h"
+#include "slab.h"
 #include "blocks.h"
 #include "variables.h"
 #include "memory.h"
+#include "sim_context.h"
 #include "log.h"
 
+/* ------------------------------------------------------------------------- */
+/*                      ENRUTAMIENTO SLAB / ASIGNADOR                        */
+/* ------------------------------------------------------------------------- */
+
 /**
- * @brief Asigna memoria simulada (equivalente a ALLOC).
+ * @brief Políticas de este módulo en un contexto de simulación.
+ */
+typedef struct {
+    bool compact_on_failure;    /**< Compactar la arena cuando una reserva no cabe. */
+    MemPayload payload;         /**< Contenido que se escribe en los bloques. */
+    size_t cache_depth;         /**< Bloques por clase en la caché de cada hilo. */
+} MemoryOpsState;
+
+/** @brief Políticas de un contexto nuevo. */
+static const MemoryOpsState initial = { false, MEM_PAYLOAD_FILL, 0 };
+
+/**
+ * @brief Políticas del contexto del hilo actual.
+ */
+static MemoryOpsState *state(void) {
+    return sim_context_state(SIM_STATE_MEMORY_OPS, &initial, sizeof(initial));
+}
+
+/**
+ * @brief Compacta la arena e informa bytes movidos y duración.
+ *
+ * @param label Texto del mensaje ("COMPACT" o "COMPACT (auto)").
+ * @param moved Bytes movidos (puede ser NULL).
+ * @return true si el motor activo pudo compactar.
+ */
+static bool compact_arena(const char *label, size_t *moved) {
+    size_t bytes;
+    unsigned long long ns;
+
+    if (!allocator_compact(&bytes, &ns)) return false;
+
+    log_info("%s: %zu bytes movidos en %llu ns", label, bytes, ns);
+    if (moved) *moved = bytes;
+    return true;
+}
+
+/**
+ * @brief Reserva con la capa slab y, si no aplica, con el asignador general.
+ *
+ * Si el asignador general no tiene espacio, se devuelven a la arena los
+ * slabs vacíos en caché y se reintenta una vez. Si aún no cabe y la
+ * compactación automática está activa (y el motor la admite), se compacta
+ * la arena y se reintenta otra vez. Por último, la arena crece según su
+ * política hasta que la reserva cabe o ya no puede crecer.
+ *
+ * @param size  Tamaño solicitado en bytes.
+ * @param align Alineación en bytes (1 = sin restricción).
+ * @return Bloque o ranura ocupada, o NULL.
+ */
+static Block *block_alloc(size_t size, size_t align) {
+    Block *block = align > 1 ? NULL : slab_alloc(size);
+    if (block) return block;
+
+    block = allocator_alloc_aligned(size, align);
+    if (!block && slab_reclaim() > 0) {
+        block = allocator_alloc_aligned(size, align);
+    }
+
+    size_t moved = 0;
+    if (!block && state()->compact_on_failure && !sim_context_shared() &&
+        allocator_engine()->compact &&
+        compact_arena("COMPACT (auto)", &moved) && moved > 0) {
+        block = allocator_alloc_aligned(size, align);
+    }
+
+    while (!block && allocator_grow(size, align)) {
+        block = allocator_alloc_aligned(size, align);
+    }
+    return block;
+}
+
+/**
+ * @brief Valida una alineación solicitada.
+ *
+ * @param op    Comando, para el mensaje de error.
+ * @param name  Variable, para el mensaje de error.
+ * @param align Alineación en bytes.
+ * @return true si es una potencia de dos.
+ */
+static bool valid_alignment(const char *op, const char *name, size_t align) {
+    if (align == 0 || (align & (align - 1))) {
+        log_error("%s: alineación inválida (%zu) para '%s'; debe ser potencia de dos",
+                  op, align, name);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Devuelve un bloque o ranura a quien lo reservó.
+ *
+ * @param block Bloque o ranura ocupada.
+ */
+static void block_free(Block *block) {
+    if (block->slab) {
+        slab_free(block);
+    } else {
+        allocator_free(block);
+    }
+}
+
+/**
+ * @brief Redimensiona en su lugar un bloque o ranura.
+ *
+ * @param block    Bloque o ranura ocupada.
+ * @param new_size Nuevo tamaño solicitado.
+ * @return true si no necesita moverse.
+ */
+static bool block_resize_in_place(Block *block, size_t new_size) {
+    return block->slab ? slab_resize(block, new_size)
+                       : allocator_resize(block, new_size);
+}
+
+/**
+ * @brief Libera un grupo de bloques: las ranuras slab de a una y los
+ *        bloques del asignador general juntos.
+ *
+ * @param blocks Bloques ocupados; el arreglo se reordena.
+ * @param count  Cantidad de bloques.
+ */
+static void group_free(Block **blocks, size_t count) {
+    size_t general = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (blocks[i]->slab) {
+            slab_free(blocks[i]);
+        } else {
+            blocks[general++] = blocks[i];
+        }
+    }
+    if (general) {
+        allocator_free_run(blocks, general);
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+/*                            CACHÉ POR HILO                                 */
+/* ------------------------------------------------------------------------- */
+
+/** @brief Clases de tamaño de la caché. */
+#define CACHE_CLASSES (MEM_CACHE_MAX_SIZE / MEM_CACHE_GRANULE)
+
+/**
+ * @brief Bloques liberados que un hilo conserva para reutilizarlos.
+ *
+ * Los bloques de la caché siguen ocupados para el heap; la clase `c` guarda
+ * bloques de al menos `(c + 1) * MEM_CACHE_GRANULE` bytes. Los contadores
+ * del heap se ponen al día cada vez que la caché toma el cerrojo.
+ */
+typedef struct {
+    Block *slots[CACHE_CLASSES][MEM_CACHE_MAX_DEPTH];  /**< Pila por clase. */
+    size_t count[CACHE_CLASSES];                       /**< Bloques por clase. */
+    size_t grown;               /**< Bytes en uso aún no informados (módulo 2^N). */
+    MemCacheStats stats;        /**< Contadores del hilo. */
+    MemCacheStats synced;       /**< Contadores ya informados al heap. */
+} CacheState;
+
+/** @brief Caché de un contexto nuevo: vacía. */
+static const CacheState cache_initial;
+
+/**
+ * @brief Caché del contexto del hilo actual.
+ */
+static CacheState *cache(void) {
+    return sim_context_state(SIM_STATE_CACHE, &cache_initial, sizeof(cache_initial));
+}
+
+/**
+ * @brief Indica si las reservas del hilo actual pasan por su caché.
+ */
+static bool cache_enabled(void) {
+    return sim_context_shared() && state()->cache_depth > 0;
+}
+
+/**
+ * @brief Clase de la caché que atiende una reserva de `size` bytes.
+ */
+static size_t cache_class(size_t size) {
+    return (size + MEM_CACHE_GRANULE - 1) / MEM_CACHE_GRANULE - 1;
+}
+
+/**
+ * @brief Cambia los bytes solicitados de un bloque sin pasar por el heap.
+ *
+ * La diferencia se acumula para sumarla a los bytes en uso la próxima vez
+ * que la caché tome el cerrojo (las ranuras slab no cuentan en ellos). Se
+ * escribe sin el cerrojo, así que PRINT desde otro hilo lo lee con una
+ * carga atómica.
+ *
+ * @param c     Caché del hilo.
+ * @param block Bloque ocupado.
+ * @param size  Bytes solicitados.
+ */
+static void cache_note_requested(CacheState *c, Block *block, size_t size) {
+    if (!block->slab) {
+        c->grown += size - block->requested;
+    }
+    __atomic_store_n(&block->requested, size, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Informa al heap lo que atendió la caché desde la última vez.
+ *
+ * Debe llamarse con el cerrojo tomado.
+ */
+static void cache_sync(CacheState *c) {
+    allocator_note_cache(c->stats.hits - c->synced.hits,
+                         c->stats.stores - c->synced.stores, c->grown);
+    c->grown = 0;
+    c->synced = c->stats;
+}
+
+/**
+ * @brief Devuelve al heap los `n` bloques más antiguos de una clase.
+ *
+ * @param c   Caché del hilo.
+ * @param cls Clase.
+ * @param n   Bloques a devolver.
+ */
+static void cache_drain(CacheState *c, size_t cls, size_t n) {
+    sim_context_lock();
+    cache_sync(c);
+    group_free(c->slots[cls], n);
+    sim_context_unlock();
+
+    c->count[cls] -= n;
+    memmove(c->slots[cls], c->slots[cls] + n, c->count[cls] * sizeof(Block *));
+    c->stats.flushes += n;
+}
+
+/**
+ * @brief Toma de la caché un bloque para una reserva sin alineación.
+ *
+ * @param size Bytes solicitados (hasta `MEM_CACHE_MAX_SIZE`).
+ * @return Bloque ocupado, o NULL si la clase está vacía.
+ */
+static Block *cache_take(size_t size) {
+    CacheState *c = cache();
+    size_t cls = cache_class(size);
+
+    if (c->count[cls] == 0) {
+        c->stats.misses++;
+        return NULL;
+    }
+
+    Block *block = c->slots[cls][--c->count[cls]];
+    cache_note_requested(c, block, size);
+    c->stats.hits++;
+    return block;
+}
+
+/**
+ * @brief Guarda en la caché del hilo un bloque que se libera.
+ *
+ * La clase se elige por lo que el bloque puede atender: su tamaño y los
+ * bytes que pidió, redondeados a la granularidad, lo que sea menor. Si la
+ * clase está llena, primero se devuelve al heap su mitad más antigua.
+ *
+ * @param block Bloque ocupado.
+ * @return true si quedó en la caché; false si debe liberarse en el heap.
+ */
+static bool cache_put(Block *block) {
+    if (!cache_enabled() || block->size < MEM_CACHE_GRANULE ||
+        block->size > MEM_CACHE_MAX_SIZE) {
+        return false;
+    }
+
+    CacheState *c = cache();
+    size_t depth = state()->cache_depth;
+    size_t cls = cache_class(block->requested);
+
+    if (cls > block->size / MEM_CACHE_GRANULE - 1) {
+        cls = block->size / MEM_CACHE_GRANULE - 1;
+    }
+    if (c->count[cls] >= depth) {
+        cache_drain(c, cls, c->count[cls] - depth / 2);
+    }
+
+    c->slots[cls][c->count[cls]++] = block;
+    c->stats.stores++;
+    return true;
+}
+
+/**
+ * @brief Reserva el bloque de una variable nueva.
+ *
+ * Las reservas pequeñas sin alineación salen primero de la caché del hilo;
+ * si la clase está vacía, se piden al heap redondeadas a la granularidad de
+ * la caché, para que el bloque vuelva luego a la misma clase. El resto va
+ * al heap con el cerrojo tomado.
+ *
+ * @param size  Tamaño solicitado en bytes.
+ * @param align Alineación en bytes (1 = sin restricción).
+ * @return Bloque o ranura ocupada, o NULL.
+ */
+static Block *named_alloc(size_t size, size_t align) {
+    bool cached = align == 1 && size <= MEM_CACHE_MAX_SIZE && cache_enabled();
+    size_t want = size;
+
+    if (cached) {
+        Block *block = cache_take(size);
+        if (block) return block;
+        want = (cache_class(size) + 1) * MEM_CACHE_GRANULE;
+    }
+
+    sim_context_lock();
+    Block *block = block_alloc(want, align);
+    sim_context_unlock();
+
+    if (block && want != size) {
+        cache_note_requested(cache(), block, size);
+    }
+    return block;
+}
+
+/**
+ * @brief Libera el bloque de una variable: a la caché del hilo si la
+ *        admite, o al heap con el cerrojo tomado.
+ *
+ * @param block Bloque o ranura ocupada.
+ */
+static void named_free(Block *block) {
+    if (cache_put(block)) return;
+
+    sim_context_lock();
+    block_free(block);
+    sim_context_unlock();
+}
+
+/* ------------------------------------------------------------------------- */
+/*                        CONTENIDO DE LOS BLOQUES                           */
+/* ------------------------------------------------------------------------- */
+
+/** @brief Nombre de cada modo, en el orden de `MemPayload`. */
+static const char *const payload_names[] = { "none", "fill", "pattern" };
+
+/**
+ * @brief Semilla del patrón de una variable (FNV-1a de su nombre).
+ */
+static uint64_t pattern_seed(const char *name) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+
+    for (const unsigned char *p = (const unsigned char *)name; *p; p++) {
+        h = (h ^ *p) * 0x100000001b3ULL;
+    }
+    return h;
+}
+
+/** @brief Paso entre palabras consecutivas del patrón, antes de mezclarlas. */
+#define PATTERN_STEP 0x9e3779b97f4a7c15ULL
+
+/**
+ * @brief Palabra `index` del patrón de una variable.
+ *
+ * Depende solo de la semilla y de la posición dentro del bloque, así que el
+ * patrón sigue siendo válido cuando el bloque se mueve o se compacta.
+ */
+static uint64_t pattern_word(uint64_t seed, size_t index) {
+    uint64_t x = (seed + index) * PATTERN_STEP;
+
+    return x ^ (x >> 32);
+}
+
+/**
+ * @brief Escribe el patrón en los bytes `[from, to)` de un bloque.
+ *
+ * Los bytes hasta el primer múltiplo de 8 y los del final se copian de una
+ * palabra parcial; el resto se escribe de a una palabra completa, avanzando
+ * la secuencia con una suma por palabra.
+ *
+ * @param name Variable dueña del bloque.
+ * @param data Inicio del bloque en la arena.
+ * @param from Primer byte a escribir.
+ * @param to   Fin (exclusivo) de los bytes a escribir.
+ */
+static void pattern_fill(const char *name, unsigned char *data, size_t from, size_t to) {
+    uint64_t seed = pattern_seed(name);
+    size_t i = from;
+
+    if (i % sizeof(uint64_t) && i < to) {
+        uint64_t w = pattern_word(seed, i / sizeof(uint64_t));
+        size_t skip = i % sizeof(uint64_t);
+        size_t n = sizeof(uint64_t) - skip < to - i ? sizeof(uint64_t) - skip : to - i;
+        memcpy(data + i, (unsigned char *)&w + skip, n);
+        i += n;
+    }
+    uint64_t x = (seed + i / sizeof(uint64_t)) * PATTERN_STEP;
+    for (; to - i >= sizeof(uint64_t); i += sizeof(uint64_t), x += PATTERN_STEP) {
+        uint64_t w = x ^ (x >> 32);
+        memcpy(data + i, &w, sizeof(w));
+    }
+    if (i < to) {
+        uint64_t w = pattern_word(seed, i / sizeof(uint64_t));
+        memcpy(data + i, &w, to - i);
+    }
+}
+
+/**
+ * @brief Escribe el contenido de los bytes `[from, to)` de un bloque según
+ *        el modo activo.
+ *
+ * El rango se marca como escrito para CALLOC aun en el modo `none`, porque
+ * el mapa de páginas sigue el contenido que la traza habría dejado.
+ *
+ * @param name  Variable dueña del bloque.
+ * @param block Bloque de la variable.
+ * @param from  Primer byte a escribir.
+ * @param to    Fin (exclusivo) de los bytes a escribir.
+ */
+static void payload_write(const char *name, const Block *block, size_t from, size_t to) {
+    unsigned char *data = memory_arena() + block->offset;
+
+    if (from >= to) return;
+    memory_mark_dirty(block->offset + from, to - from);
+
+    switch (state()->payload) {
+    case MEM_PAYLOAD_FILL:
+        memset(data + from, name[0], to - from); /* Se usa solo la primera letra del nombre */
+        break;
+    case MEM_PAYLOAD_PATTERN:
+        pattern_fill(name, data, from, to);
+        break;
+    case MEM_PAYLOAD_NONE:
+        break;
+    }
+}
+
+/**
+ * @brief Copia el contenido conservado de un bloque a su nuevo offset.
+ *
+ * Los rangos pueden solaparse (bloque deslizado). Como `payload_write()`,
+ * el destino se marca como escrito aunque el modo sea `none`.
+ *
+ * @param to   Offset de destino.
+ * @param from Offset de origen.
+ * @param size Bytes a copiar.
+ */
+static void payload_copy(size_t to, size_t from, size_t size) {
+    unsigned char *arena = memory_arena();
+
+    memory_mark_dirty(to, size);
+    if (state()->payload != MEM_PAYLOAD_NONE) {
+        memmove(arena + to, arena + from, size);
+    }
+}
+
+/**
+ * @brief Estado de `vars_visit()` al verificar el contenido.
+ */
+typedef struct {
+    MemPayload mode;    /**< Modo con el que se escribió el contenido. */
+    size_t checked;     /**< Variables revisadas. */
+    size_t corrupt;     /**< Variables con contenido distinto al esperado. */
+} PayloadCheck;
+
+/**
+ * @brief Byte `i` del contenido que un modo escribe para una variable.
+ */
+static unsigned char payload_byte(MemPayload mode, const char *name, uint64_t seed, size_t i) {
+    if (mode == MEM_PAYLOAD_FILL) {
+        return (unsigned char)name[0];
+    }
+    uint64_t w = pattern_word(seed, i / sizeof(w));
+    return ((const unsigned char *)&w)[i % sizeof(w)];
+}
+
+/**
+ * @brief Compara el contenido de una variable con el que debería tener.
+ *
+ * Los primeros `block->zeroed` bytes deben estar en cero (un CALLOC, quizá
+ * agrandado luego con REALLOC) y el resto debe ser el contenido del modo.
+ */
+static void payload_check(const char *name, Block *block, void *ctx) {
+    PayloadCheck *check = ctx;
+    const unsigned char *data = memory_arena() + block->offset;
+    uint64_t seed = pattern_seed(name);
+    size_t size = block->requested;
+    size_t zeroed = block->zeroed < size ? block->zeroed : size;
+    size_t bad = size;
+
+    for (size_t i = 0; i < zeroed && bad == size; i++) {
+        if (data[i] != 0) bad = i;
+    }
+    for (size_t i = zeroed; i < size && bad == size; i++) {
+        if (data[i] != payload_byte(check->mode, name, seed, i)) bad = i;
+    }
+
+    check->checked++;
+    if (bad != size) {
+        log_error("PAYLOAD: contenido inválido en '%s' (offset=%zu, byte %zu)",
+                  name, block->offset, bad);
+        check->corrupt++;
+    }
+}
+
+/**
+ * @brief Reserva un bloque para una variable nueva (ALLOC y CALLOC).
  *
  * Realiza:
+ *  - Validación de tamaño (0 bytes no es una solicitud válida) y alineación
  *  - Validación de nombre duplicado
- *  - Selección de bloque según algoritmo configurado
- *  - Split del bloque si es mayor al solicitado
+ *  - Reserva de una ranura slab o de un bloque según el algoritmo configurado
  *  - Registro de la variable
- *  - Relleno de la arena con la primera letra del nombre
  *
- * @param name Nombre simbólico de la variable.
- * @param size Cantidad de bytes solicitados.
- * @return 0 si la operación fue exitosa, -1 si ocurrió algún error.
+ * @param op    Comando, para los mensajes de error.
+ * @param name  Nombre simbólico de la variable.
+ * @param size  Cantidad de bytes solicitados.
+ * @param align Alineación del offset en bytes.
+ * @return Bloque registrado, o NULL si ocurrió algún error.
  */
-int mem_alloc(const char *name, size_t size) {
+static Block *alloc_named(const char *op, const char *name, size_t size, size_t align) {
+
+    /* 0. Un bloque de 0 bytes compartiría offset con su vecino */
+    if (size == 0) {
+        log_error("%s: tamaño inválido (0 bytes) para '%s'", op, name);
+        return NULL;
+    }
+    if (!valid_alignment(op, name, align)) {
+        return NULL;
+    }
 
     /* 1. Validar duplicado */
     if (var_get(name) != NULL) {
-        log_error("ALLOC: variable '%s' ya existe", name);
-        return -1;
+        log_error("%s: variable '%s' ya existe", op, name);
+        return NULL;
     }
 
-    /* 2. Buscar bloque libre según first/best/worst fit */
-    Block *block = allocator_find_block(size);
+    /* 2. Reservar de la caché del hilo, o ranura slab o bloque según el algoritmo activo */
+    Block *block = named_alloc(size, align);
     if (!block) {
-        log_error("ALLOC: no hay bloque libre suficiente para '%s' (%zu bytes)", name, size);
-        return -1;
+        log_error("%s: no hay bloque libre suficiente para '%s' (%zu bytes)", op, name, size);
+        return NULL;
     }
 
-    /* 3. Split si el bloque es más grande */
-    if (block->size > size) {
-        block_split(block, size);
+    /* 3. Registrar variable; solo CALLOC deja bytes en cero */
+    block->zeroed = 0;
+    var_set(name, block);
+    return block;
+}
+
+/**
+ * @brief Asigna memoria simulada (equivalente a ALLOC).
+ *
+ * Reserva y registra el bloque con `alloc_named()` y escribe su contenido
+ * según el modo activo (por defecto, la primera letra del nombre).
+ *
+ * @param name  Nombre simbólico de la variable.
+ * @param size  Cantidad de bytes solicitados.
+ * @param align Alineación del offset en bytes (potencia de dos; 1 = ninguna).
+ * @return 0 si la operación fue exitosa, -1 si ocurrió algún error.
+ */
+int mem_alloc(const char *name, size_t size, size_t align) {
+    Block *block = alloc_named("ALLOC", name, size, align);
+    if (!block) {
+        return -1;
     }
 
-    /* 4. Marcar bloque como ocupado */
-    block->is_free = false;
+    /* Escribir el contenido según el modo activo */
+    payload_write(name, block, 0, size);
 
-    /* 5. Registrar variable */
-    var_set(name, block);
+    if (align > 1) {
+        log_info("ALLOC '%s' (%zu bytes, alineado a %zu) en offset=%zu",
+                 name, size, align, block->offset);
+    } else {
+        log_info("ALLOC '%s' (%zu bytes) en offset=%zu", name, size, block->offset);
+    }
+    return 0;
+}
+
+/**
+ * @brief Asigna memoria en cero para un arreglo (equivalente a CALLOC).
+ *
+ * El producto `count * size` se valida contra desbordamiento. Solo se
+ * ponen en cero las páginas del bloque que pudieron escribirse desde que
+ * se mapearon (`memory_zero()`); con el modo de contenido `none` no se
+ * escribe nada, pero se calcula igual cuánto habría que limpiar.
+ *
+ * @param name  Nombre simbólico de la variable.
+ * @param count Cantidad de elementos.
+ * @param size  Bytes por elemento.
+ * @param align Alineación del offset en bytes (potencia de dos; 1 = ninguna).
+ * @return 0 si la operación fue exitosa, -1 si ocurrió algún error.
+ */
+int mem_calloc(const char *name, size_t count, size_t size, size_t align) {
+    if (size != 0 && count > SIZE_MAX / size) {
+        log_error("CALLOC: %zu x %zu bytes desborda el tamaño máximo para '%s'",
+                  count, size, name);
+        return -1;
+    }
 
-    /* 6. Rellenar la arena */
-    unsigned char *arena = (unsigned char *)memory_arena();
-    for (size_t i = 0; i < size; i++) {
-        arena[block->offset + i] = name[0]; /* Se usa solo la primera letra del nombre */
+    size_t total = count * size;
+    Block *block = alloc_named("CALLOC", name, total, align);
+    if (!block) {
+        return -1;
     }
 
-    log_info("ALLOC '%s' (%zu bytes) en offset=%zu", name, size, block->offset);
+    size_t zeroed = memory_zero(block->offset, total, state()->payload != MEM_PAYLOAD_NONE);
+    block->zeroed = total;
+    sim_context_lock();
+    allocator_note_calloc(total, zeroed);
+    sim_context_unlock();
+
+    log_info("CALLOC '%s' (%zu x %zu = %zu bytes) en offset=%zu, %zu bytes limpiados",
+             name, count, size, total, block->offset, zeroed);
     return 0;
 }
 
@@ -72,8 +669,7 @@ int mem_alloc(const char *name, size_t size) {
  *
  * Realiza:
  *  - Obtención del bloque asociado
- *  - Marcado como libre
- *  - Fusión (merge) con vecinos libres
+ *  - Devolución del bloque a su slab o al algoritmo activo (marcado y fusión)
  *  - Eliminación de la variable de la tabla
  *
  * @param name Nombre de la variable a liberar.
@@ -88,13 +684,11 @@ int mem_free(const char *name) {
         return -1;
     }
 
-    /* 2. Marcar bloque como libre */
-    b->is_free = true;
+    /* 2. Guardar en la caché del hilo, o devolver a su slab, o marcar como
+     *    libre y fusionar según el algoritmo activo */
+    named_free(b);
 
-    /* 3. Merge con vecinos libres */
-    block_merge(b);
-
-    /* 4. Eliminar variable de la tabla */
+    /* 3. Eliminar variable de la tabla */
     var_remove(name);
 
     log_info("FREE '%s'", name);
@@ -107,112 +701,452 @@ int mem_free(const char *name) {
  * Casos manejados:
  *  - new_size == 0 → equivalente a FREE
  *  - new_size == old_size → no hace nada
- *  - Reducción del tamaño con posible split
- *  - Expansión in-place si hay espacio libre contiguo
+ *  - Reducción o expansión in-place (dentro de la ranura slab o con `allocator_resize`)
+ *  - Expansión hacia el bloque libre anterior, solo o junto con el siguiente
+ *    (`allocator_expand`): el contenido se desliza con `memmove`
  *  - Movimiento a un nuevo bloque si no es posible expandir
  *
- * @param name Nombre de la variable existente.
+ * Si el offset actual no cumple la alineación pedida, el bloque siempre
+ * cambia de offset (deslizándose o moviéndose), aunque el tamaño no cambie.
+ * Cada caso se registra en las estadísticas con los bytes copiados.
+ * Se ejecuta con el cerrojo del heap tomado (`mem_realloc()`).
+ *
+ * @param name     Nombre de la variable existente.
  * @param new_size Nuevo tamaño solicitado en bytes.
+ * @param align    Alineación del offset en bytes (potencia de dos; 1 = ninguna).
  * @return 0 si la operación fue exitosa, -1 si falló o no hay espacio.
  */
-int mem_realloc(const char *name, size_t new_size) {
+static int realloc_locked(const char *name, size_t new_size, size_t align) {
 
     Block *old = var_get(name);
     if (!old) {
         log_error("REALLOC: variable '%s' no existe", name);
         return -1;
     }
+    if (!valid_alignment("REALLOC", name, align)) {
+        return -1;
+    }
 
-    size_t old_size = old->size;
+    size_t old_size = old->requested;
 
     /* Caso 0: new_size == 0 → liberar memoria */
     if (new_size == 0) {
         return mem_free(name);
     }
 
+    bool aligned = (old->offset & (align - 1)) == 0;
+
+    /* Si se queda en su lugar, la compactación debe respetar la nueva alineación */
+    if (aligned && align > 1) {
+        block_set_alignment(old, align);
+    }
+
     /* Caso 1: mismo tamaño → no se hace nada */
-    if (new_size == old_size) {
+    if (new_size == old_size && aligned) {
+        allocator_note_realloc(ALLOC_REALLOC_IN_PLACE, 0);
         return 0;
     }
 
-    unsigned char *arena = memory_arena();
-
-    /* Caso 2: reducción */
-    if (new_size < old_size) {
-        block_split(old, new_size);   /* Ajusta el bloque actual */
-        block_merge(old);             /* Intenta fusionar sobrante */
+    /* Caso 2: reducción (el sobrante se devuelve al algoritmo activo) */
+    if (new_size < old_size && aligned) {
+        block_resize_in_place(old, new_size);
+        if (old->zeroed > new_size) old->zeroed = new_size;
+        allocator_note_realloc(ALLOC_REALLOC_IN_PLACE, 0);
         log_info("REALLOC (reduce) '%s' %zu -> %zu bytes", name, old_size, new_size);
         return 0;
     }
 
-    /* Caso 3: expansión in-place */
-    size_t extra = new_size - old_size;
+    /* Caso 3: expansión in-place con espacio libre contiguo */
+    if (aligned && block_resize_in_place(old, new_size)) {
 
-    /* Intentar coalescer espacio contiguo */
-    if (old->next && old->next->is_free) {
-        block_merge(old->next);
-    }
-
-    /* Revisar si ya hay suficiente espacio */
-    if (old->next && old->next->is_free && old->next->size >= extra) {
+        /* Rellenar la parte nueva */
+        payload_write(name, old, old_size, new_size);
 
-        Block *next = old->next;
+        allocator_note_realloc(ALLOC_REALLOC_IN_PLACE, 0);
+        log_info("REALLOC (expand in-place) '%s' %zu -> %zu bytes", name, old_size, new_size);
+        return 0;
+    }
 
-        if (next->size == extra) {
-            /* Tomar todo el bloque next */
-            old->size += next->size;
+    /* Una reducción que cambia de offset solo conserva new_size bytes */
+    size_t kept = old_size < new_size ? old_size : new_size;
+    size_t zeroed = old->zeroed < kept ? old->zeroed : kept;
 
-            old->next = next->next;
-            if (next->next) {
-                next->next->prev = old;
-            }
-            free(next);
-        } else {
-            /* Consumir parte del bloque siguiente */
-            next->offset += extra;
-            next->size   -= extra;
-            old->size    += extra;
-        }
+    /* Caso 4: expansión hacia el bloque libre anterior (y el siguiente) */
+    size_t old_offset = old->offset;
+    if (!old->slab && allocator_expand(old, new_size, align)) {
 
-        /* Rellenar la parte nueva */
-        for (size_t i = old_size; i < new_size; i++) {
-            arena[old->offset + i] = name[0];
-        }
+        /* Deslizar el contenido: los rangos pueden solaparse */
+        payload_copy(old->offset, old_offset, kept);
+        payload_write(name, old, old_size, new_size);
+        old->zeroed = zeroed;
 
-        log_info("REALLOC (expand in-place) '%s' %zu -> %zu bytes", name, old_size, new_size);
+        allocator_note_realloc(ALLOC_REALLOC_SLID, kept);
+        log_info("REALLOC (expand backward) '%s' %zu -> %zu bytes, offset %zu -> %zu",
+                 name, old_size, new_size, old_offset, old->offset);
         return 0;
     }
 
-    /* Caso 4: mover a un nuevo bloque */
-    Block *new_block = allocator_find_block(new_size);
+    /* Caso 5: mover a un nuevo bloque */
+    Block *new_block = block_alloc(new_size, align);
     if (!new_block) {
         log_error("REALLOC: no hay bloque nuevo suficiente para '%s'", name);
         return -1;
     }
 
-    /* Split si es mayor */
-    if (new_block->size > new_size) {
-        block_split(new_block, new_size);
-    }
-
-    new_block->is_free = false;
-
     /* Copiar contenido */
-    memcpy(arena + new_block->offset,
-           arena + old->offset,
-           old_size);
+    payload_copy(new_block->offset, old->offset, kept);
 
     /* Rellenar el resto */
-    for (size_t i = old_size; i < new_size; i++) {
-        arena[new_block->offset + i] = name[0];
-    }
+    payload_write(name, new_block, old_size, new_size);
 
     /* Liberar bloque original */
     mem_free(name);
 
-    /* Registrar nuevo bloque */
+    /* Registrar nuevo bloque, con el prefijo en cero que conservó */
+    new_block->zeroed = zeroed;
     var_set(name, new_block);
 
+    allocator_note_realloc(ALLOC_REALLOC_MOVED, kept);
     log_info("REALLOC (move) '%s' %zu -> %zu bytes", name, old_size, new_size);
     return 0;
 }
+
+/**
+ * @brief Cambia el tamaño de un bloque de memoria (REALLOC) con el cerrojo
+ *        del heap tomado.
+ *
+ * @param name     Nombre de la variable existente.
+ * @param new_size Nuevo tamaño solicitado en bytes.
+ * @param align    Alineación del offset en bytes (potencia de dos; 1 = ninguna).
+ * @return 0 si la operación fue exitosa, -1 si falló o no hay espacio.
+ */
+int mem_realloc(const char *name, size_t new_size, size_t align) {
+    sim_context_lock();
+    int result = realloc_locked(name, new_size, align);
+    sim_context_unlock();
+    return result;
+}
+
+/**
+ * @brief Compacta la arena (comando COMPACT).
+ *
+ * Con el heap compartido entre hilos no se compacta: movería bloques que
+ * otros hilos usan sin tomar el cerrojo.
+ *
+ * @return 0 si se compactó, -1 si el motor activo no lo admite o el heap
+ *         está compartido.
+ */
+int mem_compact(void) {
+    if (sim_context_shared()) {
+        log_error("COMPACT: no disponible con el heap compartido entre hilos");
+        return -1;
+    }
+    return compact_arena("COMPACT", NULL) ? 0 : -1;
+}
+
+/**
+ * @brief Activa o desactiva la compactación al fallar una reserva.
+ *
+ * @param enabled true para compactar y reintentar las reservas que no caben.
+ */
+void mem_set_compact_on_failure(bool enabled) {
+    state()->compact_on_failure = enabled;
+    log_info("Compactación automática: %s", enabled ? "activada" : "desactivada");
+}
+
+/**
+ * @brief Elige el contenido que se escribe en los bloques (comando PAYLOAD).
+ *
+ * @param mode Modo de contenido.
+ */
+void mem_set_payload(MemPayload mode) {
+    state()->payload = mode;
+    log_info("Contenido de los bloques: %s", payload_names[mode]);
+}
+
+/**
+ * @brief Busca un modo de contenido por nombre, sin distinguir mayúsculas.
+ *
+ * @param name Nombre ("none", "fill" o "pattern").
+ * @param out  Modo encontrado.
+ * @return true si el nombre es válido.
+ */
+bool mem_payload_from_name(const char *name, MemPayload *out) {
+    for (size_t i = 0; i < sizeof(payload_names) / sizeof(payload_names[0]); i++) {
+        if (strcasecmp(name, payload_names[i]) == 0) {
+            *out = (MemPayload)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Verifica el contenido de todas las variables (comando PAYLOAD verify).
+ *
+ * @return 0 si todas tienen el contenido esperado, -1 si alguna no, o si
+ *         el modo activo no escribe contenido.
+ */
+int mem_verify_payload(void) {
+    PayloadCheck check = { state()->payload, 0, 0 };
+
+    if (check.mode == MEM_PAYLOAD_NONE) {
+        log_error("PAYLOAD: el modo 'none' no escribe contenido que verificar");
+        return -1;
+    }
+
+    vars_visit(payload_check, &check);
+    log_info("PAYLOAD verify (%s): %zu variables, %zu con contenido inválido",
+             payload_names[check.mode], check.checked, check.corrupt);
+    return check.corrupt ? -1 : 0;
+}
+
+/**
+ * @brief Elige la política de crecimiento de la arena (comando GROW).
+ *
+ * @param policy Política de crecimiento.
+ * @param step   Bytes por paso con `MEMORY_GROW_STEP`.
+ */
+void mem_set_growth(MemoryGrowth policy, size_t step) {
+    static const char *const names[] = { "desactivado", "exacto", "por pasos", "duplicando" };
+
+    memory_set_growth(policy, step);
+    if (policy == MEMORY_GROW_STEP) {
+        log_info("Crecimiento de la arena: %s de %zu bytes (límite %zu bytes)",
+                 names[policy], step, memory_growth()->limit);
+    } else if (policy != MEMORY_GROW_OFF) {
+        log_info("Crecimiento de la arena: %s (límite %zu bytes)",
+                 names[policy], memory_growth()->limit);
+    } else {
+        log_info("Crecimiento de la arena: %s", names[policy]);
+    }
+
+    if (policy != MEMORY_GROW_OFF && !allocator_engine()->grow) {
+        log_info("El motor '%s' no admite crecimiento; la arena no crecerá con él",
+                 allocator_engine()->name);
+    }
+}
+
+/**
+ * @brief Elige cuántos bloques por clase guarda la caché de cada hilo.
+ *
+ * @param depth Bloques por clase (se limita a `MEM_CACHE_MAX_DEPTH`); 0 la
+ *              desactiva.
+ */
+void mem_set_thread_cache(size_t depth) {
+    if (depth > MEM_CACHE_MAX_DEPTH) depth = MEM_CACHE_MAX_DEPTH;
+
+    state()->cache_depth = depth;
+    if (depth) {
+        log_info("Caché por hilo: %zu bloques por clase, hasta %d bytes",
+                 depth, MEM_CACHE_MAX_SIZE);
+    } else {
+        log_info("Caché por hilo: desactivada");
+    }
+}
+
+/**
+ * @brief Bloques por clase de la caché de cada hilo (0 = desactivada).
+ */
+size_t mem_thread_cache(void) {
+    return state()->cache_depth;
+}
+
+/**
+ * @brief Devuelve al heap todos los bloques de la caché del hilo actual.
+ */
+void mem_cache_flush(void) {
+    CacheState *c = cache();
+
+    sim_context_lock();
+    for (size_t cls = 0; cls < CACHE_CLASSES; cls++) {
+        if (c->count[cls]) {
+            cache_drain(c, cls, c->count[cls]);
+        }
+    }
+    cache_sync(c);
+    sim_context_unlock();
+}
+
+/**
+ * @brief Contadores de la caché del hilo actual.
+ */
+MemCacheStats mem_cache_stats(void) {
+    return cache()->stats;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                          OPERACIONES EN LOTE                              */
+/* ------------------------------------------------------------------------- */
+
+/** @brief Bloques que FREE_PREFIX reserva para reunir el grupo al empezar. */
+#define GROUP_MIN_BLOCKS 16
+
+/**
+ * @brief Bloques que FREE_PREFIX reúne de las variables que quita.
+ */
+typedef struct {
+    Block **blocks;         /**< Bloques reunidos. */
+    size_t count;           /**< Bloques en `blocks`. */
+    size_t capacity;        /**< Lugar en `blocks`. */
+} PrefixGroup;
+
+/**
+ * @brief Guarda el bloque de una variable que `vars_remove_prefix()` quita.
+ *
+ * El arreglo se duplica cuando se llena; si no puede crecer, el bloque se
+ * libera en el momento, solo.
+ */
+static void group_take(const char *name, Block *block, void *ctx) {
+    PrefixGroup *group = ctx;
+    (void)name;
+
+    if (group->count == group->capacity) {
+        size_t cap = group->capacity ? group->capacity * 2 : GROUP_MIN_BLOCKS;
+        Block **bigger = realloc(group->blocks, cap * sizeof(*bigger));
+        if (!bigger) {
+            sim_context_lock();
+            group_free(&block, 1);
+            sim_context_unlock();
+            return;
+        }
+        group->blocks = bigger;
+        group->capacity = cap;
+    }
+    group->blocks[group->count++] = block;
+}
+
+/**
+ * @brief Reserva `count` bloques de `size` bytes para las variables
+ *        `prefix0` .. `prefix<count-1>` (equivalente a ALLOC_N).
+ *
+ * Realiza:
+ *  - Validación de cantidad, tamaño, desborde y alineación
+ *  - Validación de nombres duplicados con una búsqueda por nombre del lote
+ *  - Reserva de la corrida completa con una búsqueda (`allocator_alloc_run`);
+ *    si no hay un bloque libre que la contenga, o el motor no reserva
+ *    corridas, o la capa slab está activa, se reserva de a un bloque
+ *  - Escritura del contenido y registro de las variables, con un único
+ *    mensaje para todo el lote
+ *
+ * Si algún bloque no cabe, se liberan los ya reservados y no se registra
+ * ninguna variable. Se ejecuta con el cerrojo del heap tomado
+ * (`mem_alloc_n()`).
+ *
+ * @param prefix Prefijo de los nombres.
+ * @param count  Cantidad de bloques.
+ * @param size   Bytes de cada bloque.
+ * @param align  Alineación del offset en bytes (potencia de dos; 1 = ninguna).
+ * @return 0 si la operación fue exitosa, -1 si ocurrió algún error.
+ */
+static int alloc_n_locked(const char *prefix, size_t count, size_t size, size_t align) {
+    if (count == 0 || size == 0) {
+        log_error("ALLOC_N: cantidad o tamaño inválido (%zu x %zu bytes) para '%s'",
+                  count, size, prefix);
+        return -1;
+    }
+    if (count > SIZE_MAX / size || count > SIZE_MAX / sizeof(Block *)) {
+        log_error("ALLOC_N: %zu x %zu bytes desborda el tamaño máximo para '%s'",
+                  count, size, prefix);
+        return -1;
+    }
+    if (!valid_alignment("ALLOC_N", prefix, align)) {
+        return -1;
+    }
+
+    Block **blocks = malloc(count * sizeof(*blocks));
+    char *name = malloc(strlen(prefix) + 21);
+    if (!blocks || !name) {
+        log_error("ALLOC_N: sin memoria para el lote '%s'", prefix);
+        free(blocks);
+        free(name);
+        return -1;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        sprintf(name, "%s%zu", prefix, i);
+        if (var_get(name) != NULL) {
+            log_error("ALLOC_N: variable '%s' ya existe", name);
+            free(blocks);
+            free(name);
+            return -1;
+        }
+    }
+
+    /* Una búsqueda para la corrida; lo que no entre en ella, de a un bloque */
+    size_t run = align == 1 && slab_enabled() ? 0
+               : allocator_alloc_run(size, align, count, blocks);
+    size_t n = run;
+    while (n < count && (blocks[n] = block_alloc(size, align)) != NULL) {
+        n++;
+    }
+    if (n < count) {
+        log_error("ALLOC_N: no hay espacio para '%s' (%zu de %zu bloques de %zu bytes)",
+                  prefix, n, count, size);
+        group_free(blocks, n);
+        free(blocks);
+        free(name);
+        return -1;
+    }
+
+    size_t first = blocks[0]->offset;
+    for (size_t i = 0; i < count; i++) {
+        sprintf(name, "%s%zu", prefix, i);
+        payload_write(name, blocks[i], 0, size);
+        blocks[i]->zeroed = 0;
+        var_add(name, blocks[i]);
+    }
+
+    log_info("ALLOC_N '%s' %zu x %zu bytes desde offset=%zu (%zu en una corrida)",
+             prefix, count, size, first, run);
+    free(blocks);
+    free(name);
+    return 0;
+}
+
+/**
+ * @brief Reserva un lote de variables (ALLOC_N) con el cerrojo del heap
+ *        tomado.
+ *
+ * @param prefix Prefijo de los nombres.
+ * @param count  Cantidad de bloques.
+ * @param size   Bytes de cada bloque.
+ * @param align  Alineación del offset en bytes (potencia de dos; 1 = ninguna).
+ * @return 0 si la operación fue exitosa, -1 si ocurrió algún error.
+ */
+int mem_alloc_n(const char *prefix, size_t count, size_t size, size_t align) {
+    sim_context_lock();
+    int result = alloc_n_locked(prefix, count, size, align);
+    sim_context_unlock();
+    return result;
+}
+
+/**
+ * @brief Libera todas las variables cuyo nombre empieza con un prefijo
+ *        (equivalente a FREE_PREFIX).
+ *
+ * Las variables del prefijo se ubican en el árbol por nombre de la tabla y
+ * se quitan en una sola pasada (O(log n + k)), reuniendo sus bloques en un
+ * arreglo que crece a medida; los bloques se devuelven juntos con
+ * `allocator_free_run()`, que los fusiona en una sola pasada.
+ *
+ * @param prefix Prefijo de los nombres.
+ * @return 0 si se liberó al menos una variable, -1 si ninguna coincide.
+ */
+int mem_free_prefix(const char *prefix) {
+    PrefixGroup group = { NULL, 0, 0 };
+
+    size_t removed = vars_remove_prefix(prefix, group_take, &group);
+    if (removed == 0) {
+        log_error("FREE_PREFIX: ninguna variable empieza con '%s'", prefix);
+        return -1;
+    }
+
+    sim_context_lock();
+    group_free(group.blocks, group.count);
+    sim_context_unlock();
+    free(group.blocks);
+
+    log_info("FREE_PREFIX '%s': %zu variables", prefix, removed);
+    return 0;
+}
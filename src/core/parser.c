@@ -4,14 +4,18 @@
  *        provenientes del archivo de entrada para la simulación de memoria.
  *
  * Este parser lee un archivo línea por línea, elimina espacios, ignora comentarios
- * o líneas vacías, interpreta los comandos ALLOC, REALLOC, FREE y PRINT, y despacha
+ * o líneas vacías, interpreta los comandos ALLOC, REALLOC, FREE, PRINT, STATS y SLAB, y despacha
  * las operaciones correspondientes hacia los módulos de memoria.
  *
  * Formato esperado del archivo:
- *   - ALLOC <nombre> <tamaño>
- *   - REALLOC <nombre> <nuevo_tamaño>
+ *   - ALLOC <nombre> <tamaño> [ALIGN <bytes>]
+ *   - REALLOC <nombre> <nuevo_tamaño> [ALIGN <bytes>]
  *   - FREE <nombre>
+ *   - ALLOC_N <prefijo> <cantidad> <tamaño> [ALIGN <bytes>]
+ *   - FREE_PREFIX <prefijo>
  *   - PRINT
+ *   - STATS
+ *   - SLAB [<clase> ...]
  *   - # comentarios
  */
 
@@ -19,45 +23,392 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <strings.h>
 
 #include "parser.h"
 #include "string_utils.h"
 #include "memory_ops.h"
 #include "print.h"
+#include "slab.h"
+#include "allocator.h"
+#include "snapshot.h"
+#include "sim_context.h"
 #include "log.h"
 
 #define MAX_LINE 256
 
 /**
- * @brief Ejecuta todas las instrucciones almacenadas en un archivo.
+ * @brief Activa la capa slab con las clases indicadas en la línea.
  *
- * Esta función abre el archivo especificado, procesa cada línea removiendo
- * espacios en blanco y comentarios, valida el formato de los comandos e invoca
- * la operación correspondiente según el tipo de instrucción leída.
+ * Sin argumentos se usan las clases por defecto.
+ *
+ * @param args        Texto que sigue al comando SLAB.
+ * @param line_number Número de línea, para los mensajes de error.
+ */
+static void parse_slab(const char *args, int line_number) {
+    size_t classes[SLAB_MAX_CLASSES];
+    size_t count = 0;
+    char *end;
+
+    for (;;) {
+        while (isspace((unsigned char)*args)) args++;
+        if (*args == '\0') break;
+
+        unsigned long long value = strtoull(args, &end, 10);
+        if (end == args || (*end && !isspace((unsigned char)*end))) {
+            log_error("Línea %d: SLAB requiere tamaños numéricos", line_number);
+            return;
+        }
+        if (count == SLAB_MAX_CLASSES) {
+            log_error("Línea %d: SLAB admite a lo sumo %d clases", line_number, SLAB_MAX_CLASSES);
+            return;
+        }
+        classes[count++] = (size_t)value;
+        args = end;
+    }
+
+    slab_enable(count ? classes : NULL, count);
+}
+
+/**
+ * @brief Interpreta el sufijo opcional `ALIGN <bytes>` de ALLOC, ALLOC_N,
+ *        CALLOC y REALLOC.
+ *
+ * Un comentario al final de la línea (`# ...`) equivale a no tener sufijo;
+ * cualquier otra palabra después del sufijo es un error.
+ *
+ * @param count       Campos leídos por `sscanf` (3 sin sufijo, 6 si sobra
+ *                    texto después de él).
+ * @param keyword     Palabra que sigue al tamaño.
+ * @param value       Valor que sigue a la palabra.
+ * @param extra       Primer carácter de lo que sigue al valor.
+ * @param line_number Número de línea, para los mensajes de error.
+ * @param align       Alineación resultante (1 sin sufijo).
+ * @return true si el sufijo está ausente o es válido.
+ */
+static bool parse_align(int count, char *keyword, size_t value, const char *extra,
+                        int line_number, size_t *align) {
+    *align = 1;
+    if (count <= 3 || keyword[0] == '#') return true;
+
+    for (int i = 0; keyword[i]; i++)
+        keyword[i] = toupper((unsigned char)keyword[i]);
+
+    if (strcmp(keyword, "ALIGN") != 0 || count < 5) {
+        log_error("Línea %d: se esperaba 'ALIGN <bytes>' después del tamaño", line_number);
+        return false;
+    }
+    if (count > 5 && extra[0] != '#') {
+        log_error("Línea %d: texto sobrante después de 'ALIGN <bytes>'", line_number);
+        return false;
+    }
+
+    *align = value;
+    return true;
+}
+
+/**
+ * @brief Ejecuta una línea de comando ya recortada.
+ *
+ * Valida el formato del comando e invoca la operación correspondiente según
+ * el tipo de instrucción leída.
  *
  * Comandos soportados:
- *   - **ALLOC nombre tamaño**: Reserva memoria para una variable.
- *   - **REALLOC nombre tamaño**: Cambia el tamaño de un bloque existente.
+ *   - **ALLOC nombre tamaño [ALIGN n]**: Reserva memoria para una variable,
+ *     opcionalmente en un offset múltiplo de `n`.
+ *   - **REALLOC nombre tamaño [ALIGN n]**: Cambia el tamaño de un bloque existente.
+ *   - **CALLOC nombre cantidad tamaño [ALIGN n]**: Reserva un arreglo en cero.
  *   - **FREE nombre**: Libera un bloque previamente asignado.
+ *   - **ALLOC_N prefijo cantidad tamaño [ALIGN n]**: Reserva `cantidad`
+ *     bloques contiguos para `prefijo0`, `prefijo1`, ...
+ *   - **FREE_PREFIX prefijo**: Libera todas las variables cuyo nombre
+ *     empieza con el prefijo.
  *   - **PRINT**: Muestra el estado actual de la memoria gestionada.
+ *   - **STATS**: Muestra contadores y latencias del algoritmo activo.
+ *   - **SLAB [clase ...]**: Activa la capa slab (clases por defecto si se omiten).
+ *   - **STORE index|table**: Elige dónde buscan las políticas de lista.
+ *   - **COMPACT [auto|off]**: Compacta la arena ahora, o activa/desactiva la
+ *     compactación al fallar una reserva.
+ *   - **COALESCE immediate|deferred [n]**: Fusiona los bloques liberados en
+ *     cada FREE, o en barridos cada `n` liberaciones (o al faltar espacio).
+ *   - **GROW off|exact|double|step n**: Política de crecimiento de la arena
+ *     cuando una reserva no cabe.
+ *   - **PAYLOAD none|fill|pattern|verify**: Contenido que se escribe en los
+ *     bloques, o verificación del contenido de todas las variables.
+ *
+ * @param line        Línea sin espacios al inicio ni al final.
+ * @param line_number Número de línea, para los mensajes de error.
+ */
+static void execute_line(char *line, int line_number) {
+    // Buffers para tokens
+    char cmd[32];
+    char arg1[64];
+    char keyword[16];
+    char extra[2];
+    size_t size = 0;
+    size_t value = 0;
+    size_t align = 1;
+
+    // Patrones esperados:
+    // ALLOC X 100
+    // ALLOC X 100 ALIGN 64
+    // REALLOC X 300
+    // FREE X
+    // PRINT
+    int count = sscanf(line, "%31s %63s %zu %15s %zu %1s", cmd, arg1, &size, keyword, &value, extra);
+
+    if (count <= 0) {
+        log_error("Línea %d: comando inválido", line_number);
+        return;
+    }
+
+    // Convertir comando a mayúsculas para manejo uniforme
+    for (int i = 0; cmd[i]; i++)
+        cmd[i] = toupper((unsigned char)cmd[i]);
+
+    // --- PRINT ---
+    if (strcmp(cmd, "PRINT") == 0) {
+        mem_print();
+        return;
+    }
+
+    // --- STATS ---
+    if (strcmp(cmd, "STATS") == 0) {
+        mem_print_stats();
+        return;
+    }
+
+    // --- SLAB [clase ...] ---
+    if (strcmp(cmd, "SLAB") == 0) {
+        parse_slab(line + strcspn(line, " \t"), line_number);
+        return;
+    }
+
+    // --- STORE index|table ---
+    if (strcmp(cmd, "STORE") == 0) {
+        for (int i = 0; count >= 2 && arg1[i]; i++)
+            arg1[i] = toupper((unsigned char)arg1[i]);
+
+        if (count >= 2 && strcmp(arg1, "TABLE") == 0) {
+            allocator_use_table(true);
+        } else if (count >= 2 && strcmp(arg1, "INDEX") == 0) {
+            allocator_use_table(false);
+        } else {
+            log_error("Línea %d: STORE requiere 'index' o 'table'", line_number);
+        }
+        return;
+    }
+
+    // --- COMPACT [auto|off] ---
+    if (strcmp(cmd, "COMPACT") == 0) {
+        for (int i = 0; count >= 2 && arg1[i]; i++)
+            arg1[i] = toupper((unsigned char)arg1[i]);
+
+        if (count < 2 || arg1[0] == '#') {
+            mem_compact();
+        } else if (strcmp(arg1, "AUTO") == 0) {
+            mem_set_compact_on_failure(true);
+        } else if (strcmp(arg1, "OFF") == 0) {
+            mem_set_compact_on_failure(false);
+        } else {
+            log_error("Línea %d: COMPACT admite 'auto' u 'off'", line_number);
+        }
+        return;
+    }
+
+    // --- COALESCE immediate|deferred [n] ---
+    if (strcmp(cmd, "COALESCE") == 0) {
+        for (int i = 0; count >= 2 && arg1[i]; i++)
+            arg1[i] = toupper((unsigned char)arg1[i]);
+
+        if (count >= 2 && strcmp(arg1, "IMMEDIATE") == 0) {
+            allocator_defer_coalescing(0);
+        } else if (count >= 2 && strcmp(arg1, "DEFERRED") == 0) {
+            if (count >= 3 && size == 0) {
+                log_error("Línea %d: el umbral de COALESCE debe ser mayor que 0", line_number);
+                return;
+            }
+            allocator_defer_coalescing(count >= 3 ? size : ALLOC_COALESCE_THRESHOLD);
+        } else {
+            log_error("Línea %d: COALESCE requiere 'immediate' o 'deferred'", line_number);
+        }
+        return;
+    }
+
+    // --- GROW off|exact|double|step n ---
+    if (strcmp(cmd, "GROW") == 0) {
+        for (int i = 0; count >= 2 && arg1[i]; i++)
+            arg1[i] = toupper((unsigned char)arg1[i]);
+
+        if (count >= 2 && strcmp(arg1, "OFF") == 0) {
+            mem_set_growth(MEMORY_GROW_OFF, 0);
+        } else if (count >= 2 && strcmp(arg1, "EXACT") == 0) {
+            mem_set_growth(MEMORY_GROW_EXACT, 0);
+        } else if (count >= 2 && strcmp(arg1, "DOUBLE") == 0) {
+            mem_set_growth(MEMORY_GROW_DOUBLE, 0);
+        } else if (count >= 3 && strcmp(arg1, "STEP") == 0 && size > 0) {
+            mem_set_growth(MEMORY_GROW_STEP, size);
+        } else {
+            log_error("Línea %d: GROW requiere 'off', 'exact', 'double' o 'step <bytes>'", line_number);
+        }
+        return;
+    }
+
+    // --- PAYLOAD none|fill|pattern|verify ---
+    if (strcmp(cmd, "PAYLOAD") == 0) {
+        MemPayload mode;
+
+        for (int i = 0; count >= 2 && arg1[i]; i++)
+            arg1[i] = toupper((unsigned char)arg1[i]);
+
+        if (count >= 2 && strcmp(arg1, "VERIFY") == 0) {
+            mem_verify_payload();
+        } else if (count >= 2 && mem_payload_from_name(arg1, &mode)) {
+            mem_set_payload(mode);
+        } else {
+            log_error("Línea %d: PAYLOAD requiere 'none', 'fill', 'pattern' o 'verify'", line_number);
+        }
+        return;
+    }
+
+    // --- SNAPSHOT archivo ---
+    if (strcmp(cmd, "SNAPSHOT") == 0) {
+        char *path = str_trim(line + strcspn(line, " \t"));
+        if (path[0] == '\0') {
+            log_error("Línea %d: SNAPSHOT requiere un archivo", line_number);
+            return;
+        }
+        snapshot_save(path);
+        return;
+    }
+
+    // --- RESTORE archivo ---
+    if (strcmp(cmd, "RESTORE") == 0) {
+        char *path = str_trim(line + strcspn(line, " \t"));
+        if (path[0] == '\0') {
+            log_error("Línea %d: RESTORE requiere un archivo", line_number);
+            return;
+        }
+        snapshot_load(path);
+        return;
+    }
+
+    // --- FREE nombre ---
+    if (strcmp(cmd, "FREE") == 0) {
+        if (count < 2) {
+            log_error("Línea %d: FREE requiere un nombre", line_number);
+            return;
+        }
+        mem_free(arg1);
+        return;
+    }
+
+    // --- FREE_PREFIX prefijo ---
+    if (strcmp(cmd, "FREE_PREFIX") == 0) {
+        if (count < 2) {
+            log_error("Línea %d: FREE_PREFIX requiere un prefijo", line_number);
+            return;
+        }
+        mem_free_prefix(arg1);
+        return;
+    }
+
+    // --- ALLOC_N prefijo cantidad tamaño [ALIGN n] ---
+    if (strcmp(cmd, "ALLOC_N") == 0) {
+        size_t block_size = 0;
+        int fields = sscanf(line, "%*s %63s %zu %zu %15s %zu %1s",
+                            arg1, &size, &block_size, keyword, &value, extra);
+        if (fields < 3) {
+            log_error("Línea %d: ALLOC_N requiere prefijo, cantidad y tamaño", line_number);
+            return;
+        }
+        if (!parse_align(fields, keyword, value, extra, line_number, &align)) return;
+        mem_alloc_n(arg1, size, block_size, align);
+        return;
+    }
+
+    // --- ALLOC nombre tamaño [ALIGN n] ---
+    if (strcmp(cmd, "ALLOC") == 0) {
+        if (count < 3) {
+            log_error("Línea %d: ALLOC requiere nombre y tamaño", line_number);
+            return;
+        }
+        if (!parse_align(count, keyword, value, extra, line_number, &align)) return;
+        mem_alloc(arg1, size, align);
+        return;
+    }
+
+    // --- CALLOC nombre cantidad tamaño [ALIGN n] ---
+    if (strcmp(cmd, "CALLOC") == 0) {
+        size_t elem_size = 0;
+        int fields = sscanf(line, "%*s %63s %zu %zu %15s %zu %1s",
+                            arg1, &size, &elem_size, keyword, &value, extra);
+        if (fields < 3) {
+            log_error("Línea %d: CALLOC requiere nombre, cantidad y tamaño", line_number);
+            return;
+        }
+        if (!parse_align(fields, keyword, value, extra, line_number, &align)) return;
+        mem_calloc(arg1, size, elem_size, align);
+        return;
+    }
+
+    // --- REALLOC nombre tamaño [ALIGN n] ---
+    if (strcmp(cmd, "REALLOC") == 0) {
+        if (count < 3) {
+            log_error("Línea %d: REALLOC requiere nombre y tamaño", line_number);
+            return;
+        }
+        if (!parse_align(count, keyword, value, extra, line_number, &align)) return;
+        mem_realloc(arg1, size, align);
+        return;
+    }
+
+    // Comando desconocido
+    log_error("Línea %d: comando '%s' no reconocido", line_number, cmd);
+}
+/**
+ * @brief Indica si un comando opera sobre variables (ALLOC, FREE, ...).
+ *
+ * Esas operaciones toman el cerrojo del heap compartido solo cuando lo
+ * necesitan; los demás comandos se ejecutan enteros con el cerrojo tomado.
+ *
+ * @param line Línea sin espacios al inicio.
+ * @return true si el primer token es un comando sobre variables.
+ */
+static bool variable_command(const char *line) {
+    static const char *const commands[] = {
+        "ALLOC", "CALLOC", "REALLOC", "FREE", "ALLOC_N", "FREE_PREFIX"
+    };
+    size_t len = strcspn(line, " \t");
+
+    for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+        if (strlen(commands[i]) == len && strncasecmp(line, commands[i], len) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Ejecuta todas las instrucciones de un flujo ya abierto.
+ *
+ * Procesa cada línea removiendo espacios en blanco y comentarios, y la
+ * ejecuta con `execute_line()`. Si el hilo comparte el heap con otros, los
+ * comandos que no operan sobre variables (PRINT, STATS, SLAB, GROW, ...)
+ * se ejecutan con el cerrojo del heap tomado.
  *
  * Manejo de errores:
- *   - Archivo inexistente.
  *   - Líneas con formato incorrecto.
  *   - Comandos desconocidos.
  *
- * @param path Ruta del archivo que contiene los comandos a procesar.
- * @return 0 si se ejecutó correctamente, -1 si ocurrió un error al abrir el archivo.
+ * @param f        Flujo de entrada; no se cierra.
+ * @param commands Recibe la cantidad de comandos ejecutados (puede ser NULL).
+ * @return 0 si el flujo se leyó completo, -1 si hubo un error de lectura.
  */
-int parser_execute_file(const char *path) {
-    FILE *f = fopen(path, "r");
-    if (!f) {
-        log_error("No se pudo abrir el archivo '%s'", path);
-        return -1;
-    }
-
+int parser_execute_stream(FILE *f, size_t *commands) {
     char buffer[MAX_LINE];
     int line_number = 0;
+    size_t executed = 0;
 
     while (fgets(buffer, sizeof(buffer), f)) {
         line_number++;
@@ -72,69 +423,37 @@ int parser_execute_file(const char *path) {
         if (line[0] == '#') continue;
 
         // Mostrar la línea actual para depuración
-        printf(">> %s\n", line);
-
-        // Buffers para tokens
-        char cmd[32];
-        char arg1[64];
-        size_t size = 0;
-
-        // Patrones esperados:
-        // ALLOC X 100
-        // REALLOC X 300
-        // FREE X
-        // PRINT
-        int count = sscanf(line, "%31s %63s %zu", cmd, arg1, &size);
-
-        if (count <= 0) {
-            log_error("Línea %d: comando inválido", line_number);
-            continue;
+        if (!log_quiet()) {
+            printf(">> %s\n", line);
         }
 
-        // Convertir comando a mayúsculas para manejo uniforme
-        for (int i = 0; cmd[i]; i++)
-            cmd[i] = toupper((unsigned char)cmd[i]);
-
-        // --- PRINT ---
-        if (strcmp(cmd, "PRINT") == 0) {
-            mem_print();
-            continue;
-        }
-
-        // --- FREE nombre ---
-        if (strcmp(cmd, "FREE") == 0) {
-            if (count < 2) {
-                log_error("Línea %d: FREE requiere un nombre", line_number);
-                continue;
-            }
-            mem_free(arg1);
-            continue;
-        }
-
-        // --- ALLOC nombre tamaño ---
-        if (strcmp(cmd, "ALLOC") == 0) {
-            if (count < 3) {
-                log_error("Línea %d: ALLOC requiere nombre y tamaño", line_number);
-                continue;
-            }
-            mem_alloc(arg1, size);
-            continue;
-        }
+        bool exclusive = !variable_command(line);
+        if (exclusive) sim_context_lock();
+        execute_line(line, line_number);
+        if (exclusive) sim_context_unlock();
+        executed++;
+    }
 
-        // --- REALLOC nombre tamaño ---
-        if (strcmp(cmd, "REALLOC") == 0) {
-            if (count < 3) {
-                log_error("Línea %d: REALLOC requiere nombre y tamaño", line_number);
-                continue;
-            }
-            mem_realloc(arg1, size);
-            continue;
-        }
+    if (commands) *commands = executed;
+    return ferror(f) ? -1 : 0;
+}
 
-        // Comando desconocido
-        log_error("Línea %d: comando '%s' no reconocido", line_number, cmd);
+/**
+ * @brief Ejecuta todas las instrucciones almacenadas en un archivo.
+ *
+ * Abre el archivo y lo procesa con `parser_execute_stream()`.
+ *
+ * @param path Ruta del archivo que contiene los comandos a procesar.
+ * @return 0 si se ejecutó correctamente, -1 si ocurrió un error al abrir el archivo.
+ */
+int parser_execute_file(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        log_error("No se pudo abrir el archivo '%s'", path);
+        return -1;
     }
 
+    int result = parser_execute_stream(f, NULL);
     fclose(f);
-    return 0;
+    return result;
 }
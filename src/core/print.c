@@ -12,12 +12,78 @@
 #include <stdio.h>
 #include "print.h"
 #include "blocks.h"
+#include "block_table.h"
+#include "allocator.h"
 #include "memory.h"
+#include "slab.h"
+
+/**
+ * @brief Cota superior en ns de la cubeta que contiene el percentil `pct`.
+ *
+ * @param s   Estadísticas del algoritmo.
+ * @param pct Percentil buscado (0-100).
+ * @return Límite superior de la cubeta, o 0 si no hay muestras.
+ */
+static unsigned long long latency_percentile(const AllocStats *s, unsigned pct) {
+    size_t samples = s->allocs + s->failures;
+    if (samples == 0) return 0;
+
+    /* Rango de la muestra buscada, redondeado hacia arriba */
+    size_t rank = (samples * pct + 99) / 100;
+    size_t seen = 0;
+
+    for (unsigned k = 0; k < ALLOC_LAT_BUCKETS; k++) {
+        seen += s->lat_hist[k];
+        if (seen >= rank) {
+            return (k + 1 < ALLOC_LAT_BUCKETS) ? (2ULL << k) - 1 : ~0ULL;
+        }
+    }
+    return s->lat_max_ns;
+}
+
+/**
+ * @struct HeapSummary
+ * @brief Totales acumulados al recorrer la arena.
+ */
+typedef struct {
+    size_t total;          /**< Bytes recorridos. */
+    size_t free_total;     /**< Bytes libres. */
+    size_t used_total;     /**< Bytes ocupados. */
+    size_t free_blocks;    /**< Segmentos libres. */
+    size_t internal_frag;  /**< Bytes reservados por encima de lo solicitado. */
+} HeapSummary;
+
+/**
+ * @brief Imprime un segmento de la arena y lo suma al resumen.
+ *
+ * @param b   Segmento visitado.
+ * @param ctx Resumen (`HeapSummary`).
+ */
+static void print_segment(const Block *b, void *ctx) {
+    HeapSummary *sum = ctx;
+
+    printf("  [offset=%zu size=%zu %s]\n",
+           b->offset,
+           b->size,
+           b->is_free ? "FREE" : (b->slab ? "SLAB" : "USED"));
+
+    sum->total += b->size;
+
+    if (b->is_free) {
+        sum->free_total += b->size;
+        sum->free_blocks++;
+    } else {
+        sum->used_total += b->size;
+        /* Con el heap compartido, otro hilo puede estar reutilizando el bloque */
+        sum->internal_frag += b->size - __atomic_load_n(&b->requested, __ATOMIC_RELAXED);
+    }
+}
 
 /**
  * @brief Imprime el estado completo del heap simulado.
  *
- * Recorre la lista enlazada de bloques de memoria administrados y muestra:
+ * Recorre los segmentos de la arena con `allocator_walk()` (la lista de
+ * bloques, o el recorrido propio del motor activo) y muestra:
  * - El offset (desplazamiento) del bloque dentro del heap.
  * - El tamaño del bloque en bytes.
  * - Si el bloque está marcado como libre (FREE) u ocupado (USED).
@@ -27,6 +93,11 @@
  * - Memoria actualmente usada.
  * - Memoria libre disponible.
  * - Cantidad total de bloques libres.
+ * - Fragmentación interna: bytes reservados por encima de lo solicitado
+ *   (distinta de cero solo en algoritmos que redondean, como buddy).
+ *
+ * Los bloques que respaldan slabs se muestran como SLAB y cuentan como
+ * memoria usada; sus ranuras se detallan con el comando STATS.
  *
  * Esta función se utiliza típicamente después de operaciones ALLOC, FREE,
  * REALLOC o en respuesta al comando PRINT del simulador.
@@ -35,39 +106,129 @@
  *       de lectura e impresión.
  */
 void mem_print(void) {
-    Block *b = memory_first_block();
-
-    size_t total = 0;
-    size_t free_total = 0;
-    size_t used_total = 0;
-    size_t free_blocks = 0;
+    HeapSummary sum = {0};
 
     printf("\n=== Estado del heap ===\n");
 
-    /* Recorremos todos los bloques administrados en la lista */
-    while (b) {
-        printf("  [offset=%zu size=%zu %s]\n",
-               b->offset,
-               b->size,
-               b->is_free ? "FREE" : "USED");
+    /* Recorremos todos los segmentos de la arena en orden de offset */
+    allocator_walk(print_segment, &sum);
 
-        total += b->size;
+    /* Resumen general del estado de memoria */
+    printf("\n--- Resumen ---\n");
+    printf("Memoria total:       %zu bytes\n", sum.total);
+    printf("Memoria usada:       %zu bytes\n", sum.used_total);
+    printf("Memoria libre:       %zu bytes\n", sum.free_total);
+    printf("Bloques libres:      %zu\n", sum.free_blocks);
+    printf("Frag. interna:       %zu bytes\n", sum.internal_frag);
+    printf("======================\n\n");
+}
 
-        if (b->is_free) {
-            free_total += b->size;
-            free_blocks++;
-        } else {
-            used_total += b->size;
-        }
+/**
+ * @brief Imprime contadores y latencias del algoritmo activo.
+ *
+ * Los percentiles se reportan como la cota superior de la cubeta log2 del
+ * histograma; la latencia máxima es exacta. También se muestra cuánto de la
+ * arena tiene memoria física asignada, cuánto creció, el máximo de bytes
+ * solicitados vivos a la vez, la ocupación del pool de descriptores
+ * `Block`, los metadatos del motor dentro y fuera de la arena, cómo se
+ * resolvieron los REALLOC y cuánto copiaron, las corridas y grupos de las
+ * operaciones en lote, cuánto limpió CALLOC, lo que atendieron las cachés
+ * de los hilos que comparten el heap, las divisiones y fusiones de bloques
+ * (y los barridos de la fusión diferida), y las filas de la tabla de
+ * bloques si está en uso. Se agregan las estadísticas propias del motor (si
+ * tiene) y, con la capa slab activa, la utilización de cada clase.
+ */
+void mem_print_stats(void) {
+    const AllocStats *s = allocator_stats();
+    const AllocEngine *engine = allocator_engine();
+
+    printf("\n=== Estadísticas del asignador ===\n");
+    printf("Motor:               %s\n", engine->name);
+    printf("Reservas:            %zu\n", s->allocs);
+    printf("Liberaciones:        %zu\n", s->frees);
+    printf("Reservas fallidas:   %zu\n", s->failures);
+    printf("Latencia p50:        <= %llu ns\n", latency_percentile(s, 50));
+    printf("Latencia p99:        <= %llu ns\n", latency_percentile(s, 99));
+    printf("Latencia máxima:     %llu ns\n", s->lat_max_ns);
 
-        b = b->next;
+    if (s->aligned) {
+        printf("Reservas alineadas:  %zu\n", s->aligned);
+        printf("Relleno separado:    %zu bytes\n", s->align_split);
+        printf("Relleno perdido:     %zu bytes\n", s->align_kept);
     }
 
-    /* Resumen general del estado de memoria */
-    printf("\n--- Resumen ---\n");
-    printf("Memoria total:       %zu bytes\n", total);
-    printf("Memoria usada:       %zu bytes\n", used_total);
-    printf("Memoria libre:       %zu bytes\n", free_total);
-    printf("Bloques libres:      %zu\n", free_blocks);
-    printf("======================\n\n");
+    printf("Arena residente:     %zu de %zu bytes\n", memory_resident(), memory_size());
+
+    const MemoryGrowthStats *growth = memory_growth();
+    if (growth->grows) {
+        printf("Crecimientos:        %zu (huella %zu -> %zu bytes)\n",
+               growth->grows, growth->initial, memory_size());
+    }
+    printf("Pico en uso:         %zu bytes\n", s->peak_in_use);
+
+    size_t live_nodes, reserved_nodes;
+    blocks_pool_usage(&live_nodes, &reserved_nodes);
+    printf("Nodos de bloque:     %zu en uso / %zu reservados\n", live_nodes, reserved_nodes);
+
+    AllocOverhead overhead;
+    allocator_overhead(&overhead);
+    printf("Metadatos:           %zu B en la arena, %zu B fuera\n",
+           overhead.in_arena, overhead.outside);
+
+    if (s->compactions) {
+        printf("Compactaciones:      %zu (%zu bytes movidos, %llu ns)\n",
+               s->compactions, s->compact_moved, s->compact_ns);
+    }
+
+    if (s->realloc_in_place + s->realloc_slid + s->realloc_moved) {
+        printf("REALLOC:             %zu en su lugar, %zu deslizados, %zu movidos"
+               " (%zu bytes copiados)\n",
+               s->realloc_in_place, s->realloc_slid, s->realloc_moved, s->realloc_copied);
+    }
+    if (s->alloc_runs + s->free_groups) {
+        printf("Lotes:               %zu corridas (%zu bloques), %zu grupos liberados"
+               " (%zu bloques)\n",
+               s->alloc_runs, s->run_blocks, s->free_groups, s->group_blocks);
+    }
+    if (s->callocs) {
+        printf("CALLOC:              %zu (%zu bytes, %zu limpiados, %zu ya en cero)\n",
+               s->callocs, s->calloc_bytes, s->calloc_zeroed,
+               s->calloc_bytes - s->calloc_zeroed);
+    }
+    if (s->cache_hits + s->cache_stores) {
+        printf("Cachés de hilo:      %zu reservas y %zu liberaciones sin cerrojo\n",
+               s->cache_hits, s->cache_stores);
+    }
+
+    size_t splits, joins;
+    blocks_churn(&splits, &joins);
+    printf("Divisiones:          %zu\n", splits);
+    printf("Fusiones:            %zu\n", joins);
+    if (s->coalesce_sweeps) {
+        printf("Barridos de fusión:  %zu\n", s->coalesce_sweeps);
+    }
+
+    if (blocks_table_active()) {
+        printf("Tabla de bloques:    %zu filas\n", block_table_rows());
+    }
+
+    if (engine->stats) {
+        printf("\n--- Motor ---\n");
+        engine->stats();
+    }
+
+    if (slab_enabled()) {
+        printf("\n--- Slabs ---\n");
+        for (size_t i = 0; i < slab_class_count(); i++) {
+            const SlabClassStats *c = slab_class_stats(i);
+            size_t total = c->slabs * c->slot_count;
+
+            printf("Clase %4zu B: %zu slabs, %zu/%zu ranuras (%.1f%%), %zu reservas\n",
+                   c->slot_size, c->slabs, c->slots_used, total,
+                   total ? 100.0 * (double)c->slots_used / (double)total : 0.0,
+                   c->allocs);
+        }
+        printf("Al asignador:        %zu reservas\n", slab_fallthrough());
+    }
+    printf("==================================\n\n");
 }
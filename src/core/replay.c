@@ -0,0 +1,250 @@
+/**
+ * @file replay.c
+ * @brief Implementación de la reproducción concurrente de archivos de
+ *        comandos.
+ *
+ * El hilo que llama es el dueño del heap: lee los archivos, crea un contexto
+ * compartido por hilo, arranca los hilos y, cuando todos terminaron, junta
+ * sus contadores y destruye los contextos. Cada hilo se enlaza a su
+ * contexto, ejecuta sus archivos desde memoria con `parser_execute_stream()`
+ * y, antes de salir, devuelve al heap los bloques de su caché.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <threads.h>
+#include <time.h>
+#include "replay.h"
+#include "parser.h"
+#include "variables.h"
+#include "log.h"
+
+/**
+ * @brief Contenido de un archivo de comandos leído por completo.
+ */
+typedef struct {
+    char *text;     /**< Bytes del archivo. */
+    size_t size;    /**< Cantidad de bytes. */
+} ReplayFile;
+
+/**
+ * @brief Trabajo y resultados de un hilo.
+ */
+typedef struct {
+    SimContext *ctx;            /**< Contexto compartido del hilo. */
+    const ReplayFile *files;    /**< Archivos leídos. */
+    size_t file_count;          /**< Cantidad de archivos. */
+    size_t first;               /**< Primer trabajo del hilo. */
+    size_t step;                /**< Distancia entre trabajos (cantidad de hilos). */
+    size_t jobs;                /**< Trabajos en total. */
+    size_t commands;            /**< Comandos ejecutados. */
+    size_t leaked;              /**< Variables vivas al terminar. */
+    MemCacheStats cache;        /**< Contadores de la caché del hilo. */
+    bool failed;                /**< Algún archivo no pudo ejecutarse. */
+} ReplayWorker;
+
+/**
+ * @brief Marca de tiempo actual en nanosegundos.
+ */
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Lee un archivo completo a memoria.
+ *
+ * @param path Ruta del archivo.
+ * @param out  Recibe el contenido.
+ * @return true si se leyó.
+ */
+static bool read_file(const char *path, ReplayFile *out) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        log_error("No se pudo abrir el archivo '%s'", path);
+        return false;
+    }
+
+    size_t cap = 4096, size = 0;
+    char *text = malloc(cap);
+    size_t got;
+
+    while (text && (got = fread(text + size, 1, cap - size, f)) > 0) {
+        size += got;
+        if (size == cap) {
+            char *bigger = realloc(text, cap * 2);
+            if (!bigger) {
+                free(text);
+                text = NULL;
+                break;
+            }
+            text = bigger;
+            cap *= 2;
+        }
+    }
+
+    bool ok = text && !ferror(f);
+    fclose(f);
+    if (!ok) {
+        log_error("No se pudo leer el archivo '%s'", path);
+        free(text);
+        return false;
+    }
+
+    out->text = text;
+    out->size = size;
+    return true;
+}
+
+/**
+ * @brief Cuenta una variable viva.
+ */
+static void count_variable(const char *name, Block *block, void *ctx) {
+    (void)name;
+    (void)block;
+    (*(size_t *)ctx)++;
+}
+
+/**
+ * @brief Cuerpo de cada hilo: ejecuta sus trabajos en su contexto.
+ *
+ * @param arg `ReplayWorker` del hilo.
+ * @return 0.
+ */
+static int replay_thread(void *arg) {
+    ReplayWorker *w = arg;
+
+    sim_context_bind(w->ctx);
+    log_set_quiet(true);
+    vars_init();
+
+    for (size_t j = w->first; j < w->jobs; j += w->step) {
+        const ReplayFile *file = &w->files[j % w->file_count];
+        size_t commands = 0;
+
+        if (file->size == 0) continue;
+
+        FILE *f = fmemopen(file->text, file->size, "r");
+        if (!f || parser_execute_stream(f, &commands) != 0) {
+            log_error("Error al reproducir el archivo %zu", j % w->file_count + 1);
+            w->failed = true;
+        }
+        if (f) fclose(f);
+        w->commands += commands;
+    }
+
+    vars_visit(count_variable, &w->leaked);
+    mem_cache_flush();
+    w->cache = mem_cache_stats();
+
+    log_set_quiet(false);
+    sim_context_bind(NULL);
+    return 0;
+}
+
+/**
+ * @brief Reproduce archivos de comandos en varios hilos sobre el heap del
+ *        contexto actual.
+ *
+ * @param paths   Archivos de comandos.
+ * @param count   Cantidad de archivos.
+ * @param threads Cantidad de hilos.
+ * @param report  Recibe el resultado.
+ * @return true si todos los archivos se leyeron y todos los hilos corrieron.
+ */
+bool replay_run(const char *const *paths, size_t count, size_t threads, ReplayReport *report) {
+    SimContext *heap = sim_context_current();
+    ReplayFile *files = calloc(count, sizeof(*files));
+    ReplayWorker *workers = calloc(threads, sizeof(*workers));
+    thrd_t *ids = calloc(threads, sizeof(*ids));
+    size_t jobs = threads > count ? threads : count;
+    size_t loaded = 0, created = 0;
+    bool ok = files && workers && ids;
+
+    if (!ok) {
+        log_error("Error: sin memoria para la reproducción concurrente");
+    }
+    while (ok && loaded < count && read_file(paths[loaded], &files[loaded])) {
+        loaded++;
+    }
+    ok = ok && loaded == count;
+
+    for (size_t t = 0; ok && t < threads; t++) {
+        workers[t] = (ReplayWorker){ .files = files, .file_count = count,
+                                     .first = t, .step = threads, .jobs = jobs };
+        workers[t].ctx = sim_context_create_shared(heap);
+        ok = workers[t].ctx != NULL;
+    }
+
+    *report = (ReplayReport){ .threads = threads };
+    uint64_t start = now_ns();
+
+    while (ok && created < threads) {
+        if (thrd_create(&ids[created], replay_thread, &workers[created]) != thrd_success) {
+            log_error("Error: no se pudo crear el hilo %zu", created + 1);
+            ok = false;
+            break;
+        }
+        created++;
+    }
+    for (size_t t = 0; t < created; t++) {
+        thrd_join(ids[t], NULL);
+    }
+    report->elapsed_ns = now_ns() - start;
+
+    for (size_t t = 0; workers && t < threads; t++) {
+        ReplayWorker *w = &workers[t];
+
+        report->commands += w->commands;
+        report->leaked += w->leaked;
+        report->cache.hits += w->cache.hits;
+        report->cache.misses += w->cache.misses;
+        report->cache.stores += w->cache.stores;
+        report->cache.flushes += w->cache.flushes;
+        ok = ok && !w->failed;
+    }
+    report->lock = sim_context_lock_stats(heap);
+
+    for (size_t t = 0; workers && t < threads; t++) {
+        sim_context_destroy(workers[t].ctx);
+    }
+    for (size_t i = 0; i < loaded; i++) {
+        free(files[i].text);
+    }
+    free(files);
+    free(workers);
+    free(ids);
+    return ok;
+}
+
+/**
+ * @brief Imprime el rendimiento y el uso del cerrojo de una reproducción.
+ *
+ * @param report Resultado de `replay_run()`.
+ */
+void replay_print_report(const ReplayReport *report) {
+    double seconds = (double)report->elapsed_ns / 1e9;
+    const SimLockStats *lock = &report->lock;
+    const MemCacheStats *cache = &report->cache;
+
+    printf("\n=== Reproducción concurrente ===\n");
+    printf("Hilos:               %zu\n", report->threads);
+    printf("Comandos:            %zu\n", report->commands);
+    printf("Tiempo:              %.3f ms\n", seconds * 1e3);
+    printf("Rendimiento:         %.0f comandos/s\n",
+           seconds > 0 ? (double)report->commands / seconds : 0.0);
+    printf("Cerrojo:             %zu tomas, %zu disputadas (%.1f%%), %.3f ms de espera\n",
+           lock->acquisitions, lock->contended,
+           lock->acquisitions ? 100.0 * (double)lock->contended / (double)lock->acquisitions : 0.0,
+           (double)lock->wait_ns / 1e6);
+    if (cache->hits + cache->misses + cache->stores) {
+        printf("Cachés de hilo:      %zu aciertos, %zu fallos, %zu guardados,"
+               " %zu devueltos al heap\n",
+               cache->hits, cache->misses, cache->stores, cache->flushes);
+    }
+    printf("Variables vivas:     %zu\n", report->leaked);
+    printf("================================\n\n");
+}
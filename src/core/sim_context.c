@@ -0,0 +1,242 @@
+/**
+ * @file sim_context.c
+ * @brief Implementación de los contextos de simulación.
+ *
+ * Un contexto es un arreglo de punteros, uno por módulo, al estado que ese
+ * módulo guardaba antes en variables `static`. Cada módulo define una
+ * estructura con su estado y su valor inicial, y la obtiene con
+ * `sim_context_state()` al comienzo de cada operación; el estado se crea
+ * la primera vez que se pide en un contexto.
+ *
+ * El contexto de cada hilo se guarda en una variable `_Thread_local`, así
+ * que enlazar contextos distintos en hilos distintos no requiere
+ * sincronización. Los hilos sin contexto enlazado comparten el contexto
+ * por defecto.
+ *
+ * Un contexto compartido guarda en `heap` el contexto dueño del heap y solo
+ * tiene estado propio en las ranuras privadas (variables y caché); las demás
+ * se resuelven en el dueño. El dueño tiene el cerrojo, que existe mientras
+ * haya contextos compartiéndolo. La profundidad de anidamiento del cerrojo
+ * es por hilo, así que una operación puede llamar a otras que también lo
+ * toman.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+#include <time.h>
+#include "sim_context.h"
+#include "memory.h"
+#include "variables.h"
+#include "log.h"
+
+/**
+ * @struct SimContext
+ * @brief Estado de cada módulo, creado al primer uso.
+ */
+struct SimContext {
+    void *state[SIM_STATE_COUNT];   /**< Estado por módulo, o NULL. */
+    SimContext *heap;               /**< Dueño del heap si es compartido, o NULL. */
+    size_t sharers;                 /**< Contextos que comparten este heap. */
+    mtx_t lock;                     /**< Cerrojo del heap (con `sharers` > 0). */
+    SimLockStats lock_stats;        /**< Uso del cerrojo. */
+};
+
+/** @brief Contexto de los hilos que no enlazaron otro. */
+static SimContext default_context;
+
+/** @brief Contexto enlazado al hilo actual (NULL = por defecto). */
+static _Thread_local SimContext *bound = NULL;
+
+/** @brief Tomas anidadas del cerrojo en el hilo actual. */
+static _Thread_local unsigned lock_depth = 0;
+
+/**
+ * @brief Indica si una ranura es propia de cada contexto compartido.
+ */
+static bool slot_private(SimStateSlot slot) {
+    return slot == SIM_STATE_VARIABLES || slot == SIM_STATE_CACHE;
+}
+
+/**
+ * @brief Marca de tiempo actual en nanosegundos.
+ */
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Crea un contexto sin estado.
+ *
+ * @return Contexto nuevo, o NULL si no hay memoria.
+ */
+SimContext *sim_context_create(void) {
+    SimContext *ctx = calloc(1, sizeof(*ctx));
+    if (!ctx) {
+        log_error("Error: no se pudo crear el contexto de simulación");
+    }
+    return ctx;
+}
+
+/**
+ * @brief Crea un contexto con variables y caché propias sobre otro heap.
+ *
+ * El primer contexto que comparte `heap` crea su cerrojo y reinicia sus
+ * contadores.
+ *
+ * @param heap Contexto dueño del heap, o NULL para el contexto por defecto.
+ * @return Contexto nuevo, o NULL si no se pudo crear.
+ */
+SimContext *sim_context_create_shared(SimContext *heap) {
+    if (!heap) heap = &default_context;
+    if (heap->heap) {
+        log_error("Error: un contexto compartido no puede compartirse otra vez");
+        return NULL;
+    }
+
+    SimContext *ctx = sim_context_create();
+    if (!ctx) return NULL;
+
+    if (heap->sharers == 0) {
+        if (mtx_init(&heap->lock, mtx_plain) != thrd_success) {
+            log_error("Error: no se pudo crear el cerrojo del heap compartido");
+            free(ctx);
+            return NULL;
+        }
+        memset(&heap->lock_stats, 0, sizeof(heap->lock_stats));
+    }
+    heap->sharers++;
+    ctx->heap = heap;
+    return ctx;
+}
+
+/**
+ * @brief Libera la simulación de un contexto y el estado de sus módulos.
+ *
+ * De un contexto compartido se liberan solo las variables y el estado
+ * privado; el último en irse destruye el cerrojo del dueño.
+ *
+ * @param ctx Contexto creado con `sim_context_create()` o
+ *            `sim_context_create_shared()`.
+ */
+void sim_context_destroy(SimContext *ctx) {
+    if (!ctx || ctx == &default_context) return;
+
+    SimContext *prev = sim_context_bind(ctx);
+    vars_destroy();
+    if (!ctx->heap) {
+        memory_destroy();
+    }
+    sim_context_bind(prev == ctx ? NULL : prev);
+
+    for (size_t i = 0; i < SIM_STATE_COUNT; i++) {
+        free(ctx->state[i]);
+    }
+    if (ctx->heap && --ctx->heap->sharers == 0) {
+        mtx_destroy(&ctx->heap->lock);
+    }
+    free(ctx);
+}
+
+/**
+ * @brief Enlaza el hilo actual a un contexto.
+ *
+ * @param ctx Contexto, o NULL para el contexto por defecto.
+ * @return Contexto enlazado antes.
+ */
+SimContext *sim_context_bind(SimContext *ctx) {
+    SimContext *prev = bound;
+    bound = ctx == &default_context ? NULL : ctx;
+    return prev;
+}
+
+/**
+ * @brief Contexto del hilo actual.
+ */
+SimContext *sim_context_current(void) {
+    return bound ? bound : &default_context;
+}
+
+/**
+ * @brief Estado de un módulo en el contexto actual, creado si hace falta.
+ *
+ * Las ranuras compartidas se resuelven en el dueño del heap; si el estado
+ * todavía no existe ahí, se crea con el cerrojo tomado, porque otro hilo
+ * puede estar pidiéndolo a la vez.
+ *
+ * @param slot    Ranura del módulo.
+ * @param initial Valor inicial del estado.
+ * @param size    Tamaño del estado.
+ * @return Estado del módulo.
+ */
+void *sim_context_state(SimStateSlot slot, const void *initial, size_t size) {
+    SimContext *ctx = bound ? bound : &default_context;
+    bool shared = ctx->heap && !slot_private(slot);
+
+    if (shared) ctx = ctx->heap;
+
+    void *state = __atomic_load_n(&ctx->state[slot], __ATOMIC_ACQUIRE);
+    if (state) return state;
+
+    if (shared) sim_context_lock();
+    state = ctx->state[slot];
+    if (!state) {
+        state = malloc(size);
+        if (!state) {
+            log_error("Error: no se pudo crear el estado del contexto de simulación");
+            exit(1);
+        }
+        memcpy(state, initial, size);
+        __atomic_store_n(&ctx->state[slot], state, __ATOMIC_RELEASE);
+    }
+    if (shared) sim_context_unlock();
+    return state;
+}
+
+/**
+ * @brief Indica si el contexto del hilo actual comparte otro heap.
+ */
+bool sim_context_shared(void) {
+    return bound && bound->heap;
+}
+
+/**
+ * @brief Toma el cerrojo del heap compartido del contexto actual.
+ *
+ * Primero lo intenta sin bloquear; si otro hilo lo tiene, la toma cuenta
+ * como disputada y se mide la espera.
+ */
+void sim_context_lock(void) {
+    SimContext *ctx = bound;
+    if (!ctx || !ctx->heap || lock_depth++ > 0) return;
+
+    SimContext *heap = ctx->heap;
+    if (mtx_trylock(&heap->lock) != thrd_success) {
+        uint64_t start = now_ns();
+        mtx_lock(&heap->lock);
+        heap->lock_stats.contended++;
+        heap->lock_stats.wait_ns += now_ns() - start;
+    }
+    heap->lock_stats.acquisitions++;
+}
+
+/**
+ * @brief Suelta el cerrojo del heap compartido del contexto actual.
+ */
+void sim_context_unlock(void) {
+    SimContext *ctx = bound;
+    if (!ctx || !ctx->heap || --lock_depth > 0) return;
+
+    mtx_unlock(&ctx->heap->lock);
+}
+
+/**
+ * @brief Contadores del cerrojo de un heap.
+ *
+ * @param heap Dueño del heap, o NULL para el contexto por defecto.
+ */
+SimLockStats sim_context_lock_stats(SimContext *heap) {
+    return (heap ? heap : &default_context)->lock_stats;
+}
@@ -0,0 +1,431 @@
+/**
+ * @file slab.c
+ * @brief Implementación de la capa slab para reservas pequeñas.
+ *
+ * Cada clase de tamaño mantiene dos listas de slabs: los que tienen ranuras
+ * libres (`partial`) y los llenos (`full`). Reservar toma la ranura libre
+ * de menor índice del primer slab parcial con una instrucción `ctz`; liberar
+ * enciende su bit. Ninguna de las dos operaciones toca la lista general.
+ *
+ * Los slabs se obtienen con `allocator_alloc()`, de modo que funcionan sobre
+ * cualquier algoritmo activo. El bloque de la arena de cada slab queda
+ * marcado con su campo `slab` para distinguirlo al imprimir el heap.
+ */
+
+#include <stdlib.h>
+#include "slab.h"
+#include "sim_context.h"
+#include "allocator.h"
+#include "log.h"
+
+/**
+ * @struct Slab
+ * @brief Bloque de la arena dividido en ranuras de una misma clase.
+ */
+typedef struct Slab {
+    Block *chunk;              /**< Bloque de la lista general que respalda el slab. */
+    unsigned long long free_mask; /**< Bit `i` encendido si la ranura `i` está libre. */
+    size_t used;               /**< Ranuras ocupadas. */
+    size_t cls;                /**< Índice de la clase. */
+    Block *slots;              /**< Descriptores de las ranuras. */
+    struct Slab *next;         /**< Siguiente slab en la lista de su clase. */
+    struct Slab *prev;         /**< Slab anterior en la lista de su clase. */
+} Slab;
+
+/**
+ * @struct SlabClass
+ * @brief Estado de una clase de tamaño.
+ */
+typedef struct {
+    SlabClassStats stats;  /**< Configuración y ocupación. */
+    Slab *partial;         /**< Slabs con al menos una ranura libre. */
+    Slab *full;            /**< Slabs sin ranuras libres. */
+} SlabClass;
+
+/* ------------------------------------------------------------------------- */
+/*                             ESTADO POR CONTEXTO                           */
+/* ------------------------------------------------------------------------- */
+
+/** @brief Clases por defecto. */
+static const size_t default_classes[] = {16, 32, 64, 128};
+
+/**
+ * @brief Capa slab de un contexto de simulación.
+ */
+typedef struct {
+    /** @brief Clases configuradas, en orden creciente de tamaño. */
+    SlabClass classes[SLAB_MAX_CLASSES];
+
+    /** @brief Cantidad de clases configuradas (0 = capa inactiva). */
+    size_t class_count;
+
+    /** @brief Reservas que pasaron al asignador general. */
+    size_t fallthrough;
+} SlabState;
+
+/** @brief Capa de un contexto nuevo: inactiva. */
+static const SlabState initial = { 0 };
+
+/**
+ * @brief Capa slab del contexto del hilo actual.
+ */
+static SlabState *state(void) {
+    return sim_context_state(SIM_STATE_SLAB, &initial, sizeof(initial));
+}
+
+/* ------------------------------------------------------------------------- */
+/*                           FUNCIONES AUXILIARES                            */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Inserta un slab al inicio de una lista.
+ */
+static void slab_list_push(Slab **head, Slab *s) {
+    s->prev = NULL;
+    s->next = *head;
+    if (*head) {
+        (*head)->prev = s;
+    }
+    *head = s;
+}
+
+/**
+ * @brief Retira un slab de una lista.
+ */
+static void slab_list_remove(Slab **head, Slab *s) {
+    if (s->prev) {
+        s->prev->next = s->next;
+    } else {
+        *head = s->next;
+    }
+    if (s->next) {
+        s->next->prev = s->prev;
+    }
+    s->next = NULL;
+    s->prev = NULL;
+}
+
+/**
+ * @brief Menor clase cuyas ranuras contienen `size` bytes.
+ *
+ * @return Clase encontrada, o NULL si `size` supera la mayor clase.
+ */
+static SlabClass *class_for(size_t size) {
+    SlabState *st = state();
+    for (size_t i = 0; i < st->class_count; i++) {
+        if (size <= st->classes[i].stats.slot_size) {
+            return &st->classes[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Reserva un bloque de la arena y lo divide en ranuras libres.
+ *
+ * @param cls Índice de la clase.
+ * @return Slab nuevo en la lista parcial de su clase, o NULL.
+ */
+static Slab *slab_create(size_t cls) {
+    SlabClass *c = &state()->classes[cls];
+    size_t slot_size = c->stats.slot_size;
+    size_t count = c->stats.slot_count;
+
+    Slab *s = malloc(sizeof(Slab));
+    Block *slots = calloc(count, sizeof(Block));
+    if (!s || !slots) {
+        log_error("Error: malloc falló en slab_create()");
+        free(s);
+        free(slots);
+        return NULL;
+    }
+
+    Block *chunk = allocator_alloc(slot_size * count);
+    if (!chunk) {
+        free(s);
+        free(slots);
+        return NULL;
+    }
+    chunk->slab = s;
+
+    for (size_t i = 0; i < count; i++) {
+        slots[i].offset = chunk->offset + i * slot_size;
+        slots[i].size = slot_size;
+        slots[i].requested = 0;
+        slots[i].is_free = true;
+        slots[i].slab = s;
+    }
+
+    s->chunk = chunk;
+    s->free_mask = (count == SLAB_MAX_SLOTS) ? ~0ULL : (1ULL << count) - 1;
+    s->used = 0;
+    s->cls = cls;
+    s->slots = slots;
+
+    slab_list_push(&c->partial, s);
+    c->stats.slabs++;
+    return s;
+}
+
+/**
+ * @brief Devuelve el bloque de un slab vacío a la arena y libera el slab.
+ */
+static void slab_release(Slab *s) {
+    SlabClass *c = &state()->classes[s->cls];
+
+    slab_list_remove(&c->partial, s);
+    c->stats.slabs--;
+
+    s->chunk->slab = NULL;
+    allocator_free(s->chunk);
+
+    free(s->slots);
+    free(s);
+}
+
+/**
+ * @brief Libera los descriptores de una lista de slabs.
+ */
+static void slab_list_destroy(Slab *s) {
+    while (s) {
+        Slab *next = s->next;
+        free(s->slots);
+        free(s);
+        s = next;
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+/*                              CICLO DE VIDA                                */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Configura las clases de tamaño y activa la capa.
+ *
+ * @param classes_in Tamaños en orden creciente, o NULL para los de defecto.
+ * @param count      Cantidad de clases.
+ * @return true si la capa quedó activa.
+ */
+bool slab_enable(const size_t *classes_in, size_t count) {
+    SlabState *st = state();
+    if (!classes_in) {
+        classes_in = default_classes;
+        count = sizeof(default_classes) / sizeof(default_classes[0]);
+    }
+
+    if (count == 0 || count > SLAB_MAX_CLASSES) {
+        log_error("SLAB: se requieren entre 1 y %d clases", SLAB_MAX_CLASSES);
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (classes_in[i] == 0 || classes_in[i] > SLAB_CHUNK_SIZE / 2 ||
+            (i > 0 && classes_in[i] <= classes_in[i - 1])) {
+            log_error("SLAB: clase inválida (%zu bytes); deben ser crecientes y <= %d",
+                      classes_in[i], SLAB_CHUNK_SIZE / 2);
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < st->class_count; i++) {
+        if (st->classes[i].stats.slabs) {
+            log_error("SLAB: no se puede reconfigurar con slabs reservados");
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        size_t slots = SLAB_CHUNK_SIZE / classes_in[i];
+
+        st->classes[i].stats = (SlabClassStats){
+            .slot_size  = classes_in[i],
+            .slot_count = slots > SLAB_MAX_SLOTS ? SLAB_MAX_SLOTS : slots,
+        };
+        st->classes[i].partial = NULL;
+        st->classes[i].full = NULL;
+    }
+    st->class_count = count;
+    st->fallthrough = 0;
+
+    log_info("Capa slab activada (%zu clases, hasta %zu bytes)",
+             count, classes_in[count - 1]);
+    return true;
+}
+
+/**
+ * @brief Indica si la capa slab está activa.
+ */
+bool slab_enabled(void) {
+    return state()->class_count > 0;
+}
+
+/**
+ * @brief Libera los descriptores de todos los slabs.
+ */
+void slab_destroy(void) {
+    SlabState *st = state();
+    for (size_t i = 0; i < st->class_count; i++) {
+        slab_list_destroy(st->classes[i].partial);
+        slab_list_destroy(st->classes[i].full);
+        st->classes[i].partial = NULL;
+        st->classes[i].full = NULL;
+    }
+    st->class_count = 0;
+    st->fallthrough = 0;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                                OPERACIONES                                */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Reserva una ranura, creando un slab si la clase no tiene libres.
+ *
+ * @param size Tamaño solicitado.
+ * @return Ranura ocupada, o NULL.
+ */
+Block *slab_alloc(size_t size) {
+    SlabState *st = state();
+    if (!st->class_count) return NULL;
+
+    SlabClass *c = class_for(size);
+    Slab *s = c ? c->partial : NULL;
+
+    if (c && !s) {
+        s = slab_create((size_t)(c - st->classes));
+    }
+    if (!s) {
+        st->fallthrough++;
+        return NULL;
+    }
+
+    unsigned i = (unsigned)__builtin_ctzll(s->free_mask);
+    s->free_mask &= ~(1ULL << i);
+    s->used++;
+
+    if (!s->free_mask) {
+        slab_list_remove(&c->partial, s);
+        slab_list_push(&c->full, s);
+    }
+
+    c->stats.slots_used++;
+    c->stats.allocs++;
+
+    Block *slot = &s->slots[i];
+    slot->is_free = false;
+    slot->requested = size;
+    return slot;
+}
+
+/**
+ * @brief Libera una ranura y, si su slab queda vacío, lo devuelve a la
+ *        arena cuando la clase conserva otro slab parcial.
+ *
+ * @param slot Ranura ocupada.
+ */
+void slab_free(Block *slot) {
+    if (!slot || slot->is_free) return;
+
+    Slab *s = slot->slab;
+    SlabClass *c = &state()->classes[s->cls];
+    size_t i = (size_t)(slot - s->slots);
+
+    if (!s->free_mask) {
+        slab_list_remove(&c->full, s);
+        slab_list_push(&c->partial, s);
+    }
+
+    s->free_mask |= 1ULL << i;
+    s->used--;
+    c->stats.slots_used--;
+
+    slot->is_free = true;
+    slot->requested = 0;
+
+    /* Conservar un slab vacío por clase evita reservar y devolver bloques
+     * de la arena cuando la ocupación oscila alrededor de un slab lleno. */
+    if (s->used == 0 && (c->partial != s || s->next)) {
+        slab_release(s);
+    }
+}
+
+/**
+ * @brief Redimensiona una ranura dentro de su tamaño fijo.
+ *
+ * @param slot     Ranura ocupada.
+ * @param new_size Nuevo tamaño solicitado.
+ * @return true si cabe en la ranura.
+ */
+bool slab_resize(Block *slot, size_t new_size) {
+    if (new_size > slot->size) return false;
+
+    slot->requested = new_size;
+    return true;
+}
+
+/**
+ * @brief Recalcula los offsets de las ranuras de un slab cuyo bloque se movió.
+ *
+ * @param chunk Bloque que respalda el slab, ya con su offset nuevo.
+ */
+void slab_moved(Block *chunk) {
+    SlabState *st = state();
+    Slab *s = chunk->slab;
+    size_t slot_size = st->classes[s->cls].stats.slot_size;
+
+    for (size_t i = 0; i < st->classes[s->cls].stats.slot_count; i++) {
+        s->slots[i].offset = chunk->offset + i * slot_size;
+    }
+}
+
+/**
+ * @brief Devuelve a la arena los slabs vacíos de todas las clases.
+ *
+ * @return Cantidad de slabs devueltos.
+ */
+size_t slab_reclaim(void) {
+    SlabState *st = state();
+    size_t released = 0;
+
+    for (size_t i = 0; i < st->class_count; i++) {
+        Slab *s = st->classes[i].partial;
+        while (s) {
+            Slab *next = s->next;
+            if (s->used == 0) {
+                slab_release(s);
+                released++;
+            }
+            s = next;
+        }
+    }
+    return released;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                               ESTADÍSTICAS                                */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Cantidad de clases configuradas.
+ */
+size_t slab_class_count(void) {
+    return state()->class_count;
+}
+
+/**
+ * @brief Ocupación de una clase.
+ *
+ * @param idx Índice de la clase.
+ * @return Estadísticas de la clase, o NULL.
+ */
+const SlabClassStats *slab_class_stats(size_t idx) {
+    SlabState *st = state();
+    return idx < st->class_count ? &st->classes[idx].stats : NULL;
+}
+
+/**
+ * @brief Reservas que pasaron al asignador general.
+ */
+size_t slab_fallthrough(void) {
+    return state()->fallthrough;
+}
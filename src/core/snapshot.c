@@ -0,0 +1,613 @@
+/**
+ * @file snapshot.c
+ * @brief Escritura y restauración de instantáneas del heap simulado.
+ *
+ * El archivo tiene cuatro secciones, con enteros en el orden de bytes de la
+ * máquina que lo escribió:
+ *
+ *  - Cabecera (`SnapshotHeader`): identificador, versión, tamaños y motor.
+ *  - Bloques, como arreglos paralelos en orden de offset: tamaños,
+ *    bytes solicitados, bytes en cero de CALLOC, marcas de libre y
+ *    alineaciones. Los offsets no se
+ *    guardan porque la lista cubre la arena sin huecos.
+ *  - Variables: el índice del bloque de cada una y sus nombres terminados
+ *    en '\0', en el orden de la tabla.
+ *  - Arena, desde un offset alineado a página y rellenada hasta la página
+ *    siguiente, para que `memory_init_image()` pueda mapearla directamente.
+ *
+ * Al restaurar, el archivo completo se mapea en memoria y los arreglos se
+ * usan en su lugar: se validan, y `blocks_restore()` arma la lista con ellos
+ * en una sola pasada. El heap actual solo se descarta cuando el archivo
+ * pasó todas las validaciones.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "snapshot.h"
+#include "memory.h"
+#include "blocks.h"
+#include "allocator.h"
+#include "variables.h"
+#include "slab.h"
+#include "sim_context.h"
+#include "log.h"
+
+/** @brief Identificador al inicio del archivo (incluye el '\0'). */
+#define SNAPSHOT_MAGIC "MEMSNAP"
+
+/** @brief Versión del formato. */
+#define SNAPSHOT_VERSION 2u
+
+/** @brief Bytes reservados para el nombre del motor (incluye el '\0'). */
+#define SNAPSHOT_ENGINE_MAX 32
+
+/**
+ * @struct SnapshotHeader
+ * @brief Cabecera del archivo.
+ */
+typedef struct {
+    char     magic[8];                      /**< `SNAPSHOT_MAGIC`. */
+    uint32_t version;                       /**< `SNAPSHOT_VERSION`. */
+    uint32_t word_size;                     /**< `sizeof(size_t)` del escritor. */
+    size_t   arena_size;                    /**< Bytes de la arena. */
+    size_t   arena_offset;                  /**< Posición de la arena en el archivo. */
+    size_t   block_count;                   /**< Bloques de la lista. */
+    size_t   var_count;                     /**< Variables registradas. */
+    size_t   names_size;                    /**< Bytes de los nombres, con sus '\0'. */
+    char     engine[SNAPSHOT_ENGINE_MAX];   /**< Motor de asignación activo. */
+} SnapshotHeader;
+
+/**
+ * @struct SnapshotLayout
+ * @brief Posición de cada sección de metadatos en el archivo.
+ */
+typedef struct {
+    size_t sizes;         /**< `size_t[block_count]`. */
+    size_t requested;     /**< `size_t[block_count]`. */
+    size_t zeroed;        /**< `size_t[block_count]`. */
+    size_t free_flags;    /**< `unsigned char[block_count]`. */
+    size_t align_shifts;  /**< `unsigned char[block_count]`. */
+    size_t var_blocks;    /**< `size_t[var_count]`, alineado a `size_t`. */
+    size_t names;         /**< `char[names_size]`. */
+    size_t end;           /**< Fin de los metadatos. */
+} SnapshotLayout;
+
+/**
+ * @struct SnapshotImage
+ * @brief Instantánea mapeada y validada.
+ */
+typedef struct {
+    const SnapshotHeader *header;       /**< Cabecera. */
+    const size_t *sizes;                /**< Tamaño de cada bloque. */
+    const size_t *requested;            /**< Bytes solicitados de cada bloque. */
+    const size_t *zeroed;               /**< Bytes iniciales en cero de CALLOC. */
+    const unsigned char *free_flags;    /**< Marca de libre de cada bloque. */
+    const unsigned char *align_shifts;  /**< Alineación de cada bloque. */
+    const size_t *var_blocks;           /**< Bloque de cada variable. */
+    const char *names;                  /**< Nombres de las variables. */
+    const char **name_at;               /**< Inicio del nombre de cada variable (reservado). */
+    const AllocEngine *engine;          /**< Motor registrado con ese nombre. */
+    size_t in_use;                      /**< Bytes solicitados en uso. */
+} SnapshotImage;
+
+/* ------------------------------------------------------------------------- */
+/*                           FUNCIONES AUXILIARES                            */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Marca de tiempo actual en nanosegundos.
+ */
+static unsigned long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+/**
+ * @brief Avanza `*pos` en `count` elementos de `elem` bytes.
+ *
+ * @return false si el resultado no cabe en `size_t`.
+ */
+static bool advance(size_t *pos, size_t count, size_t elem) {
+    if (count > (SIZE_MAX - *pos) / elem) return false;
+    *pos += count * elem;
+    return true;
+}
+
+/**
+ * @brief Redondea `*pos` hacia arriba a un múltiplo de `unit` (potencia de dos).
+ *
+ * @return false si el resultado no cabe en `size_t`.
+ */
+static bool align_up(size_t *pos, size_t unit) {
+    if (*pos > SIZE_MAX - (unit - 1)) return false;
+    *pos = (*pos + unit - 1) & ~(unit - 1);
+    return true;
+}
+
+/**
+ * @brief Calcula la posición de cada sección a partir de la cabecera.
+ *
+ * @return false si algún tamaño desborda `size_t`.
+ */
+static bool snapshot_layout(const SnapshotHeader *h, SnapshotLayout *out) {
+    size_t pos = sizeof(SnapshotHeader);
+
+    out->sizes = pos;
+    if (!advance(&pos, h->block_count, sizeof(size_t))) return false;
+    out->requested = pos;
+    if (!advance(&pos, h->block_count, sizeof(size_t))) return false;
+    out->zeroed = pos;
+    if (!advance(&pos, h->block_count, sizeof(size_t))) return false;
+    out->free_flags = pos;
+    if (!advance(&pos, h->block_count, 1)) return false;
+    out->align_shifts = pos;
+    if (!advance(&pos, h->block_count, 1)) return false;
+    if (!align_up(&pos, sizeof(size_t))) return false;
+    out->var_blocks = pos;
+    if (!advance(&pos, h->var_count, sizeof(size_t))) return false;
+    out->names = pos;
+    if (!advance(&pos, h->names_size, 1)) return false;
+    out->end = pos;
+    return true;
+}
+
+/**
+ * @brief Indica si el motor guarda todo su estado en la lista de bloques.
+ */
+static bool engine_uses_list(const AllocEngine *engine) {
+    return !engine->init && !engine->walk;
+}
+
+/**
+ * @brief Escribe `size` bytes completos en la posición `offset` del archivo.
+ */
+static bool write_at(int fd, const void *buf, size_t size, size_t offset) {
+    const unsigned char *src = buf;
+
+    while (size > 0) {
+        ssize_t put = pwrite(fd, src, size, (off_t)offset);
+        if (put <= 0) return false;
+        src += put;
+        offset += (size_t)put;
+        size -= (size_t)put;
+    }
+    return true;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                               ESCRITURA                                   */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @struct VarWriter
+ * @brief Estado de `vars_visit()` al escribir las variables.
+ */
+typedef struct {
+    Block *const *order;  /**< Bloques de la lista en orden de offset. */
+    size_t block_count;   /**< Cantidad de bloques en `order`. */
+    size_t *var_blocks;   /**< Destino de los índices (NULL al contar). */
+    char *names;          /**< Destino de los nombres (NULL al contar). */
+    size_t count;         /**< Variables visitadas. */
+    size_t names_size;    /**< Bytes de nombres visitados. */
+    bool ok;              /**< false si alguna variable no está en la lista. */
+} VarWriter;
+
+/**
+ * @brief Posición de un bloque en la lista, por búsqueda binaria del offset.
+ *
+ * @return El índice, o SIZE_MAX si el bloque no pertenece a la lista.
+ */
+static size_t block_index(Block *const *order, size_t count, const Block *block) {
+    size_t lo = 0, hi = count;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (order[mid]->offset < block->offset) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo < count && order[lo] == block ? lo : SIZE_MAX;
+}
+
+/**
+ * @brief Cuenta una variable o copia su bloque y nombre.
+ */
+static void write_var(const char *name, Block *block, void *ctx) {
+    VarWriter *w = ctx;
+    size_t len = strlen(name) + 1;
+
+    if (w->var_blocks) {
+        size_t idx = block_index(w->order, w->block_count, block);
+        if (idx == SIZE_MAX) {
+            log_error("SNAPSHOT: la variable '%s' no apunta a un bloque de la lista", name);
+            w->ok = false;
+            idx = 0;
+        }
+        w->var_blocks[w->count] = idx;
+        memcpy(w->names + w->names_size, name, len);
+    }
+    w->count++;
+    w->names_size += len;
+}
+
+/**
+ * @brief Escribe la cabecera, los bloques, las variables y la arena.
+ *
+ * Los metadatos se arman en un búfer y se escriben de una vez; la arena se
+ * escribe directamente desde su mapeo.
+ *
+ * @param path Ruta del archivo.
+ * @return true si la instantánea quedó escrita.
+ */
+bool snapshot_save(const char *path) {
+    unsigned long long t0 = now_ns();
+    const AllocEngine *engine = allocator_engine();
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+
+    if (!memory_arena()) {
+        log_error("SNAPSHOT: la arena no está inicializada");
+        return false;
+    }
+    if (sim_context_shared()) {
+        log_error("SNAPSHOT: no disponible con el heap compartido entre hilos");
+        return false;
+    }
+    if (!engine_uses_list(engine) || strlen(engine->name) >= SNAPSHOT_ENGINE_MAX) {
+        log_error("SNAPSHOT: el motor '%s' no admite instantáneas", engine->name);
+        return false;
+    }
+    if (slab_enabled()) {
+        log_error("SNAPSHOT: desactive la capa slab antes de guardar");
+        return false;
+    }
+
+    SnapshotHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    h.version = SNAPSHOT_VERSION;
+    h.word_size = sizeof(size_t);
+    h.arena_size = memory_size();
+    strcpy(h.engine, engine->name);
+
+    size_t used = 0;
+    for (Block *b = blocks_first(); b; b = b->next) {
+        h.block_count++;
+        used += !b->is_free;
+    }
+
+    VarWriter w = { NULL, 0, NULL, NULL, 0, 0, true };
+    vars_visit(write_var, &w);
+    h.var_count = w.count;
+    h.names_size = w.names_size;
+
+    /* RESTORE exige una variable por bloque ocupado */
+    if (used != h.var_count) {
+        log_error("SNAPSHOT: hay %zu bloques ocupados y %zu variables", used, h.var_count);
+        return false;
+    }
+
+    SnapshotLayout layout;
+    if (!snapshot_layout(&h, &layout)) {
+        log_error("SNAPSHOT: el heap es demasiado grande");
+        return false;
+    }
+    h.arena_offset = layout.end;
+    size_t file_size = 0;
+    if (!align_up(&h.arena_offset, page) ||
+        !advance(&file_size, 1, h.arena_offset) ||
+        !advance(&file_size, 1, h.arena_size) ||
+        !align_up(&file_size, page)) {
+        log_error("SNAPSHOT: el heap es demasiado grande");
+        return false;
+    }
+
+    unsigned char *meta = calloc(1, layout.end);
+    Block **order = malloc((h.block_count ? h.block_count : 1) * sizeof(Block *));
+    if (!meta || !order) {
+        log_error("SNAPSHOT: sin memoria para los metadatos");
+        free(meta);
+        free(order);
+        return false;
+    }
+
+    size_t *sizes = (size_t *)(meta + layout.sizes);
+    size_t *requested = (size_t *)(meta + layout.requested);
+    size_t *zeroed = (size_t *)(meta + layout.zeroed);
+    unsigned char *free_flags = meta + layout.free_flags;
+    unsigned char *align_shifts = meta + layout.align_shifts;
+    size_t i = 0;
+
+    memcpy(meta, &h, sizeof(h));
+    for (Block *b = blocks_first(); b; b = b->next, i++) {
+        sizes[i] = b->size;
+        requested[i] = b->requested;
+        zeroed[i] = b->zeroed;
+        free_flags[i] = b->is_free;
+        align_shifts[i] = b->align_shift;
+        order[i] = b;
+    }
+
+    w = (VarWriter){ order, h.block_count, (size_t *)(meta + layout.var_blocks),
+                     (char *)(meta + layout.names), 0, 0, true };
+    vars_visit(write_var, &w);
+    free(order);
+    if (!w.ok) {
+        free(meta);
+        return false;
+    }
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool ok = fd >= 0 &&
+              write_at(fd, meta, layout.end, 0) &&
+              write_at(fd, memory_arena(), h.arena_size, h.arena_offset) &&
+              ftruncate(fd, (off_t)file_size) == 0;
+    if (fd >= 0 && close(fd) != 0) ok = false;
+    free(meta);
+
+    if (!ok) {
+        log_error("SNAPSHOT: no se pudo escribir '%s'", path);
+        return false;
+    }
+
+    log_info("SNAPSHOT: %zu bloques, %zu variables y %zu bytes de arena en '%s' (%llu ns)",
+             h.block_count, h.var_count, h.arena_size, path, now_ns() - t0);
+    return true;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                             RESTAURACIÓN                                  */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Hash FNV-1a de un nombre.
+ */
+static size_t name_hash(const char *name) {
+    size_t h = (size_t)14695981039346656037ULL;
+    for (const unsigned char *p = (const unsigned char *)name; *p; p++) {
+        h = (h ^ *p) * (size_t)1099511628211ULL;
+    }
+    return h;
+}
+
+/**
+ * @brief Comprueba que no haya nombres repetidos, con una tabla hash
+ *        temporal de direccionamiento abierto.
+ *
+ * @param names Nombres.
+ * @param count Cantidad de nombres.
+ * @param dup   Recibe true si algún nombre se repite.
+ * @return false si no hubo memoria para la tabla.
+ */
+static bool names_check(const char **names, size_t count, bool *dup) {
+    size_t cap = 16;
+    while (cap < 2 * count) cap *= 2;
+
+    size_t *slots = calloc(cap, sizeof(size_t));  /* Índice + 1; 0 = vacío */
+    if (!slots) return false;
+
+    *dup = false;
+    for (size_t i = 0; i < count && !*dup; i++) {
+        size_t s = name_hash(names[i]) & (cap - 1);
+        while (slots[s] && !(*dup = strcmp(names[slots[s] - 1], names[i]) == 0)) {
+            s = (s + 1) & (cap - 1);
+        }
+        slots[s] = i + 1;
+    }
+    free(slots);
+    return true;
+}
+
+/**
+ * @brief Valida un archivo mapeado y ubica sus secciones.
+ *
+ * Comprueba la cabecera, que las secciones y la arena estén dentro del
+ * archivo, que los bloques cubran la arena exactamente, que el motor sea
+ * uno que use la lista y que variables y bloques ocupados se correspondan
+ * uno a uno: cada variable apunta a un bloque ocupado que ninguna otra
+ * reclamó, ningún bloque ocupado queda sin variable y no hay nombres
+ * repetidos. Así ningún archivo armado a mano puede dejar un bloque
+ * liberado dos veces o perdido.
+ *
+ * @param map       Archivo mapeado.
+ * @param file_size Tamaño del archivo.
+ * @param out       Secciones validadas; si es válida, `out->name_at` queda
+ *                  reservado y lo libera quien llama.
+ * @return true si la instantánea es válida.
+ */
+static bool snapshot_parse(const unsigned char *map, size_t file_size, SnapshotImage *out) {
+    const SnapshotHeader *h = (const SnapshotHeader *)map;
+    SnapshotLayout layout;
+
+    if (file_size < sizeof(SnapshotHeader)) return false;
+
+    size_t arena_end = h->arena_offset;
+    if (memcmp(h->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+        h->version != SNAPSHOT_VERSION || h->word_size != sizeof(size_t) ||
+        h->arena_size == 0 || h->block_count == 0 ||
+        !snapshot_layout(h, &layout) || layout.end > h->arena_offset ||
+        !advance(&arena_end, 1, h->arena_size) || arena_end > file_size ||
+        memchr(h->engine, '\0', SNAPSHOT_ENGINE_MAX) == NULL) {
+        return false;
+    }
+
+    out->header = h;
+    out->sizes = (const size_t *)(map + layout.sizes);
+    out->requested = (const size_t *)(map + layout.requested);
+    out->zeroed = (const size_t *)(map + layout.zeroed);
+    out->free_flags = map + layout.free_flags;
+    out->align_shifts = map + layout.align_shifts;
+    out->var_blocks = (const size_t *)(map + layout.var_blocks);
+    out->names = (const char *)(map + layout.names);
+    out->name_at = NULL;
+    out->engine = allocator_find_engine(h->engine);
+    out->in_use = 0;
+
+    if (!out->engine || !engine_uses_list(out->engine)) {
+        log_error("RESTORE: el motor '%s' no admite instantáneas", h->engine);
+        return false;
+    }
+
+    size_t covered = 0;
+    for (size_t i = 0; i < h->block_count; i++) {
+        size_t size = out->sizes[i];
+        size_t requested = out->requested[i];
+
+        if (size == 0 || size > h->arena_size - covered || requested > size ||
+            out->zeroed[i] > requested ||
+            (out->free_flags[i] && requested != 0) || out->free_flags[i] > 1 ||
+            out->align_shifts[i] >= sizeof(size_t) * 8) {
+            return false;
+        }
+        covered += size;
+        out->in_use += requested;
+    }
+    if (covered != h->arena_size) return false;
+
+    size_t words = h->block_count / 64 + 1;
+    uint64_t *claimed = calloc(words, sizeof(uint64_t));
+    const char **name_at = malloc((h->var_count ? h->var_count : 1) * sizeof(char *));
+    bool ok = claimed && name_at;
+    bool dup = false;
+    size_t pos = 0;
+    size_t used = 0;
+
+    if (!ok) {
+        log_error("RESTORE: sin memoria para validar la instantánea");
+    }
+    for (size_t i = 0; ok && i < h->var_count; i++) {
+        size_t idx = out->var_blocks[i];
+        const char *end = memchr(out->names + pos, '\0', h->names_size - pos);
+
+        if (idx >= h->block_count || out->free_flags[idx] || !end || end == out->names + pos ||
+            (claimed[idx / 64] >> (idx % 64)) & 1) {
+            ok = false;
+            break;
+        }
+        claimed[idx / 64] |= (uint64_t)1 << (idx % 64);
+        name_at[i] = out->names + pos;
+        pos = (size_t)(end - out->names) + 1;
+    }
+    for (size_t i = 0; ok && i < h->block_count; i++) {
+        used += !out->free_flags[i];
+    }
+    ok = ok && pos == h->names_size && used == h->var_count;
+
+    if (ok && !names_check(name_at, h->var_count, &dup)) {
+        log_error("RESTORE: sin memoria para validar la instantánea");
+        ok = false;
+    }
+    ok = ok && !dup;
+
+    free(claimed);
+    if (ok) {
+        out->name_at = name_at;
+    } else {
+        free(name_at);
+    }
+    return ok;
+}
+
+/**
+ * @brief Reemplaza el heap actual por el de un archivo.
+ *
+ * El archivo se mapea completo; una vez validado, se descartan la arena y
+ * las variables actuales, la arena se mapea desde el archivo, la lista se
+ * arma desde sus arreglos y las variables se registran en su orden
+ * original.
+ *
+ * @param path Ruta del archivo.
+ * @return true si el heap quedó restaurado.
+ */
+bool snapshot_load(const char *path) {
+    unsigned long long t0 = now_ns();
+    struct stat info;
+
+    if (sim_context_shared()) {
+        log_error("RESTORE: no disponible con el heap compartido entre hilos");
+        return false;
+    }
+
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0 || fstat(fd, &info) != 0 || info.st_size <= 0) {
+        log_error("RESTORE: no se pudo abrir '%s'", path);
+        if (fd >= 0) close(fd);
+        return false;
+    }
+
+    size_t file_size = (size_t)info.st_size;
+    const unsigned char *map = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        log_error("RESTORE: no se pudo mapear '%s'", path);
+        close(fd);
+        return false;
+    }
+
+    SnapshotImage img;
+    Block **nodes = NULL;
+    bool ok = snapshot_parse(map, file_size, &img);
+
+    if (!ok) {
+        log_error("RESTORE: '%s' no es una instantánea válida", path);
+    } else {
+        nodes = malloc(img.header->block_count * sizeof(Block *));
+        if (!nodes) {
+            log_error("RESTORE: sin memoria para restaurar '%s'", path);
+            free(img.name_at);
+            ok = false;
+        }
+    }
+    if (!ok) {
+        free(nodes);
+        munmap((void *)map, file_size);
+        close(fd);
+        return false;
+    }
+
+    const SnapshotHeader *h = img.header;
+
+    vars_destroy();
+    memory_destroy();
+
+    ok = memory_init_image(h->arena_size, fd, h->arena_offset);
+    if (ok && !blocks_restore(h->block_count, img.sizes, img.requested,
+                              img.zeroed, img.free_flags, img.align_shifts, nodes)) {
+        memory_destroy();
+        ok = false;
+    }
+
+    vars_init();
+    if (ok) {
+        /* Los nombres ya se validaron distintos, así que no hace falta
+         * buscarlos; cada uno entra como el más reciente, por eso se
+         * registran del último al primero para conservar el orden. */
+        for (size_t i = h->var_count; i-- > 0;) {
+            var_add(img.name_at[i], nodes[img.var_blocks[i]]);
+        }
+
+        allocator_select(img.engine->name);
+        allocator_reset_stats(img.in_use);
+        log_info("RESTORE: %zu bloques, %zu variables y %zu bytes de arena desde '%s' (%llu ns)",
+                 h->block_count, h->var_count, h->arena_size, path, now_ns() - t0);
+    } else {
+        log_error("RESTORE: no se pudo restaurar '%s'; se inicia una arena vacía", path);
+        memory_init(h->arena_size);
+    }
+
+    free(nodes);
+    free(img.name_at);
+    munmap((void *)map, file_size);
+    close(fd);
+    return ok;
+}
@@ -0,0 +1,654 @@
+/**
+ * @file tags.c
+ * @brief Implementación del motor con etiquetas de frontera en la arena.
+ *
+ * Formato de un bloque que inicia en `off` y mide `size` bytes (múltiplo de
+ * TAGS_WORD):
+ *  - `off`:                    cabecera = size | 1 si está ocupado.
+ *  - `off + size - TAGS_WORD`: pie, copia de la cabecera.
+ *  - Libre: `off + TAGS_WORD` y `off + 2 * TAGS_WORD` guardan los offsets
+ *    del siguiente y el anterior en la lista de libres (TAGS_NIL al final).
+ *  - Ocupado: la carga útil va de `off + TAGS_WORD` al pie.
+ *
+ * Los bloques libres forman una lista doblemente enlazada dentro de la
+ * arena, ordenada por dirección, y la búsqueda sigue la política del motor
+ * elegido: `tags` (First-Fit), `tags-best`, `tags-worst` o `tags-next`, con
+ * los mismos desempates que las políticas de lista (el menor offset entre
+ * bloques del mismo tamaño). Así la huella de cada política con etiquetas
+ * se compara con la de su versión de lista. Liberar consulta la cabecera
+ * del siguiente y el pie del anterior para fusionar en O(1); si el bloque
+ * liberado absorbe a un vecino, hereda su lugar en la lista, y si no, su
+ * lugar se busca recorriendo la lista (O(libres)), como en un asignador con
+ * lista ordenada por dirección.
+ *
+ * El mapa `owner` (offset del bloque -> manejador) solo existe para que el
+ * recorrido informe `requested` de cada reserva; un asignador real obtiene
+ * el manejador a partir de la propia dirección, así que no se suma a los
+ * metadatos del motor, pero STATS lo informa aparte como costo del
+ * simulador.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "tags.h"
+#include "sim_context.h"
+#include "memory.h"
+#include "log.h"
+
+/** @brief Fin de la lista de libres. */
+#define TAGS_NIL SIZE_MAX
+
+/** @brief Bit de ocupado en cabeceras y pies. */
+#define TAG_USED ((size_t)1)
+
+/* ------------------------------------------------------------------------- */
+/*                             ESTADO POR CONTEXTO                           */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Estado del motor tags en un contexto de simulación.
+ */
+typedef struct {
+    /** @brief Inicio de la arena. */
+    unsigned char *base;
+
+    /** @brief Bytes cubiertos por bloques (la arena redondeada a TAGS_WORD). */
+    size_t heap_size;
+
+    /** @brief Tamaño total de la arena. */
+    size_t arena_total;
+
+    /** @brief Primer bloque de la lista de libres (el de menor offset). */
+    size_t free_head;
+
+    /** @brief Política de búsqueda (First, Best, Worst o Next-Fit). */
+    AllocAlgorithm policy;
+
+    /** @brief Offset donde empieza la próxima búsqueda de Next-Fit. */
+    size_t rover;
+
+    /** @brief Manejador de cada bloque ocupado, indexado por offset / TAGS_WORD. */
+    Block **owner;
+
+    /** @brief Bloques en la arena (libres y ocupados). */
+    size_t block_count;
+
+    /** @brief Bloques en la lista de libres. */
+    size_t free_count;
+
+    /** @brief Manejadores en uso. */
+    size_t live_handles;
+
+    /** @brief Descriptor temporal devuelto por `tags_find_block()`. */
+    Block scratch;
+} TagsState;
+
+/** @brief Estado de un contexto nuevo: sin arena ni bloques. */
+static const TagsState initial = { .free_head = TAGS_NIL };
+
+/**
+ * @brief Estado del motor tags en el contexto del hilo actual.
+ */
+static TagsState *state(void) {
+    return sim_context_state(SIM_STATE_TAGS, &initial, sizeof(initial));
+}
+
+/* ------------------------------------------------------------------------- */
+/*                        ETIQUETAS Y LISTA DE LIBRES                        */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Lee una palabra de la arena.
+ */
+static size_t load(size_t off) {
+    size_t v;
+    memcpy(&v, state()->base + off, sizeof(v));
+    return v;
+}
+
+/**
+ * @brief Escribe una palabra en la arena.
+ *
+ * La página queda marcada como escrita para que CALLOC no la dé por limpia.
+ */
+static void store(size_t off, size_t v) {
+    memcpy(state()->base + off, &v, sizeof(v));
+    memory_mark_dirty(off, sizeof(v));
+}
+
+/**
+ * @brief Tamaño codificado en una etiqueta.
+ */
+static size_t tag_size(size_t tag) {
+    return tag & ~(size_t)(TAGS_WORD - 1);
+}
+
+/**
+ * @brief Indica si la etiqueta corresponde a un bloque ocupado.
+ */
+static bool tag_used(size_t tag) {
+    return (tag & TAG_USED) != 0;
+}
+
+/**
+ * @brief Escribe cabecera y pie de un bloque.
+ */
+static void write_tags(size_t off, size_t size, bool used) {
+    size_t tag = size | (used ? TAG_USED : 0);
+    store(off, tag);
+    store(off + size - TAGS_WORD, tag);
+}
+
+/**
+ * @brief Inserta un bloque libre en su lugar de la lista ordenada.
+ *
+ * @param off  Bloque libre que no está en la lista.
+ * @param hint Bloque de la lista con offset menor que `off` desde el cual
+ *             buscar, o TAGS_NIL para buscar desde el inicio.
+ */
+static void list_insert(size_t off, size_t hint) {
+    TagsState *st = state();
+    size_t prev = hint;
+    size_t next = hint == TAGS_NIL ? st->free_head : load(hint + TAGS_WORD);
+
+    while (next != TAGS_NIL && next < off) {
+        prev = next;
+        next = load(next + TAGS_WORD);
+    }
+
+    store(off + TAGS_WORD, next);
+    store(off + 2 * TAGS_WORD, prev);
+    if (prev != TAGS_NIL) {
+        store(prev + TAGS_WORD, off);
+    } else {
+        st->free_head = off;
+    }
+    if (next != TAGS_NIL) {
+        store(next + 2 * TAGS_WORD, off);
+    }
+    st->free_count++;
+}
+
+/**
+ * @brief Retira un bloque libre de la lista.
+ */
+static void list_remove(size_t off) {
+    TagsState *st = state();
+    size_t next = load(off + TAGS_WORD);
+    size_t prev = load(off + 2 * TAGS_WORD);
+
+    if (prev != TAGS_NIL) {
+        store(prev + TAGS_WORD, next);
+    } else {
+        st->free_head = next;
+    }
+    if (next != TAGS_NIL) {
+        store(next + 2 * TAGS_WORD, prev);
+    }
+    st->free_count--;
+}
+
+/**
+ * @brief Tamaño total de bloque (etiquetas incluidas) para `size` bytes útiles.
+ *
+ * @return Tamaño redondeado a TAGS_WORD y >= TAGS_MIN_BLOCK, o 0 si desborda.
+ */
+static size_t gross_for(size_t size) {
+    if (size > SIZE_MAX - 3 * TAGS_WORD) return 0;
+
+    size_t gross = ((size + TAGS_WORD - 1) & ~(size_t)(TAGS_WORD - 1)) + 2 * TAGS_WORD;
+    return gross < TAGS_MIN_BLOCK ? TAGS_MIN_BLOCK : gross;
+}
+
+/**
+ * @brief Relleno inicial para que la carga útil de un bloque en `off` quede
+ *        alineada: 0 o al menos TAGS_MIN_BLOCK, para poder separarlo.
+ */
+static size_t align_pad(size_t off, size_t align) {
+    if (align <= TAGS_WORD) return 0;
+
+    size_t pad = (align - ((off + TAGS_WORD) & (align - 1))) & (align - 1);
+    while (pad && pad < TAGS_MIN_BLOCK) {
+        pad += align;
+    }
+    return pad;
+}
+
+/**
+ * @brief Bloque libre de la lista que aloja `gross` bytes alineados, según
+ *        la política del motor.
+ *
+ * First-Fit se queda con el primero; Next-Fit con el primero desde el
+ * puntero móvil, o el primero de la lista si después de él no hay ninguno;
+ * Best-Fit y Worst-Fit recorren la lista entera y, como van en orden de
+ * dirección, entre bloques del mismo tamaño se quedan con el de menor
+ * offset.
+ *
+ * @param gross Tamaño total del bloque requerido.
+ * @param align Alineación de la carga útil.
+ * @param pad   Relleno inicial del bloque encontrado.
+ * @return Offset del bloque, o TAGS_NIL.
+ */
+static size_t find_fit(size_t gross, size_t align, size_t *pad) {
+    TagsState *st = state();
+    size_t found = TAGS_NIL, found_size = 0, found_pad = 0;
+    size_t wrap = TAGS_NIL, wrap_pad = 0;
+
+    for (size_t off = st->free_head; off != TAGS_NIL; off = load(off + TAGS_WORD)) {
+        size_t size = tag_size(load(off));
+        size_t p = align_pad(off, align);
+
+        if (size < gross || size - gross < p) continue;
+
+        if (st->policy == ALLOC_NEXT_FIT && off < st->rover) {
+            if (wrap == TAGS_NIL) {
+                wrap = off;
+                wrap_pad = p;
+            }
+            continue;
+        }
+        if (found == TAGS_NIL ||
+            (st->policy == ALLOC_BEST_FIT && size < found_size) ||
+            (st->policy == ALLOC_WORST_FIT && size > found_size)) {
+            found = off;
+            found_size = size;
+            found_pad = p;
+        }
+        if (st->policy == ALLOC_FIRST_FIT || st->policy == ALLOC_NEXT_FIT) break;
+    }
+
+    if (found == TAGS_NIL) {
+        found = wrap;
+        found_pad = wrap_pad;
+    }
+    *pad = found_pad;
+    return found;
+}
+
+/**
+ * @brief Separa el final de un bloque como bloque libre si alcanza el mínimo.
+ *
+ * El sobrante se fusiona con el bloque siguiente si este está libre, y
+ * entonces ocupa su lugar en la lista.
+ *
+ * @param off  Bloque ocupado.
+ * @param size Tamaño actual del bloque.
+ * @param keep Tamaño que debe conservar.
+ * @param hint Bloque de la lista anterior a `off`, o TAGS_NIL (ver
+ *             `list_insert()`).
+ * @return Tamaño final del bloque ocupado.
+ */
+static size_t split_tail(size_t off, size_t size, size_t keep, size_t hint) {
+    TagsState *st = state();
+    if (size - keep < TAGS_MIN_BLOCK) return size;
+
+    size_t rest = off + keep;
+    size_t rest_size = size - keep;
+    size_t next = off + size;
+
+    if (next < st->heap_size && !tag_used(load(next))) {
+        hint = load(next + 2 * TAGS_WORD);
+        list_remove(next);
+        rest_size += tag_size(load(next));
+    } else {
+        st->block_count++;
+    }
+
+    write_tags(rest, rest_size, false);
+    list_insert(rest, hint);
+    return keep;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                              CICLO DE VIDA                                */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Nombre de la política de búsqueda, para los mensajes.
+ */
+static const char *policy_name(AllocAlgorithm policy) {
+    switch (policy) {
+        case ALLOC_BEST_FIT:  return "Best-Fit";
+        case ALLOC_WORST_FIT: return "Worst-Fit";
+        case ALLOC_NEXT_FIT:  return "Next-Fit";
+        default:              return "First-Fit";
+    }
+}
+
+/**
+ * @brief Escribe un bloque libre que cubre la arena.
+ *
+ * La lista general se reúne en un solo bloque y deja de indexarse.
+ *
+ * @param arena_size Tamaño total de la arena.
+ * @param policy     Política de búsqueda.
+ * @return true si el motor quedó listo.
+ */
+static bool tags_start(size_t arena_size, AllocAlgorithm policy) {
+    TagsState *st = state();
+    Block *first = blocks_first();
+
+    for (Block *b = first; b; b = b->next) {
+        if (!b->is_free) {
+            log_error("tags: la arena debe estar vacía para activar el motor");
+            return false;
+        }
+    }
+
+    size_t usable = arena_size & ~(size_t)(TAGS_WORD - 1);
+    if (usable < TAGS_MIN_BLOCK) {
+        log_error("tags: la arena debe tener al menos %d bytes", TAGS_MIN_BLOCK);
+        return false;
+    }
+
+    st->owner = calloc(usable / TAGS_WORD, sizeof(Block *));
+    if (!st->owner) {
+        log_error("Error: calloc falló en tags_init()");
+        return false;
+    }
+
+    blocks_set_indexed(false);
+    while (first && first->next) {
+        block_join(first);
+    }
+
+    st->base = memory_arena();
+    st->heap_size = usable;
+    st->arena_total = arena_size;
+    st->free_head = TAGS_NIL;
+    st->policy = policy;
+    st->rover = 0;
+    st->free_count = 0;
+    st->block_count = 1;
+    st->live_handles = 0;
+
+    write_tags(0, usable, false);
+    list_insert(0, TAGS_NIL);
+
+    log_info("Motor tags inicializado (%zu bytes, etiquetas de %d bytes, %s)",
+             arena_size, TAGS_WORD, policy_name(policy));
+    return true;
+}
+
+/**
+ * @brief Activa el motor con First-Fit (`tags`).
+ */
+bool tags_init(size_t arena_size) {
+    return tags_start(arena_size, ALLOC_FIRST_FIT);
+}
+
+/**
+ * @brief Activa el motor con Best-Fit (`tags-best`).
+ */
+bool tags_best_init(size_t arena_size) {
+    return tags_start(arena_size, ALLOC_BEST_FIT);
+}
+
+/**
+ * @brief Activa el motor con Worst-Fit (`tags-worst`).
+ */
+bool tags_worst_init(size_t arena_size) {
+    return tags_start(arena_size, ALLOC_WORST_FIT);
+}
+
+/**
+ * @brief Activa el motor con Next-Fit (`tags-next`).
+ */
+bool tags_next_init(size_t arena_size) {
+    return tags_start(arena_size, ALLOC_NEXT_FIT);
+}
+
+/**
+ * @brief Libera el mapa de manejadores y reactiva el índice general.
+ */
+void tags_destroy(void) {
+    TagsState *st = state();
+    free(st->owner);
+    st->owner = NULL;
+    st->base = NULL;
+    st->heap_size = 0;
+    st->arena_total = 0;
+    st->free_head = TAGS_NIL;
+    st->block_count = 0;
+    st->free_count = 0;
+    st->live_handles = 0;
+
+    blocks_set_indexed(true);
+}
+
+/* ------------------------------------------------------------------------- */
+/*                                OPERACIONES                                */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Describe la carga útil del bloque libre que usaría una reserva.
+ *
+ * @param size  Tamaño solicitado.
+ * @param align Alineación de la carga útil.
+ * @return Descriptor temporal, o NULL.
+ */
+Block *tags_find_block(size_t size, size_t align) {
+    TagsState *st = state();
+    size_t gross = gross_for(size);
+    size_t pad = 0;
+    size_t off = gross ? find_fit(gross, align, &pad) : TAGS_NIL;
+    if (off == TAGS_NIL) return NULL;
+
+    st->scratch.offset = off + pad + TAGS_WORD;
+    st->scratch.size = tag_size(load(off)) - pad - 2 * TAGS_WORD;
+    st->scratch.requested = 0;
+    st->scratch.is_free = true;
+    return &st->scratch;
+}
+
+/**
+ * @brief Reserva según la política: retiro de la lista, relleno, división y
+ *        escritura de etiquetas.
+ *
+ * El relleno y el sobrante quedan en el lugar de la lista que tenía el
+ * bloque, así que no hace falta buscarles posición.
+ *
+ * @param size  Tamaño solicitado.
+ * @param align Alineación de la carga útil.
+ * @return Manejador de la carga útil, o NULL.
+ */
+Block *tags_alloc(size_t size, size_t align) {
+    TagsState *st = state();
+    size_t gross = gross_for(size);
+    size_t pad = 0;
+    size_t off = gross ? find_fit(gross, align, &pad) : TAGS_NIL;
+    if (off == TAGS_NIL) return NULL;
+
+    Block *h = block_node_get();
+    if (!h) {
+        log_error("Error: malloc falló en tags_alloc()");
+        return NULL;
+    }
+
+    size_t total = tag_size(load(off));
+    size_t hint = load(off + 2 * TAGS_WORD);
+    list_remove(off);
+    st->rover = off;
+
+    if (pad) {
+        write_tags(off, pad, false);
+        list_insert(off, hint);
+        st->block_count++;
+        hint = off;
+        off += pad;
+        total -= pad;
+        allocator_note_alignment(pad, 0);
+    }
+
+    total = split_tail(off, total, gross, hint);
+    write_tags(off, total, true);
+
+    st->owner[off / TAGS_WORD] = h;
+    st->live_handles++;
+
+    memset(h, 0, sizeof(*h));
+    h->offset = off + TAGS_WORD;
+    h->size = total - 2 * TAGS_WORD;
+    h->requested = size;
+    h->is_free = false;
+    return h;
+}
+
+/**
+ * @brief Libera y fusiona con los vecinos que marcan libres sus etiquetas.
+ *
+ * Unido al anterior, el bloque se queda con su lugar en la lista; unido solo
+ * al siguiente, con el del siguiente; sin vecinos libres, se busca su lugar.
+ *
+ * @param block Manejador ocupado.
+ */
+void tags_free(Block *block) {
+    TagsState *st = state();
+    size_t off = block->offset - TAGS_WORD;
+    size_t size = tag_size(load(off));
+    size_t next = off + size;
+    size_t hint = TAGS_NIL;
+    bool listed = false;
+
+    st->owner[off / TAGS_WORD] = NULL;
+
+    if (next < st->heap_size && !tag_used(load(next))) {
+        hint = load(next + 2 * TAGS_WORD);
+        list_remove(next);
+        size += tag_size(load(next));
+        st->block_count--;
+    }
+
+    if (off > 0) {
+        size_t prev_tag = load(off - TAGS_WORD);
+        if (!tag_used(prev_tag)) {
+            off -= tag_size(prev_tag);
+            size += tag_size(prev_tag);
+            listed = true;
+            st->block_count--;
+        }
+    }
+
+    write_tags(off, size, false);
+    if (!listed) {
+        list_insert(off, hint);
+    }
+
+    block->is_free = true;
+    block->requested = 0;
+    block_node_put(block);
+    st->live_handles--;
+}
+
+/**
+ * @brief Redimensiona en su lugar: una reducción devuelve el sobrante y una
+ *        expansión absorbe el bloque libre siguiente.
+ *
+ * @param block    Manejador ocupado.
+ * @param new_size Nuevo tamaño solicitado.
+ * @return true si no necesita moverse.
+ */
+bool tags_resize(Block *block, size_t new_size) {
+    TagsState *st = state();
+    size_t off = block->offset - TAGS_WORD;
+    size_t size = tag_size(load(off));
+    size_t need = gross_for(new_size);
+    size_t hint = TAGS_NIL;
+
+    if (!need) return false;
+
+    if (need > size) {
+        size_t next = off + size;
+        if (next >= st->heap_size || tag_used(load(next))) return false;
+
+        size_t next_size = tag_size(load(next));
+        if (size + next_size < need) return false;
+
+        hint = load(next + 2 * TAGS_WORD);
+        list_remove(next);
+        st->block_count--;
+        size += next_size;
+        write_tags(off, size, true);
+    }
+
+    size = split_tail(off, size, need, hint);
+    write_tags(off, size, true);
+
+    block->size = size - 2 * TAGS_WORD;
+    return true;
+}
+
+/**
+ * @brief Recorre la arena saltando de cabecera en cabecera.
+ *
+ * Los bytes finales que no completan una palabra se informan como un
+ * segmento libre aparte.
+ *
+ * @param visit Función invocada por cada bloque.
+ * @param ctx   Contexto para `visit`.
+ */
+void tags_walk(BlockVisitor visit, void *ctx) {
+    TagsState *st = state();
+    Block seg;
+
+    for (size_t off = 0; off < st->heap_size; off += seg.size) {
+        size_t tag = load(off);
+
+        memset(&seg, 0, sizeof(seg));
+        if (tag_used(tag)) {
+            /* Campo a campo: con el heap compartido, la caché de otro hilo
+             * puede estar cambiando `requested` sin el cerrojo */
+            const Block *owner = st->owner[off / TAGS_WORD];
+            seg.requested = __atomic_load_n(&owner->requested, __ATOMIC_RELAXED);
+            seg.align_shift = owner->align_shift;
+            seg.slab = owner->slab;
+        } else {
+            seg.is_free = true;
+        }
+        seg.offset = off;
+        seg.size = tag_size(tag);
+        visit(&seg, ctx);
+    }
+
+    if (st->heap_size < st->arena_total) {
+        memset(&seg, 0, sizeof(seg));
+        seg.offset = st->heap_size;
+        seg.size = st->arena_total - st->heap_size;
+        seg.is_free = true;
+        visit(&seg, ctx);
+    }
+}
+
+/**
+ * @brief Etiquetas de todos los bloques y manejadores de las reservas vivas.
+ *
+ * @param out Resultado.
+ */
+void tags_overhead(AllocOverhead *out) {
+    TagsState *st = state();
+    out->in_arena = st->block_count * 2 * TAGS_WORD;
+    out->outside = st->live_handles * sizeof(Block);
+}
+
+/**
+ * @brief Imprime bloques, lista de libres y bytes de etiquetas.
+ */
+void tags_print_stats(void) {
+    TagsState *st = state();
+    size_t largest = 0;
+    for (size_t off = st->free_head; off != TAGS_NIL; off = load(off + TAGS_WORD)) {
+        size_t size = tag_size(load(off));
+        if (size > largest) largest = size;
+    }
+
+    printf("Bloques en la arena: %zu (%zu libres, %zu ocupados)\n",
+           st->block_count, st->free_count, st->block_count - st->free_count);
+    printf("Etiquetas:           %zu bytes (%d por bloque)\n",
+           st->block_count * 2 * TAGS_WORD, 2 * TAGS_WORD);
+    printf("Mayor bloque libre:  %zu bytes\n", largest);
+    printf("Política:            %s\n", policy_name(st->policy));
+    printf("Mapa de dueños:      %zu bytes (solo del simulador, fuera de los metadatos)\n",
+           st->heap_size / TAGS_WORD * sizeof(Block *));
+}
@@ -0,0 +1,434 @@
+/**
+ * @file tlsf.c
+ * @brief Implementación del motor TLSF (Two-Level Segregated Fit).
+ *
+ * Clasificación de un tamaño `s`:
+ *  - Si s < TLSF_SL_COUNT, primer nivel 0 y segundo nivel `s` (lineal).
+ *  - Si no, con f = floor(log2(s)): primer nivel f - TLSF_SL_LOG2 + 1 y
+ *    segundo nivel dado por los TLSF_SL_LOG2 bits que siguen al bit más alto.
+ *
+ * Al buscar, el tamaño se redondea hacia arriba al inicio de la siguiente
+ * lista, de modo que cualquier bloque de la lista encontrada sirve sin
+ * recorrerla ("good fit").
+ *
+ * Las listas usan los campos `free_next`/`free_prev` de cada bloque.
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include "tlsf.h"
+#include "sim_context.h"
+#include "allocator.h"
+#include "log.h"
+
+/** @brief Cantidad de clases de primer nivel. */
+#define TLSF_FL_COUNT (sizeof(size_t) * 8 - TLSF_SL_LOG2 + 1)
+
+/* ------------------------------------------------------------------------- */
+/*                             ESTADO POR CONTEXTO                           */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Estado del motor TLSF en un contexto de simulación.
+ */
+typedef struct {
+    /** @brief Bit `f` encendido si alguna lista del primer nivel `f` tiene bloques. */
+    unsigned long long fl_bitmap;
+
+    /** @brief Por cada primer nivel, bit `s` encendido si la lista (f, s) tiene bloques. */
+    unsigned sl_bitmap[TLSF_FL_COUNT];
+
+    /** @brief Cabezas de las listas de bloques libres. */
+    Block *heads[TLSF_FL_COUNT][TLSF_SL_COUNT];
+} TlsfState;
+
+/** @brief Estado de un contexto nuevo: todas las listas vacías. */
+static const TlsfState initial = { 0 };
+
+/**
+ * @brief Estado del motor TLSF en el contexto del hilo actual.
+ */
+static TlsfState *state(void) {
+    return sim_context_state(SIM_STATE_TLSF, &initial, sizeof(initial));
+}
+
+/* ------------------------------------------------------------------------- */
+/*                           FUNCIONES AUXILIARES                            */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief floor(log2(size)) para size > 0.
+ */
+static unsigned floor_log2(size_t size) {
+    return (unsigned)(sizeof(size_t) * 8 - 1 - __builtin_clzll((unsigned long long)size));
+}
+
+/**
+ * @brief Lista (fl, sl) a la que pertenece un bloque de `size` bytes.
+ */
+static void mapping_insert(size_t size, unsigned *fl, unsigned *sl) {
+    if (size < TLSF_SL_COUNT) {
+        *fl = 0;
+        *sl = (unsigned)size;
+        return;
+    }
+
+    unsigned f = floor_log2(size);
+    *fl = f - TLSF_SL_LOG2 + 1;
+    *sl = (unsigned)(size >> (f - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+}
+
+/**
+ * @brief Primera lista cuyos bloques tienen todos tamaño >= size.
+ *
+ * @return false si el redondeo desborda `size_t`.
+ */
+static bool mapping_search(size_t size, unsigned *fl, unsigned *sl) {
+    if (size >= TLSF_SL_COUNT) {
+        size_t round = ((size_t)1 << (floor_log2(size) - TLSF_SL_LOG2)) - 1;
+        if (size + round < size) return false;
+        size += round;
+    }
+
+    mapping_insert(size, fl, sl);
+    return true;
+}
+
+/**
+ * @brief Inserta un bloque libre en la cabeza de su lista.
+ */
+static void insert_free(Block *b) {
+    TlsfState *st = state();
+    unsigned fl, sl;
+    mapping_insert(b->size, &fl, &sl);
+
+    b->free_prev = NULL;
+    b->free_next = st->heads[fl][sl];
+    if (st->heads[fl][sl]) {
+        st->heads[fl][sl]->free_prev = b;
+    }
+    st->heads[fl][sl] = b;
+
+    st->fl_bitmap |= 1ULL << fl;
+    st->sl_bitmap[fl] |= 1u << sl;
+}
+
+/**
+ * @brief Retira un bloque libre de su lista.
+ */
+static void remove_free(Block *b) {
+    TlsfState *st = state();
+    unsigned fl, sl;
+    mapping_insert(b->size, &fl, &sl);
+
+    if (b->free_prev) {
+        b->free_prev->free_next = b->free_next;
+    } else {
+        st->heads[fl][sl] = b->free_next;
+    }
+    if (b->free_next) {
+        b->free_next->free_prev = b->free_prev;
+    }
+    b->free_prev = NULL;
+    b->free_next = NULL;
+
+    if (!st->heads[fl][sl]) {
+        st->sl_bitmap[fl] &= ~(1u << sl);
+        if (!st->sl_bitmap[fl]) {
+            st->fl_bitmap &= ~(1ULL << fl);
+        }
+    }
+}
+
+/**
+ * @brief Primera lista no vacía a partir de (fl, sl), usando los mapas de bits.
+ */
+static Block *find_suitable(unsigned fl, unsigned sl) {
+    TlsfState *st = state();
+    unsigned sl_map = st->sl_bitmap[fl] & (~0u << sl);
+
+    if (!sl_map) {
+        if (fl + 1 >= TLSF_FL_COUNT) return NULL;
+
+        unsigned long long fl_map = st->fl_bitmap & (~0ULL << (fl + 1));
+        if (!fl_map) return NULL;
+
+        fl = (unsigned)__builtin_ctzll(fl_map);
+        sl_map = st->sl_bitmap[fl];
+    }
+
+    return st->heads[fl][__builtin_ctz(sl_map)];
+}
+
+/**
+ * @brief Vacía listas y mapas de bits.
+ */
+static void clear_lists(void) {
+    TlsfState *st = state();
+    st->fl_bitmap = 0;
+    for (size_t f = 0; f < TLSF_FL_COUNT; f++) {
+        st->sl_bitmap[f] = 0;
+        for (size_t s = 0; s < TLSF_SL_COUNT; s++) {
+            st->heads[f][s] = NULL;
+        }
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+/*                              CICLO DE VIDA                                */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Reúne la arena vacía en un solo bloque y lo registra en las listas.
+ *
+ * @param arena_size Tamaño total de la arena.
+ * @return true si el motor quedó listo.
+ */
+bool tlsf_init(size_t arena_size) {
+    Block *first = blocks_first();
+
+    for (Block *b = first; b; b = b->next) {
+        if (!b->is_free) {
+            log_error("tlsf: la arena debe estar vacía para activar el motor");
+            return false;
+        }
+    }
+
+    blocks_set_indexed(false);
+    clear_lists();
+
+    while (first && first->next) {
+        block_join(first);
+    }
+    if (first) {
+        insert_free(first);
+    }
+
+    log_info("Motor TLSF inicializado (%zu bytes)", arena_size);
+    return true;
+}
+
+/**
+ * @brief Vacía las listas y reactiva el índice general de libres.
+ */
+void tlsf_destroy(void) {
+    clear_lists();
+    blocks_set_indexed(true);
+}
+
+/* ------------------------------------------------------------------------- */
+/*                                OPERACIONES                                */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Relleno inicial para alinear `offset`: 0 o al menos TLSF_MIN_BLOCK,
+ *        para que pueda separarse como bloque libre.
+ */
+static size_t align_pad(size_t offset, size_t align) {
+    size_t pad = (align - (offset & (align - 1))) & (align - 1);
+
+    while (pad && pad < TLSF_MIN_BLOCK) {
+        pad += align;
+    }
+    return pad;
+}
+
+/**
+ * @brief Búsqueda en O(1) de un bloque libre suficiente.
+ *
+ * Con alineación se busca un bloque de size + align - 1 + TLSF_MIN_BLOCK
+ * bytes, que aloja la solicitud con cualquier relleno que `align_pad()`
+ * pueda exigir; así la búsqueda sigue sin recorrer listas.
+ *
+ * @param size  Tamaño solicitado.
+ * @param align Alineación en bytes.
+ * @return Cabeza de la primera lista adecuada, o NULL.
+ */
+Block *tlsf_find_block(size_t size, size_t align) {
+    if (align > 1) {
+        size_t slack = align - 1 + TLSF_MIN_BLOCK;
+        if (size + slack < size) return NULL;
+        size += slack;
+    }
+
+    unsigned fl, sl;
+    if (!mapping_search(size, &fl, &sl) || fl >= TLSF_FL_COUNT) return NULL;
+
+    return find_suitable(fl, sl);
+}
+
+/**
+ * @brief Reserva: búsqueda, retiro de la lista y división del sobrante.
+ *
+ * El relleno de alineación se separa al inicio como bloque libre.
+ *
+ * @param size  Tamaño solicitado.
+ * @param align Alineación en bytes.
+ * @return Bloque ocupado, o NULL.
+ */
+Block *tlsf_alloc(size_t size, size_t align) {
+    Block *b = tlsf_find_block(size, align);
+    if (!b) return NULL;
+
+    remove_free(b);
+
+    size_t pad = align > 1 ? align_pad(b->offset, align) : 0;
+    if (pad) {
+        block_split(b, pad);
+        insert_free(b);
+        b = b->next;
+        allocator_note_alignment(pad, 0);
+    }
+
+    block_mark_used(b);
+
+    if (b->size - size >= TLSF_MIN_BLOCK) {
+        block_split(b, size);
+        insert_free(b->next);
+    }
+
+    return b;
+}
+
+/**
+ * @brief Liberación con fusión inmediata de los vecinos físicos.
+ *
+ * @param block Bloque ocupado.
+ */
+void tlsf_free(Block *block) {
+    Block *b = block;
+
+    block_mark_free(b);
+
+    if (b->prev && b->prev->is_free) {
+        remove_free(b->prev);
+        b = block_join(b->prev);
+    }
+    if (b->next && b->next->is_free) {
+        remove_free(b->next);
+        block_join(b);
+    }
+
+    insert_free(b);
+}
+
+/**
+ * @brief Redimensiona en su lugar usando solo el vecino físico siguiente.
+ *
+ * Un sobrante menor a TLSF_MIN_BLOCK se conserva dentro del bloque.
+ *
+ * @param block    Bloque ocupado.
+ * @param new_size Nuevo tamaño solicitado.
+ * @return true si el bloque cubre `new_size` sin moverse.
+ */
+bool tlsf_resize(Block *block, size_t new_size) {
+    if (new_size <= block->size) {
+        if (block->size - new_size >= TLSF_MIN_BLOCK) {
+            block_split(block, new_size);
+
+            Block *rest = block->next;
+            if (rest->next && rest->next->is_free) {
+                remove_free(rest->next);
+                block_join(rest);
+            }
+            insert_free(rest);
+        }
+        return true;
+    }
+
+    size_t extra = new_size - block->size;
+    Block *next = block->next;
+
+    if (!next || !next->is_free || next->size < extra) {
+        return false;
+    }
+
+    remove_free(next);
+
+    if (next->size - extra < TLSF_MIN_BLOCK) {
+        block_grow(block, next->size);
+    } else {
+        block_grow(block, extra);
+        insert_free(block->next);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Imprime cada lista no vacía con su rango de tamaños y sus bloques.
+ */
+void tlsf_print_stats(void) {
+    TlsfState *st = state();
+    for (unsigned f = 0; f < TLSF_FL_COUNT; f++) {
+        for (unsigned s = 0; s < TLSF_SL_COUNT; s++) {
+            if (!(st->sl_bitmap[f] & (1u << s))) continue;
+
+            size_t lo = f ? ((size_t)(TLSF_SL_COUNT + s) << (f - 1)) : s;
+            size_t n = 0;
+            for (Block *b = st->heads[f][s]; b; b = b->free_next) {
+                n++;
+            }
+            printf("Lista (%2u,%2u) >= %6zu B: %zu libres\n", f, s, lo, n);
+        }
+    }
+}
+
+/**
+ * @brief Nodos de la lista más las tablas de cabezas y mapas de bits.
+ *
+ * @param out Resultado.
+ */
+void tlsf_overhead(AllocOverhead *out) {
+    size_t live;
+    blocks_pool_usage(&live, NULL);
+
+    out->in_arena = 0;
+    out->outside = live * sizeof(Block) + sizeof(TlsfState);
+}
+
+/**
+ * @brief Incorpora el final nuevo de la arena al bloque libre final.
+ *
+ * El bloque final libre sale de su lista antes de crecer, porque su clase
+ * cambia con el tamaño.
+ *
+ * @param old_size Tamaño anterior de la arena.
+ * @param new_size Tamaño nuevo.
+ * @return true si el espacio nuevo quedó en las listas.
+ */
+bool tlsf_grow(size_t old_size, size_t new_size) {
+    Block *last = blocks_last();
+    bool tail_free = last && last->is_free;
+
+    if (tail_free) remove_free(last);
+
+    Block *tail = blocks_extend(new_size - old_size);
+    if (!tail) {
+        if (tail_free) insert_free(last);
+        return false;
+    }
+
+    insert_free(tail);
+    return true;
+}
+
+/**
+ * @brief Compacta la arena y vuelve a clasificar los bloques libres.
+ *
+ * Las listas se vacían antes de deslizar los bloques (los nodos libres
+ * desaparecen) y se llenan con los huecos que quedan después.
+ *
+ * @param move Función que mueve los datos de cada bloque desplazado.
+ * @param ctx  Contexto para `move`.
+ * @return Bytes movidos.
+ */
+size_t tlsf_compact(BlockMover move, void *ctx) {
+    clear_lists();
+    size_t moved = blocks_compact(move, ctx);
+
+    for (Block *b = blocks_first(); b; b = b->next) {
+        if (b->is_free) insert_free(b);
+    }
+    return moved;
+}
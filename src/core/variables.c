@@ -2,130 +2,484 @@
  * @file variables.c
  * @brief Gestión de variables simbólicas asociadas a bloques de memoria.
  *
- * Este módulo implementa una tabla de símbolos simple basada en una lista enlazada.
- * Permite registrar, obtener, actualizar y eliminar variables que apuntan a bloques
- * de memoria simulados dentro del sistema de administración de memoria.
+ * Este módulo implementa una tabla de símbolos basada en una tabla hash de
+ * direccionamiento abierto (sondeo lineal) sobre punteros a las entradas.
+ * Permite registrar, obtener, actualizar y eliminar variables que apuntan a
+ * bloques de memoria simulados dentro del sistema de administración de memoria.
+ *
+ * Cada entrada guarda su nombre en la misma reserva (`VarEntry::name`) y el
+ * hash ya calculado, así que una variable cuesta un solo `malloc` y las
+ * comparaciones con `strcmp` solo se hacen cuando coinciden los hashes.
+ * Las entradas también forman una lista doble, de la más reciente a la más
+ * antigua, que da el orden de `vars_visit()` y del reporte de fugas. Desde
+ * el primer `vars_remove_prefix()` forman además un árbol AVL ordenado por
+ * nombre, en el que las variables de un prefijo son un rango contiguo que
+ * se encuentra en O(log n + k); las trazas sin FREE_PREFIX no pagan su
+ * mantenimiento.
+ *
+ * La tabla crece de a poco: al pasar de 3/4 de ocupación se reserva una del
+ * doble de tamaño y cada inserción o eliminación siguiente traslada
+ * `VAR_MIGRATE_STEP` casillas de la vieja, así ninguna operación paga el
+ * rehash completo. Mientras dura el traslado las búsquedas miran las dos
+ * tablas. Las casillas eliminadas quedan marcadas (`TOMBSTONE`) para no
+ * cortar las secuencias de sondeo, y se descartan en el próximo traslado.
  *
  * También facilita la detección de fugas de memoria reportando variables que nunca
  * fueron liberadas mediante FREE.
  */
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include "variables.h"
+#include "sim_context.h"
 #include "log.h"
 
+/** @brief Casillas de la primera tabla (potencia de dos). */
+#define VAR_MIN_SLOTS 64
+
+/** @brief Casillas de la tabla vieja que traslada cada modificación. */
+#define VAR_MIGRATE_STEP 16
+
+/* ------------------------------------------------------------------------- */
+/*                             ESTADO POR CONTEXTO                           */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Tabla de variables de un contexto de simulación.
+ */
+typedef struct {
+    /** @brief Variable más reciente; el resto sigue por `VarEntry::older`. */
+    VarEntry *newest;
+
+    /** @brief Casillas de la tabla actual (NULL, entrada o `TOMBSTONE`). */
+    VarEntry **slots;
+
+    /** @brief Casillas de la tabla actual (potencia de dos, o 0). */
+    size_t capacity;
+
+    /** @brief Casillas no vacías de la tabla actual, marcas incluidas. */
+    size_t filled;
+
+    /** @brief Tabla anterior mientras se traslada, o NULL. */
+    VarEntry **old_slots;
+
+    /** @brief Casillas de la tabla anterior. */
+    size_t old_capacity;
+
+    /** @brief Primera casilla de la tabla anterior aún no trasladada. */
+    size_t migrated;
+
+    /** @brief Variables registradas. */
+    size_t count;
+
+    /** @brief Entradas ordenadas por nombre (`VarEntry::name_node`). */
+    AvlTree by_name;
+
+    /** @brief El árbol por nombre está armado y se mantiene. */
+    bool indexed;
+
+    /** @brief Número de registro de la próxima variable. */
+    size_t next_seq;
+} VariablesState;
+
+/**
+ * @brief Orden del árbol por nombre: los nombres son únicos.
+ */
+static int name_compare(const AvlNode *a, const AvlNode *b) {
+    return strcmp(AVL_ENTRY(a, VarEntry, name_node)->name,
+                  AVL_ENTRY(b, VarEntry, name_node)->name);
+}
+
+/** @brief Tabla de un contexto nuevo: vacía y sin casillas. */
+static const VariablesState initial = { .by_name = { NULL, name_compare, NULL } };
+
+/** @brief Objeto cuya dirección marca una casilla eliminada. */
+static char tombstone_mark;
+
+/** @brief Casilla que tuvo una entrada eliminada o trasladada. */
+#define TOMBSTONE ((VarEntry *)(void *)&tombstone_mark)
+
 /**
- * @brief Lista enlazada global de variables registradas.
+ * @brief Tabla de variables del contexto del hilo actual.
+ */
+static VariablesState *state(void) {
+    return sim_context_state(SIM_STATE_VARIABLES, &initial, sizeof(initial));
+}
+
+/* ------------------------------------------------------------------------- */
+/*                           FUNCIONES INTERNAS                              */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Hash FNV-1a de un nombre.
  *
- * Cada entrada almacena:
- * - nombre de la variable
- * - bloque de memoria asociado
- * - siguiente nodo
+ * @param name Cadena terminada en '\0'.
+ * @return Hash del nombre.
  */
-static VarEntry *var_list = NULL;
+static size_t var_hash(const char *name) {
+    uint64_t h = 14695981039346656037ull;
+    for (const unsigned char *p = (const unsigned char *)name; *p; p++) {
+        h ^= *p;
+        h *= 1099511628211ull;
+    }
+    return (size_t)(h ^ (h >> 32));
+}
 
 /**
- * @brief Implementación local de strdup (compatible con C11).
+ * @brief Busca un nombre en una tabla.
  *
- * Crea una copia dinámica de la cadena recibida. Se implementa manualmente ya
- * que strdup no está garantizada por C11.
+ * @param slots Casillas de la tabla.
+ * @param cap   Cantidad de casillas (potencia de dos, o 0).
+ * @param name  Nombre buscado.
+ * @param hash  Hash del nombre.
+ * @return Casilla que contiene la entrada, o NULL si no está.
+ */
+static VarEntry **table_find(VarEntry **slots, size_t cap, const char *name, size_t hash) {
+    if (!cap) return NULL;
+
+    for (size_t i = hash & (cap - 1);; i = (i + 1) & (cap - 1)) {
+        VarEntry *e = slots[i];
+        if (!e) return NULL;
+        if (e != TOMBSTONE && e->hash == hash && strcmp(e->name, name) == 0) {
+            return &slots[i];
+        }
+    }
+}
+
+/**
+ * @brief Busca la casilla que apunta a una entrada dada.
  *
- * @param s Cadena original.
- * @return Copia dinámica terminada en '\0', o NULL si falla la asignación.
+ * @param slots Casillas de la tabla.
+ * @param cap   Cantidad de casillas (potencia de dos, o 0).
+ * @param entry Entrada buscada.
+ * @return Su casilla, o NULL si la entrada no está en esta tabla.
  */
-static char *var_strdup(const char *s) {
-    if (!s) return NULL;
-    size_t len = strlen(s);
-    char *copy = malloc(len + 1);
-    if (!copy) return NULL;
-    memcpy(copy, s, len + 1); // copia incluyendo el '\0'
-    return copy;
+static VarEntry **table_slot_of(VarEntry **slots, size_t cap, const VarEntry *entry) {
+    if (!cap) return NULL;
+
+    for (size_t i = entry->hash & (cap - 1);; i = (i + 1) & (cap - 1)) {
+        if (slots[i] == entry) return &slots[i];
+        if (!slots[i]) return NULL;
+    }
 }
 
 /**
- * @brief Inicializa la tabla de variables.
+ * @brief Coloca en una tabla una entrada que no está en ella.
  *
- * Debe llamarse al iniciar el programa. Reinicia la lista a NULL.
+ * Usa la primera casilla vacía o marcada de su secuencia de sondeo. La
+ * tabla siempre tiene casillas vacías porque se agranda antes de llenarse.
+ *
+ * @param slots  Casillas de la tabla.
+ * @param cap    Cantidad de casillas (potencia de dos).
+ * @param filled Casillas no vacías de la tabla; se actualiza.
+ * @param entry  Entrada a colocar.
  */
-void vars_init(void) {
-    var_list = NULL;
+static void table_place(VarEntry **slots, size_t cap, size_t *filled, VarEntry *entry) {
+    size_t i = entry->hash & (cap - 1);
+
+    while (slots[i] && slots[i] != TOMBSTONE) {
+        i = (i + 1) & (cap - 1);
+    }
+    if (!slots[i]) (*filled)++;
+    slots[i] = entry;
 }
 
 /**
- * @brief Destruye todas las variables registradas.
+ * @brief Traslada hasta `steps` casillas de la tabla vieja a la actual.
  *
- * Libera la lista enlazada, incluyendo cadenas y nodos.
- * No libera los bloques a los que apuntan —eso le corresponde al manejador
- * de memoria. Solo elimina la asociación simbólica.
+ * Cada casilla trasladada queda marcada en la tabla vieja, para que las
+ * búsquedas que aún la recorren no corten su secuencia. Al llegar al final
+ * se libera la tabla vieja.
+ *
+ * @param st    Tabla del contexto actual.
+ * @param steps Casillas a revisar.
  */
-void vars_destroy(void) {
-    VarEntry *curr = var_list;
-    while (curr) {
-        VarEntry *next = curr->next;
-        free(curr->name);
-        free(curr);
-        curr = next;
+static void table_migrate(VariablesState *st, size_t steps) {
+    while (st->old_slots && steps--) {
+        VarEntry *e = st->old_slots[st->migrated];
+
+        if (e && e != TOMBSTONE) {
+            st->old_slots[st->migrated] = TOMBSTONE;
+            table_place(st->slots, st->capacity, &st->filled, e);
+        }
+        if (++st->migrated == st->old_capacity) {
+            free(st->old_slots);
+            st->old_slots = NULL;
+            st->old_capacity = 0;
+            st->migrated = 0;
+        }
     }
-    var_list = NULL;
 }
 
 /**
- * @brief Busca una variable por nombre en la lista de variables.
+ * @brief Asegura lugar para una entrada más en la tabla actual.
+ *
+ * Si quedaría por encima de 3/4 de ocupación (contando las marcas), empieza
+ * un traslado hacia una tabla con al menos el doble de casillas que
+ * variables; si casi todo eran marcas, la tabla nueva puede tener el mismo
+ * tamaño y solo las descarta. Las entradas de un traslado que no había
+ * terminado pasan de una vez a la tabla nueva. Si la tabla nueva no se
+ * puede reservar se sigue con la actual mientras le queden casillas vacías.
  *
+ * @param st Tabla del contexto actual.
+ * @return false si no hay lugar.
+ */
+static bool table_reserve(VariablesState *st) {
+    if (st->capacity && (st->filled + 1) * 4 <= st->capacity * 3) {
+        return true;
+    }
+
+    size_t cap = VAR_MIN_SLOTS;
+    while (cap < (st->count + 1) * 2) {
+        cap *= 2;
+    }
+
+    VarEntry **slots = calloc(cap, sizeof(*slots));
+    size_t filled = 0;
+    if (!slots) {
+        return st->capacity && st->filled + 1 < st->capacity;
+    }
+
+    /* Lo que quedaba de un traslado anterior pasa directo a la tabla nueva */
+    for (size_t i = st->migrated; i < st->old_capacity; i++) {
+        VarEntry *e = st->old_slots[i];
+        if (e && e != TOMBSTONE) {
+            table_place(slots, cap, &filled, e);
+        }
+    }
+    free(st->old_slots);
+
+    st->old_slots = st->slots;
+    st->old_capacity = st->capacity;
+    st->migrated = 0;
+    st->slots = slots;
+    st->capacity = cap;
+    st->filled = filled;
+    return true;
+}
+
+/**
+ * @brief Busca una variable por nombre en la tabla actual y en la vieja.
+ *
+ * @param st   Tabla del contexto actual.
  * @param name Nombre de la variable a buscar.
- * @return Puntero a la entrada si existe, NULL de lo contrario.
+ * @return Casilla de la entrada si existe, NULL de lo contrario.
+ */
+static VarEntry **var_find(VariablesState *st, const char *name) {
+    size_t hash = var_hash(name);
+    VarEntry **slot = table_find(st->slots, st->capacity, name, hash);
+    if (!slot) {
+        slot = table_find(st->old_slots, st->old_capacity, name, hash);
+    }
+    return slot;
+}
+
+/**
+ * @brief Quita una entrada de la tabla, de la lista y del árbol y la libera.
+ *
+ * @param st    Tabla del contexto actual.
+ * @param slot  Casilla de la entrada (en cualquiera de las dos tablas).
+ */
+static void var_delete(VariablesState *st, VarEntry **slot) {
+    VarEntry *entry = *slot;
+
+    *slot = TOMBSTONE;
+    if (st->indexed) {
+        avl_remove(&st->by_name, &entry->name_node);
+    }
+    if (entry->newer) {
+        entry->newer->older = entry->older;
+    } else {
+        st->newest = entry->older;
+    }
+    if (entry->older) {
+        entry->older->newer = entry->newer;
+    }
+    free(entry);
+    st->count--;
+}
+
+/**
+ * @brief Crea una entrada y la registra como la más reciente.
+ *
+ * @param st    Tabla del contexto actual.
+ * @param name  Nombre de la variable.
+ * @param block Bloque asociado a la variable.
  */
-static VarEntry *var_find(const char *name) {
-    VarEntry *curr = var_list;
+static void var_insert(VariablesState *st, const char *name, Block *block) {
+    size_t len = strlen(name);
+    VarEntry *entry = malloc(sizeof(VarEntry) + len + 1);
+    if (!entry) {
+        log_error("var_set: malloc falló");
+        return;
+    }
+    if (!table_reserve(st)) {
+        free(entry);
+        log_error("var_set: sin memoria para la tabla de variables");
+        return;
+    }
+
+    memcpy(entry->name, name, len + 1); // copia incluyendo el '\0'
+    entry->hash = var_hash(name);
+    entry->block = block;
+    entry->seq = st->next_seq++;
+    entry->newer = NULL;
+    entry->older = st->newest;
+    if (st->newest) {
+        st->newest->newer = entry;
+    }
+    st->newest = entry;
+    st->count++;
+
+    table_place(st->slots, st->capacity, &st->filled, entry);
+    if (st->indexed) {
+        avl_insert(&st->by_name, &entry->name_node);
+    }
+    table_migrate(st, VAR_MIGRATE_STEP);
+}
+
+/**
+ * @brief Arma el árbol por nombre con todas las variables, la primera vez
+ *        que se necesita.
+ *
+ * @param st Tabla del contexto actual.
+ */
+static void name_index_build(VariablesState *st) {
+    if (st->indexed) return;
+
+    for (VarEntry *e = st->newest; e; e = e->older) {
+        avl_insert(&st->by_name, &e->name_node);
+    }
+    st->indexed = true;
+}
+
+/**
+ * @brief Reúne las entradas del subárbol cuyo nombre empieza con un prefijo.
+ *
+ * Solo baja por los subárboles que pueden contener nombres del rango, así
+ * que visita O(log n + k) nodos.
+ *
+ * @param node   Raíz del subárbol.
+ * @param prefix Prefijo de los nombres.
+ * @param len    Longitud del prefijo.
+ * @param out    Recibe las entradas, o NULL para solo contarlas.
+ * @param count  Entradas reunidas; se incrementa.
+ */
+static void prefix_collect(AvlNode *node, const char *prefix, size_t len,
+                           VarEntry **out, size_t *count) {
+    while (node) {
+        VarEntry *e = AVL_ENTRY(node, VarEntry, name_node);
+        int cmp = strncmp(e->name, prefix, len);
+
+        if (cmp < 0) {
+            node = node->right;
+        } else if (cmp > 0) {
+            node = node->left;
+        } else {
+            prefix_collect(node->left, prefix, len, out, count);
+            if (out) out[*count] = e;
+            (*count)++;
+            node = node->right;
+        }
+    }
+}
+
+/**
+ * @brief Orden de registro inverso (la más reciente primero), para `qsort`.
+ */
+static int newest_first(const void *a, const void *b) {
+    size_t sa = (*(VarEntry *const *)a)->seq;
+    size_t sb = (*(VarEntry *const *)b)->seq;
+    return (sa < sb) - (sa > sb);
+}
+
+/**
+ * @brief Quita una entrada de la que solo se conoce el puntero.
+ *
+ * @param st    Tabla del contexto actual.
+ * @param entry Entrada registrada.
+ */
+static void var_delete_entry(VariablesState *st, VarEntry *entry) {
+    VarEntry **slot = table_slot_of(st->slots, st->capacity, entry);
+    if (!slot) {
+        slot = table_slot_of(st->old_slots, st->old_capacity, entry);
+    }
+    var_delete(st, slot);
+}
+
+/* ------------------------------------------------------------------------- */
+/*                           FUNCIONES PÚBLICAS                              */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Inicializa la tabla de variables.
+ *
+ * Debe llamarse al iniciar el programa. Deja la tabla vacía y sin casillas.
+ */
+void vars_init(void) {
+    *state() = initial;
+}
+
+/**
+ * @brief Destruye todas las variables registradas.
+ *
+ * Libera las entradas y las casillas de las dos tablas.
+ * No libera los bloques a los que apuntan —eso le corresponde al manejador
+ * de memoria. Solo elimina la asociación simbólica.
+ */
+void vars_destroy(void) {
+    VariablesState *st = state();
+    VarEntry *curr = st->newest;
     while (curr) {
-        if (strcmp(curr->name, name) == 0)
-            return curr;
-        curr = curr->next;
+        VarEntry *older = curr->older;
+        free(curr);
+        curr = older;
     }
-    return NULL;
+    free(st->slots);
+    free(st->old_slots);
+    *st = initial;
 }
 
 /**
  * @brief Registra o actualiza una variable simbólica.
  *
  * Si la variable ya existe, simplemente se actualiza su bloque asociado.
- * Si no existe, se crea una nueva entrada y se inserta al inicio de la lista.
+ * Si no existe, se crea una nueva entrada como la más reciente.
  *
  * @param name Nombre de la variable.
  * @param block Bloque asociado a la variable.
  */
 void var_set(const char *name, Block *block) {
+    VariablesState *st = state();
     if (!name || !block) {
         log_error("var_set: argumentos inválidos");
         return;
     }
 
-    VarEntry *entry = var_find(name);
+    VarEntry **slot = var_find(st, name);
 
-    if (entry) {
+    if (slot) {
         /* Ya existe: actualizar referencia */
-        entry->block = block;
+        (*slot)->block = block;
         return;
     }
 
-    /* Crear nueva entrada */
-    entry = malloc(sizeof(VarEntry));
-    if (!entry) {
-        log_error("var_set: malloc falló");
-        return;
-    }
+    var_insert(st, name, block);
+}
 
-    entry->name = var_strdup(name);
-    if (!entry->name) {
-        free(entry);
-        log_error("var_set: var_strdup falló");
+/**
+ * @brief Registra una variable nueva sin buscarla antes.
+ *
+ * @param name  Nombre de una variable que no existe.
+ * @param block Bloque asociado a la variable.
+ */
+void var_add(const char *name, Block *block) {
+    if (!name || !block) {
+        log_error("var_add: argumentos inválidos");
         return;
     }
-
-    entry->block = block;
-    entry->next = var_list;
-    var_list = entry;
+    var_insert(state(), name, block);
 }
 
 /**
@@ -135,8 +489,8 @@ void var_set(const char *name, Block *block) {
  * @return Puntero al bloque asignado, o NULL si no existe.
  */
 Block *var_get(const char *name) {
-    VarEntry *entry = var_find(name);
-    return entry ? entry->block : NULL;
+    VarEntry **slot = var_find(state(), name);
+    return slot ? (*slot)->block : NULL;
 }
 
 /**
@@ -147,26 +501,78 @@ Block *var_get(const char *name) {
  * @param name Nombre de la variable a quitar.
  */
 void var_remove(const char *name) {
-    VarEntry *curr = var_list;
-    VarEntry *prev = NULL;
+    VariablesState *st = state();
+    VarEntry **slot = var_find(st, name);
 
-    while (curr) {
-        if (strcmp(curr->name, name) == 0) {
+    if (slot) {
+        var_delete(st, slot);
+        table_migrate(st, VAR_MIGRATE_STEP);
+    }
+}
 
-            /* Ajustar enlaces según sea nodo inicial o intermedio */
-            if (prev == NULL) {
-                var_list = curr->next;
-            } else {
-                prev->next = curr->next;
-            }
+/**
+ * @brief Elimina en una pasada las variables cuyo nombre empieza con un prefijo.
+ *
+ * Reúne el rango del prefijo en el árbol por nombre y las quita de la más
+ * reciente a la más antigua, el mismo orden de `vars_visit()`; cada una se
+ * ubica en su tabla por su hash. Si no hay memoria para reunirlas, recorre
+ * la lista completa.
+ *
+ * @param prefix Prefijo de los nombres.
+ * @param visit  Función llamada por cada variable antes de quitarla (puede
+ *               ser NULL).
+ * @param ctx    Contexto pasado a `visit`.
+ * @return Variables eliminadas.
+ */
+size_t vars_remove_prefix(const char *prefix, VarVisitor visit, void *ctx) {
+    VariablesState *st = state();
+    size_t len = strlen(prefix);
+    size_t removed = 0;
 
-            free(curr->name);
-            free(curr);
-            return;
+    name_index_build(st);
+    prefix_collect(st->by_name.root, prefix, len, NULL, &removed);
+    if (removed == 0) {
+        return 0;
+    }
+
+    VarEntry **group = malloc(removed * sizeof(*group));
+    if (group) {
+        size_t n = 0;
+        prefix_collect(st->by_name.root, prefix, len, group, &n);
+        qsort(group, n, sizeof(*group), newest_first);
+        for (size_t i = 0; i < n; i++) {
+            if (visit) {
+                visit(group[i]->name, group[i]->block, ctx);
+            }
+            var_delete_entry(st, group[i]);
+        }
+        free(group);
+    } else {
+        VarEntry *curr = st->newest;
+        while (curr) {
+            VarEntry *older = curr->older;
+            if (strncmp(curr->name, prefix, len) == 0) {
+                if (visit) {
+                    visit(curr->name, curr->block, ctx);
+                }
+                var_delete_entry(st, curr);
+            }
+            curr = older;
         }
+    }
+    table_migrate(st, VAR_MIGRATE_STEP);
+    return removed;
+}
 
-        prev = curr;
-        curr = curr->next;
+/**
+ * @brief Recorre las variables de la más reciente a la más antigua.
+ *
+ * @param visit Función llamada por cada variable.
+ * @param ctx   Contexto pasado a `visit`.
+ */
+void vars_visit(VarVisitor visit, void *ctx) {
+    for (VarEntry *curr = state()->newest; curr; curr = curr->older) {
+        visit(curr->name, curr->block, ctx);
     }
 }
 
@@ -177,7 +583,7 @@ void var_remove(const char *name) {
  * que su bloque sigue asignado.
  */
 void var_print_leaks(void) {
-    VarEntry *curr = var_list;
+    VarEntry *curr = state()->newest;
 
     if (!curr) {
         printf("Sin fugas de memoria.\n");
@@ -190,6 +596,6 @@ void var_print_leaks(void) {
                curr->name,
                curr->block ? curr->block->offset : 0,
                curr->block ? curr->block->size   : 0);
-        curr = curr->next;
+        curr = curr->older;
     }
 }
@@ -5,7 +5,14 @@
  * Este programa ejecuta una simulación de administración dinámica de memoria
  * basada en un archivo de comandos que contiene operaciones como ALLOC, FREE,
  * REALLOC y PRINT. El sistema utiliza un bloque de memoria propio y permite
- * seleccionar entre algoritmos de asignación (First-Fit, Best-Fit, Worst-Fit).
+ * seleccionar por nombre, al iniciar, el motor de asignación: first-fit,
+ * best-fit, worst-fit, next-fit, buddy, tlsf, bitmap, tags, tags-best,
+ * tags-worst o tags-next. El tamaño de la arena (2000 bytes por defecto) y
+ * su respaldo (sin reserva de swap, páginas enormes) también se eligen al
+ * iniciar. El heap puede partir de una
+ * instantánea guardada (`--restore`) y guardarse al terminar (`--snapshot`).
+ * Con `--threads` varios hilos reproducen los archivos de comandos a la vez
+ * sobre el mismo heap y se informa el rendimiento y la disputa del cerrojo.
  *
  * El flujo principal incluye:
  *  - Inicialización del bloque de memoria simulado.
@@ -16,10 +23,49 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 #include "memory.h"
 #include "variables.h"
 #include "parser.h"
+#include "memory_ops.h"
 #include "allocator.h"
+#include "snapshot.h"
+#include "replay.h"
+#include "string_utils.h"
+
+/** @brief Tamaño de la arena si no se indica `-m`. */
+#define DEFAULT_ARENA_SIZE 2000
+
+/** @brief Bloques por clase de la caché de cada hilo si no se indica `--cache`. */
+#define DEFAULT_THREAD_CACHE 32
+
+/**
+ * @brief Imprime la forma de uso y los motores registrados.
+ *
+ * @param prog Nombre del ejecutable.
+ */
+static void print_usage(const char *prog) {
+    printf("Uso: %s [-a <motor>] [-m <tamaño>[K|M|G|T]] [--max <tamaño>] [--noreserve]"
+           " [--hugetlb] [--thp] [--restore <archivo>] [--snapshot <archivo>]"
+           " [--payload none|fill|pattern] [--threads <n> [--cache <n>]]"
+           " <archivo_de_comandos> [<archivo> ...]\n", prog);
+    printf("Motores:");
+    for (size_t i = 0; i < allocator_engine_count(); i++) {
+        printf(" %s", allocator_engine_at(i)->name);
+    }
+    printf(" (por defecto: first-fit)\n");
+    printf("Arena: %d bytes por defecto; --max limita su crecimiento (comando GROW);\n"
+           "       --noreserve no reserva swap, --hugetlb y --thp piden páginas enormes\n"
+           "       explícitas o transparentes\n", DEFAULT_ARENA_SIZE);
+    printf("Instantáneas: --restore parte del heap guardado en un archivo (su arena\n"
+           "       reemplaza a -m); --snapshot guarda el heap al terminar los comandos\n");
+    printf("Contenido: --payload elige qué se escribe en los bloques (como el comando\n"
+           "       PAYLOAD); 'none' simula solo los metadatos\n");
+    printf("Hilos: --threads reproduce los archivos en n hilos sobre el mismo heap\n"
+           "       (repartidos en orden circular); --cache fija los bloques por clase\n"
+           "       de la caché de cada hilo (%d por defecto, 0 la desactiva)\n",
+           DEFAULT_THREAD_CACHE);
+}
 
 /**
  * @brief Función principal del simulador.
@@ -29,34 +75,142 @@
  * memoria y destruye estructuras internas.
  *
  * @param argc Cantidad de argumentos pasados al programa.
- * @param argv Lista de argumentos; se espera argv[1] como archivo de comandos.
+ * @param argv Lista de argumentos: opciones `-a <motor>`, `-m <tamaño>`,
+ *             `--max <tamaño>`, `--noreserve`, `--hugetlb`, `--thp`,
+ *             `--restore <archivo>`, `--snapshot <archivo>`,
+ *             `--payload <modo>`, `--threads <n>` y `--cache <n>`, y el
+ *             archivo de comandos (varios con `--threads`).
  * @return 0 si la ejecución fue exitosa, 1 si hubo errores en los argumentos.
  *
  * **Uso esperado:**
  * ```
  * ./memsim comandos.txt
+ * ./memsim -a tlsf comandos.txt
+ * ./memsim -m 64G --noreserve comandos.txt
+ * ./memsim --snapshot base.snap calentamiento.txt
+ * ./memsim --restore base.snap experimento.txt
+ * ./memsim --payload none -m 1G traza.txt
+ * ./memsim --threads 4 -m 64M hilo1.txt hilo2.txt hilo3.txt hilo4.txt
  * ```
  */
 int main(int argc, char *argv[]) {
-    if (argc < 2) {
-        printf("Uso: %s <archivo_de_comandos>\n", argv[0]);
+    const char *engine = NULL;
+    const char *restore_path = NULL;
+    const char *snapshot_path = NULL;
+    const char *payload = NULL;
+    size_t arena_size = DEFAULT_ARENA_SIZE;
+    size_t threads = 0;
+    size_t cache_depth = DEFAULT_THREAD_CACHE;
+    unsigned arena_flags = 0;
+    int argi = 1;
+
+    while (argi < argc && argv[argi][0] == '-') {
+        const char *opt = argv[argi];
+
+        if (argi + 1 < argc && (strcmp(opt, "-a") == 0 || strcmp(opt, "--engine") == 0)) {
+            engine = argv[++argi];
+        } else if (argi + 1 < argc && (strcmp(opt, "-m") == 0 || strcmp(opt, "--memory") == 0)) {
+            if (!str_parse_size(argv[++argi], &arena_size) || arena_size == 0) {
+                printf("Tamaño de arena inválido: '%s'\n", argv[argi]);
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (argi + 1 < argc && strcmp(opt, "--max") == 0) {
+            size_t limit;
+            if (!str_parse_size(argv[++argi], &limit)) {
+                printf("Límite de arena inválido: '%s'\n", argv[argi]);
+                print_usage(argv[0]);
+                return 1;
+            }
+            memory_set_limit(limit);
+        } else if (argi + 1 < argc && strcmp(opt, "--restore") == 0) {
+            restore_path = argv[++argi];
+        } else if (argi + 1 < argc && strcmp(opt, "--snapshot") == 0) {
+            snapshot_path = argv[++argi];
+        } else if (argi + 1 < argc && strcmp(opt, "--payload") == 0) {
+            payload = argv[++argi];
+        } else if (argi + 1 < argc && strcmp(opt, "--threads") == 0) {
+            if (!str_parse_size(argv[++argi], &threads) || threads == 0) {
+                printf("Cantidad de hilos inválida: '%s'\n", argv[argi]);
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (argi + 1 < argc && strcmp(opt, "--cache") == 0) {
+            if (!str_parse_size(argv[++argi], &cache_depth)) {
+                printf("Tamaño de caché inválido: '%s'\n", argv[argi]);
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(opt, "--noreserve") == 0) {
+            arena_flags |= MEMORY_NORESERVE;
+        } else if (strcmp(opt, "--hugetlb") == 0) {
+            arena_flags |= MEMORY_HUGETLB;
+        } else if (strcmp(opt, "--thp") == 0) {
+            arena_flags |= MEMORY_THP;
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+        argi++;
+    }
+
+    if (argi >= argc) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if (engine && !allocator_find_engine(engine)) {
+        printf("Motor desconocido: '%s'\n", engine);
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    MemPayload payload_mode = MEM_PAYLOAD_FILL;
+    if (payload && !mem_payload_from_name(payload, &payload_mode)) {
+        printf("Modo de contenido desconocido: '%s'\n", payload);
+        print_usage(argv[0]);
         return 1;
     }
 
-    // Inicialización del bloque de memoria simulado (tamaño ajustable)
-    memory_init(2000);
+    // Inicialización del bloque de memoria simulado (tamaño ajustable con -m)
+    memory_init_flags(arena_size, arena_flags);
 
     // Inicialización del sistema de variables manejadas por nombre
     vars_init();
 
-    // Desmarcar el algoritmo de asignación deseado o usar el First-Fit por defecto
-    
-    // allocator_set_algorithm(ALLOC_FIRST_FIT);
-    // allocator_set_algorithm(ALLOC_BEST_FIT);
-    // allocator_set_algorithm(ALLOC_WORST_FIT);
+    // Partir del heap guardado, con su arena, bloques, variables y motor
+    if (restore_path && !snapshot_load(restore_path)) {
+        vars_destroy();
+        memory_destroy();
+        return 1;
+    }
+
+    // Enlazar el motor elegido una sola vez, antes de ejecutar comandos
+    if (engine && !allocator_select(engine)) {
+        vars_destroy();
+        memory_destroy();
+        return 1;
+    }
+
+    // El contenido por defecto es la primera letra del nombre
+    if (payload) {
+        mem_set_payload(payload_mode);
+    }
 
-    // Procesa el archivo de comandos indicado por el usuario
-    parser_execute_file(argv[1]);
+    if (threads) {
+        // Varios hilos reproducen los archivos sobre este mismo heap
+        ReplayReport report;
+        mem_set_thread_cache(cache_depth);
+        replay_run((const char *const *)argv + argi, (size_t)(argc - argi), threads, &report);
+        replay_print_report(&report);
+    } else {
+        // Procesa el archivo de comandos indicado por el usuario
+        parser_execute_file(argv[argi]);
+    }
+
+    if (snapshot_path) {
+        snapshot_save(snapshot_path);
+    }
 
     printf("\n=== Revisión de fugas ===\n");
     var_print_leaks();
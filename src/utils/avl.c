@@ -0,0 +1,262 @@
+/**
+ * @file avl.c
+ * @brief Implementación de un árbol AVL intrusivo con datos aumentados.
+ *
+ * Las operaciones son recursivas y no requieren punteros al padre: cada
+ * inserción o eliminación desciende desde la raíz usando la función de
+ * comparación y, al regresar, rebalancea y actualiza los datos aumentados
+ * de cada nodo del camino.
+ */
+
+#include <stddef.h>
+#include "avl.h"
+
+/* ------------------------------------------------------------------------- */
+/*                           FUNCIONES AUXILIARES                            */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Altura de un subárbol (0 para el subárbol vacío).
+ */
+static int height(const AvlNode *n) {
+    return n ? n->height : 0;
+}
+
+/**
+ * @brief Recalcula la altura y los datos aumentados de un nodo.
+ *
+ * @param tree Árbol al que pertenece el nodo.
+ * @param n    Nodo cuyos hijos ya están actualizados.
+ */
+static void fix(const AvlTree *tree, AvlNode *n) {
+    int hl = height(n->left);
+    int hr = height(n->right);
+    n->height = (hl > hr ? hl : hr) + 1;
+
+    if (tree->update) {
+        tree->update(n);
+    }
+}
+
+/**
+ * @brief Rotación simple a la derecha.
+ */
+static AvlNode *rotate_right(const AvlTree *tree, AvlNode *n) {
+    AvlNode *l = n->left;
+    n->left = l->right;
+    l->right = n;
+    fix(tree, n);
+    fix(tree, l);
+    return l;
+}
+
+/**
+ * @brief Rotación simple a la izquierda.
+ */
+static AvlNode *rotate_left(const AvlTree *tree, AvlNode *n) {
+    AvlNode *r = n->right;
+    n->right = r->left;
+    r->left = n;
+    fix(tree, n);
+    fix(tree, r);
+    return r;
+}
+
+/**
+ * @brief Restaura la condición AVL en un nodo cuyos hijos están balanceados.
+ *
+ * @param tree Árbol al que pertenece el nodo.
+ * @param n    Raíz del subárbol a balancear.
+ * @return Nueva raíz del subárbol.
+ */
+static AvlNode *rebalance(const AvlTree *tree, AvlNode *n) {
+    fix(tree, n);
+    int balance = height(n->left) - height(n->right);
+
+    if (balance > 1) {
+        if (height(n->left->left) < height(n->left->right)) {
+            n->left = rotate_left(tree, n->left);
+        }
+        return rotate_right(tree, n);
+    }
+
+    if (balance < -1) {
+        if (height(n->right->right) < height(n->right->left)) {
+            n->right = rotate_right(tree, n->right);
+        }
+        return rotate_left(tree, n);
+    }
+
+    return n;
+}
+
+/**
+ * @brief Inserción recursiva.
+ */
+static AvlNode *insert_at(const AvlTree *tree, AvlNode *root, AvlNode *node) {
+    if (!root) {
+        return node;
+    }
+
+    if (tree->cmp(node, root) < 0) {
+        root->left = insert_at(tree, root->left, node);
+    } else {
+        root->right = insert_at(tree, root->right, node);
+    }
+
+    return rebalance(tree, root);
+}
+
+/**
+ * @brief Desprende el nodo mínimo de un subárbol.
+ *
+ * @param tree Árbol al que pertenece el subárbol.
+ * @param root Raíz del subárbol (no vacío).
+ * @param min  Salida: nodo mínimo desprendido.
+ * @return Nueva raíz del subárbol sin el mínimo.
+ */
+static AvlNode *detach_min(const AvlTree *tree, AvlNode *root, AvlNode **min) {
+    if (!root->left) {
+        *min = root;
+        return root->right;
+    }
+
+    root->left = detach_min(tree, root->left, min);
+    return rebalance(tree, root);
+}
+
+/**
+ * @brief Eliminación recursiva.
+ */
+static AvlNode *remove_at(const AvlTree *tree, AvlNode *root, AvlNode *node) {
+    if (!root) {
+        return NULL;
+    }
+
+    if (root == node) {
+        if (!root->left)  return root->right;
+        if (!root->right) return root->left;
+
+        /* Reemplazar por el sucesor en orden */
+        AvlNode *succ = NULL;
+        AvlNode *rest = detach_min(tree, root->right, &succ);
+        succ->left = root->left;
+        succ->right = rest;
+        return rebalance(tree, succ);
+    }
+
+    if (tree->cmp(node, root) < 0) {
+        root->left = remove_at(tree, root->left, node);
+    } else {
+        root->right = remove_at(tree, root->right, node);
+    }
+
+    return rebalance(tree, root);
+}
+
+/**
+ * @brief Actualización recursiva del camino hacia un nodo.
+ */
+static void refresh_at(const AvlTree *tree, AvlNode *root, AvlNode *node) {
+    if (!root) {
+        return;
+    }
+
+    if (root != node) {
+        refresh_at(tree, tree->cmp(node, root) < 0 ? root->left : root->right, node);
+    }
+
+    fix(tree, root);
+}
+
+/**
+ * @brief Arma un subárbol perfectamente balanceado con `nodes[lo, hi)`.
+ *
+ * La mediana es la raíz; los hijos se arman antes que ella, así que sus
+ * alturas y datos aumentados ya están listos al llamar a `fix()`.
+ */
+static AvlNode *build_range(const AvlTree *tree, AvlNode **nodes, size_t lo, size_t hi) {
+    if (lo == hi) {
+        return NULL;
+    }
+
+    size_t mid = lo + (hi - lo) / 2;
+    AvlNode *root = nodes[mid];
+    root->left = build_range(tree, nodes, lo, mid);
+    root->right = build_range(tree, nodes, mid + 1, hi);
+    fix(tree, root);
+    return root;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                              API PÚBLICA                                  */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Inicializa un árbol vacío con sus funciones de orden y actualización.
+ */
+void avl_init(AvlTree *tree, AvlCompareFn cmp, AvlUpdateFn update) {
+    tree->root = NULL;
+    tree->cmp = cmp;
+    tree->update = update;
+}
+
+/**
+ * @brief Inserta un nodo y rebalancea el camino de inserción.
+ */
+void avl_insert(AvlTree *tree, AvlNode *node) {
+    node->left = NULL;
+    node->right = NULL;
+    node->height = 1;
+    if (tree->update) {
+        tree->update(node);
+    }
+
+    tree->root = insert_at(tree, tree->root, node);
+}
+
+/**
+ * @brief Reemplaza el contenido del árbol por nodos ya ordenados, en O(n).
+ */
+void avl_build(AvlTree *tree, AvlNode **nodes, size_t count) {
+    tree->root = build_range(tree, nodes, 0, count);
+}
+
+/**
+ * @brief Elimina un nodo y deja sus enlaces en un estado neutro.
+ */
+void avl_remove(AvlTree *tree, AvlNode *node) {
+    tree->root = remove_at(tree, tree->root, node);
+    node->left = NULL;
+    node->right = NULL;
+    node->height = 0;
+}
+
+/**
+ * @brief Recalcula los datos aumentados desde la raíz hasta el nodo.
+ */
+void avl_refresh(AvlTree *tree, AvlNode *node) {
+    refresh_at(tree, tree->root, node);
+}
+
+/**
+ * @brief Retorna el nodo más a la izquierda.
+ */
+AvlNode *avl_min(const AvlTree *tree) {
+    AvlNode *n = tree->root;
+    while (n && n->left) {
+        n = n->left;
+    }
+    return n;
+}
+
+/**
+ * @brief Retorna el nodo más a la derecha.
+ */
+AvlNode *avl_max(const AvlTree *tree) {
+    AvlNode *n = tree->root;
+    while (n && n->right) {
+        n = n->right;
+    }
+    return n;
+}
@@ -12,6 +12,9 @@
 #include <stdio.h>
 #include "log.h"
 
+/** @brief Modo silencioso del hilo actual. */
+static _Thread_local bool quiet = false;
+
 /**
  * @brief Imprime un mensaje informativo en stdout.
  *
@@ -23,6 +26,8 @@
  * @param ... Lista variable de argumentos correspondiente al formato.
  */
 void log_info(const char *fmt, ...) {
+    if (quiet) return;
+
     va_list args;
     va_start(args, fmt);
 
@@ -53,3 +58,19 @@ void log_error(const char *fmt, ...) {
 
     va_end(args);
 }
+
+/**
+ * @brief Activa o desactiva el modo silencioso en el hilo actual.
+ *
+ * @param on true para omitir los mensajes informativos.
+ */
+void log_set_quiet(bool on) {
+    quiet = on;
+}
+
+/**
+ * @brief Indica si el hilo actual omite los mensajes informativos.
+ */
+bool log_quiet(void) {
+    return quiet;
+}
@@ -3,11 +3,12 @@
  * @brief Implementación de funciones utilitarias para manejo básico de cadenas.
  *
  * Este módulo proporciona funciones comunes para manipulación de strings utilizadas
- * a lo largo del simulador de memoria. Incluye operaciones de recorte (trim)
- * y validación de prefijos.
+ * a lo largo del simulador de memoria. Incluye operaciones de recorte (trim),
+ * validación de prefijos y lectura de tamaños con sufijo.
  */
 
 #include <ctype.h>
+#include <stdint.h>
 #include <string.h>
 #include "string_utils.h"
 
@@ -63,3 +64,36 @@ int str_starts_with(const char *s, const char *prefix) {
     }
     return 1;
 }
+
+/**
+ * @brief Interpreta un tamaño en bytes con sufijo K, M, G o T opcional.
+ *
+ * @param s   Cadena con dígitos decimales y, opcionalmente, un sufijo.
+ * @param out Tamaño resultante en bytes (solo se escribe si es válido).
+ * @return int Devuelve 1 si la cadena es válida, 0 si no lo es o desborda.
+ */
+int str_parse_size(const char *s, size_t *out) {
+    if (!s || !isdigit((unsigned char)*s)) return 0;
+
+    size_t value = 0;
+    for (; isdigit((unsigned char)*s); s++) {
+        size_t digit = (size_t)(*s - '0');
+        if (value > (SIZE_MAX - digit) / 10) return 0;
+        value = value * 10 + digit;
+    }
+
+    unsigned shift = 0;
+    switch (toupper((unsigned char)*s)) {
+        case 'K': shift = 10; break;
+        case 'M': shift = 20; break;
+        case 'G': shift = 30; break;
+        case 'T': shift = 40; break;
+        case '\0': break;
+        default: return 0;
+    }
+    if (shift && *++s != '\0') return 0;
+    if (value > (SIZE_MAX >> shift)) return 0;
+
+    *out = value << shift;
+    return 1;
+}